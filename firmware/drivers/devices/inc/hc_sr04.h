@@ -14,6 +14,13 @@
  * 
  * @note When disconnected return 0.
  * 
+ * HcSr04StartRanging() measures continuously in the background: a software
+ * timer (soft_timer_mcu) sends the trigger pulse every period (one timer tick
+ * wide, so no interruption waits for its end) and the echo pulse is timestamped
+ * in the GPIO interruptions of both edges, with 1us resolution and no CPU use
+ * while waiting. While ranging, the read functions
+ * return the last measurement without blocking.
+ * 
  * @note When ussing dedicated connector in ESP-EDU:
  * |   HC_SR04      |   EDU-CIAA	|
  * |:--------------:|:-------------:|
@@ -29,6 +36,7 @@
  * |   Date	    | Description                                    						|
  * |:----------:|:----------------------------------------------------------------------|
  * | 23/10/2023 | Document creation		                         						|
+ * | 16/10/2026 | Continuous ranging with edge interruptions							|
  * 
  **/
 
@@ -37,6 +45,8 @@
 #include <stdint.h>
 #include "gpio_mcu.h"
 /*==================[macros]=================================================*/
+#define HC_SR04_MIN_PERIOD_MS	60		/*!< Minimum time between measurements recommended for the sensor */
+#define HC_SR04_MAX_ECHO_US		17700	/*!< Longest echo measured (300cm), longer echoes are out of range */
 
 /*==================[typedef]================================================*/
 
@@ -55,6 +65,8 @@ bool HcSr04Init(gpio_t echo, gpio_t trigger);
 /**
  * @brief Read distance
  * 
+ * @note Blocks until the echo ends, or returns the last measurement while ranging.
+ * 
  * @return uint16_t measured distance in cm.
  */
 uint16_t HcSr04ReadDistanceInCentimeters(void);
@@ -62,10 +74,37 @@ uint16_t HcSr04ReadDistanceInCentimeters(void);
 /**
  * @brief Read distance
  * 
+ * @note Blocks until the echo ends, or returns the last measurement while ranging.
+ * 
  * @return uint16_t measured distance in inches.
  */
 uint16_t HcSr04ReadDistanceInInches(void);
 
+/**
+ * @brief Read the width of the echo pulse
+ * 
+ * @return uint32_t echo width in us (0: no echo, > HC_SR04_MAX_ECHO_US: out of range).
+ */
+uint32_t HcSr04ReadEchoUs(void);
+
+/**
+ * @brief Start continuous measurement
+ * 
+ * The callback runs in interrupt context after every measurement (keep it
+ * short, e.g. notify a task that calls HcSr04ReadDistanceInCentimeters()).
+ * 
+ * @param period_ms time between measurements in ms (at least HC_SR04_MIN_PERIOD_MS)
+ * @param func_p Pointer to callback function (NULL if not used)
+ * @param param_p Pointer to callback function parameters
+ * @return true 
+ */
+bool HcSr04StartRanging(uint32_t period_ms, void *func_p, void *param_p);
+
+/**
+ * @brief Stop continuous measurement
+ */
+void HcSr04StopRanging(void);
+
 /**
  * @brief HC_SR04 de-initialization.
  * 
@@ -12,15 +12,34 @@
 /*==================[inclusions]=============================================*/
 #include "hc_sr04.h"
 #include "delay_mcu.h"
+#include "soft_timer_mcu.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
 /*==================[macros and definitions]=================================*/
-#define MAX_US		17700	/* maximun distance time in us (300cm or 118inch) */
+#define MAX_US		HC_SR04_MAX_ECHO_US	/* maximun distance time in us (300cm or 118inch) */
 #define MAX_CM		300		/* maximun distance time in cm */
 #define MAX_INCH	118		/* maximun distance time in inch */
 #define US2CM		59		/* scale factor to conver pulse width to cm */
 #define US2INCH		150		/* scale factor to conver pulse width to inch */
 #define WAIT_MAX	5900	/* maximun time to wait for echo signal */
+#define TRIGGER_US	10		/* trigger pulse width */
+typedef enum {
+	ECHO_IDLE,				/*!< No measurement in progress */
+	ECHO_WAIT_RISE,			/*!< Trigger sent, waiting for the echo */
+	ECHO_WAIT_FALL,			/*!< Echo started */
+} echo_state_t;
 /*==================[internal data declaration]==============================*/
 static gpio_t echo_st, trigger_st; /**<  Stores the pin inicilization*/
+static volatile echo_state_t echo_state = ECHO_IDLE;	/**< State of the measurement while ranging */
+static int64_t echo_rise;						/**< Time of the echo rising edge (us) */
+static volatile uint32_t echo_us = 0;			/**< Last echo width (us) */
+static bool ranging = false;					/**< Continuous measurement running */
+static soft_timer_t ranging_timer;				/**< Starts the trigger pulses */
+static soft_timer_t trigger_timer;				/**< Ends the trigger pulse (next tick) */
+static volatile bool trigger_high = false;		/**< Trigger pulse in progress while ranging */
+static void (*ranging_func_p)(void*) = NULL;	/**< Callback after every measurement */
+static void *ranging_param_p = NULL;			/**< Callback parameters */
+static portMUX_TYPE echo_mux = portMUX_INITIALIZER_UNLOCKED;
 /*==================[internal functions declaration]=========================*/
 
 /*==================[internal data definition]===============================*/
@@ -28,7 +47,102 @@ static gpio_t echo_st, trigger_st; /**<  Stores the pin inicilization*/
 /*==================[external data definition]===============================*/
 
 /*==================[internal functions definition]==========================*/
+static void HcSr04Trigger(void){
+	GPIOOn(trigger_st);
+	DelayUs(TRIGGER_US);
+	GPIOOff(trigger_st);
+}
+
+/**
+ * @brief Blocking measurement, edges timestamped with the us timer
+ */
+static uint32_t HcSr04MeasureEcho(void){
+	int64_t start;
+	HcSr04Trigger();
+	start = esp_timer_get_time();
+	while(!GPIORead(echo_st)){
+		if(esp_timer_get_time() - start > WAIT_MAX){
+			return 0;
+		}
+	}
+	start = esp_timer_get_time();
+	while(GPIORead(echo_st)){
+		if(esp_timer_get_time() - start > MAX_US){
+			return MAX_US + 1;
+		}
+	}
+	return esp_timer_get_time() - start;
+}
+
+static uint16_t EchoToDistance(uint32_t echo, uint16_t scale, uint16_t max){
+	if(echo > MAX_US){
+		return max;
+	}
+	return echo / scale;
+}
+
+/**
+ * @brief Trigger timer callback: ends the trigger pulse
+ */
+static bool trigger_timer_isr(void *param){
+	(void)param;
+	GPIOOff(trigger_st);
+	trigger_high = false;
+	return false;
+}
+
+/**
+ * @brief Ranging timer callback: closes the previous measurement and starts a trigger
+ * 
+ * The pulse is ended by trigger_timer one tick later (at least TRIGGER_US), instead of
+ * waiting for it in the interruption.
+ */
+static bool ranging_timer_isr(void *param){
+	(void)param;
+	bool done = true;
+	portENTER_CRITICAL_ISR(&echo_mux);
+	if(echo_state == ECHO_WAIT_RISE){
+		echo_us = 0;				// no echo
+	}else if(echo_state == ECHO_WAIT_FALL){
+		echo_us = MAX_US + 1;		// echo still high: out of range
+	}else{
+		done = false;
+	}
+	echo_state = ECHO_WAIT_RISE;
+	portEXIT_CRITICAL_ISR(&echo_mux);
+	if(done && (ranging_func_p != NULL)){
+		ranging_func_p(ranging_param_p);
+	}
+	trigger_high = true;
+	GPIOOn(trigger_st);
+	SoftTimerStart(&trigger_timer, TRIGGER_US, 0);
+	return false;
+}
 
+/**
+ * @brief Echo pin interruption (both edges)
+ * 
+ * The GPIO interruptions are not IRAM only, so the handler can read the pin with GPIORead().
+ */
+static void echo_isr(void *param){
+	(void)param;
+	int64_t now = esp_timer_get_time();
+	bool level = GPIORead(echo_st);
+	bool done = false;
+	portENTER_CRITICAL_ISR(&echo_mux);
+	if(level && (echo_state == ECHO_WAIT_RISE)){
+		echo_rise = now;
+		echo_state = ECHO_WAIT_FALL;
+	}else if(!level && (echo_state == ECHO_WAIT_FALL)){
+		echo_us = now - echo_rise;
+		echo_state = ECHO_IDLE;
+		done = true;
+	}
+	portEXIT_CRITICAL_ISR(&echo_mux);
+	if(done && (ranging_func_p != NULL)){
+		ranging_func_p(ranging_param_p);
+	}
+}
 /*==================[external functions definition]==========================*/
 
 bool HcSr04Init(gpio_t echo, gpio_t trigger){
@@ -42,51 +156,56 @@ bool HcSr04Init(gpio_t echo, gpio_t trigger){
 	return true;
 }
 
+uint32_t HcSr04ReadEchoUs(void){
+	return ranging ? echo_us : HcSr04MeasureEcho();
+}
+
 uint16_t HcSr04ReadDistanceInCentimeters(void){
-	uint16_t distance = 0, waiting = 0;
-	GPIOOn(trigger_st);
-	DelayUs(10);
-	GPIOOff(trigger_st);
-	while(!GPIORead(echo_st)){
-		DelayUs(10);
-		waiting += 10;
-		if(waiting > WAIT_MAX){
-			return 0;
-		}
+	return EchoToDistance(HcSr04ReadEchoUs(), US2CM, MAX_CM);
+}
+
+uint16_t HcSr04ReadDistanceInInches(void){
+	return EchoToDistance(HcSr04ReadEchoUs(), US2INCH, MAX_INCH);
+}
+
+bool HcSr04StartRanging(uint32_t period_ms, void *func_p, void *param_p){
+	if(ranging){
+		HcSr04StopRanging();
 	}
-	do{
-		DelayUs(10);
-		distance += 10;
-		if(distance > MAX_US)
-			return MAX_CM;
+	if(period_ms < HC_SR04_MIN_PERIOD_MS){
+		period_ms = HC_SR04_MIN_PERIOD_MS;
 	}
-	while(GPIORead(echo_st));
-	return (distance/US2CM);
+	ranging_func_p = func_p;
+	ranging_param_p = param_p;
+	echo_state = ECHO_IDLE;
+	GPIOActivIntAnyEdge(echo_st, echo_isr, NULL);
+	SoftTimerInit(0);
+	SoftTimerSetup(&ranging_timer, ranging_timer_isr, NULL, SOFT_TIMER_ISR);
+	SoftTimerSetup(&trigger_timer, trigger_timer_isr, NULL, SOFT_TIMER_ISR);
+	ranging = true;
+	SoftTimerStart(&ranging_timer, 0, period_ms * 1000);
+	return true;
 }
 
-uint16_t HcSr04ReadDistanceInInches(void){
-	uint16_t distance = 0, waiting = 0;
-	GPIOOn(trigger_st);
-	DelayUs(10);
-	GPIOOff(trigger_st);
-	while(!GPIORead(echo_st)){
-		DelayUs(10);
-		waiting += 10;
-		if(waiting > WAIT_MAX){
-			return 0;
-		}
+void HcSr04StopRanging(void){
+	if(!ranging){
+		return;
 	}
-	do{
-		DelayUs(10);
-		distance += 10;
-		if(distance > MAX_US)
-			return MAX_INCH;
+	SoftTimerCancel(&ranging_timer);
+	SoftTimerCancel(&trigger_timer);
+	if(trigger_high){
+		GPIOOff(trigger_st);
+		trigger_high = false;
 	}
-	while(GPIORead(echo_st));
-	return (distance/US2INCH);
+	GPIODeactivInt(echo_st);
+	portENTER_CRITICAL(&echo_mux);
+	echo_state = ECHO_IDLE;
+	portEXIT_CRITICAL(&echo_mux);
+	ranging = false;
 }
 
 bool HcSr04Deinit(void){
+	HcSr04StopRanging();
 	GPIODeinit();
 	return true;
 }
@@ -21,11 +21,17 @@
  * |   Date	    | Description                                    						|
  * |:----------:|:----------------------------------------------------------------------|
  * | 24/02/2024 | Document creation		                         						|
+ * | 16/10/2026 | Continuous mode (DMA) with double-buffered frames						|
+ * | 16/10/2026 | Multi-channel scan groups with per channel ring buffers				|
+ * | 16/10/2026 | Bulk raw to mV conversion with calibration tables						|
+ * | 16/10/2026 | Timer driven waveform player for the analog output					|
+ * | 16/10/2026 | Oversampling and decimation in continuous mode						|
  * 
  **/
 
 /*==================[inclusions]=============================================*/
 #include "stdint.h"
+#include "stdbool.h"
 /*==================[macros]=================================================*/
 typedef enum adc_ch {
 	CH0 = 0,				/*!< Channel 0 */
@@ -40,6 +46,8 @@ typedef enum adc_mode {
 } adc_mode_t;
 
 #define DAC	0    			/*!< DAC pin. Override CH0 declaration*/
+#define ADC_FRAME_SAMPLES	256		/*!< Samples per frame in continuous mode */
+#define ADC_SCAN_MAX_CHANNELS	4	/*!< Maximum number of channels in a scan group */
 /*==================[typedef]================================================*/
 /**
  * @brief Analog inputs config structure
@@ -48,11 +56,40 @@ typedef enum adc_mode {
 typedef struct {			
 	adc_ch_t input;			/*!< Inputs: CH0, CH1, CH2, CH3 */
 	adc_mode_t mode;		/*!< Mode: single read or continuous read */
-	void *func_p;			/*!< Pointer to callback function for convertion end (only for continuous mode) */
+	void *func_p;			/*!< Pointer to callback function for frame complete, called from ISR (only for continuous mode) */
 	void *param_p;			/*!< Pointer to callback function parameters (only for continuous mode) */
-	uint16_t sample_frec;	/*!< Sample frequency min: 20kHz - max: 2MHz (only for continuous mode)  */
+	uint16_t sample_frec;	/*!< Sample frequency in Hz, min: 611Hz (only for continuous mode), updated with the real frequency */
+	uint8_t oversampling;	/*!< Oversampling k: each sample averages 4^k convertions and has 12 + k bits, 0 to 4 (only for continuous mode) */
 } analog_input_config_t;	
 
+/**
+ * @brief Scan group config structure
+ * 
+ * All the channels are sampled by the same conversion pattern, one after the other, 
+ * and the DMA frames are split in one ring buffer per channel.
+ */
+typedef struct {
+	adc_ch_t channels[ADC_SCAN_MAX_CHANNELS];	/*!< Channels in conversion order (without repetitions) */
+	uint8_t n_channels;							/*!< Number of channels (1 to ADC_SCAN_MAX_CHANNELS) */
+	uint16_t sample_frec;						/*!< Sample frequency of each channel in Hz, updated with the real frequency */
+	uint16_t *buffers[ADC_SCAN_MAX_CHANNELS];	/*!< Ring buffer of each channel, raw values (user allocated) */
+	uint16_t buffer_lenght;						/*!< Lenght of each ring buffer (power of two, at least one frame per channel) */
+	void *func_p;								/*!< Pointer to callback function for frame stored, called from ISR */
+	void *param_p;								/*!< Pointer to callback function parameters */
+} analog_scan_config_t;
+
+/**
+ * @brief Analog output waveform config structure
+ */
+typedef struct {
+	const uint8_t *samples;		/*!< Samples to play (from 0 to 255, same as AnalogOutputWrite) */
+	uint16_t lenght;			/*!< Number of samples */
+	uint32_t sample_frec;		/*!< Output sample frequency in Hz */
+	bool loop;					/*!< true: repeat the buffer, false: play it once (one-shot) */
+	void *func_p;				/*!< Pointer to callback function for end of buffer, called from ISR (can be NULL) */
+	void *param_p;				/*!< Pointer to callback function parameters */
+} analog_wave_config_t;
+
 /*==================[external data declaration]==============================*/
 
 /*==================[external functions declaration]=========================*/
@@ -80,9 +117,45 @@ void AnalogOutputInit(void);
  */
 void AnalogInputReadSingle(adc_ch_t channel, uint16_t *value);
 
+/**
+ * @brief Convert raw values to mV using the calibration of the channel
+ * 
+ * The calibration table is built when the channel is initialized (single, continuous 
+ * or scan group), the conversion costs a table lookup and an interpolation per sample. 
+ * Raw values of continuous mode with oversampling (12 + k bits) are also accepted. 
+ * Raw and mV arrays can be the same.
+ * 
+ * @param channel Channel selected
+ * @param raw Raw values array
+ * @param mv Converted values array (in mV)
+ * @param lenght Number of values
+ */
+void AnalogInputRawToMv(adc_ch_t channel, const uint16_t *raw, uint16_t *mv, uint16_t lenght);
+
+/**
+ * @brief Convert raw values to mV (float) using the calibration of the channel
+ * 
+ * @param channel Channel selected
+ * @param raw Raw values array
+ * @param mv Converted values array (in mV)
+ * @param lenght Number of values
+ */
+void AnalogInputRawToMvFloat(adc_ch_t channel, const uint16_t *raw, float *mv, uint16_t lenght);
+
 /**
  * @brief Start convertion for ADC module in continuous mode
  * 
+ * Samples are transferred by DMA, every ADC_FRAME_SAMPLES samples the frame is stored 
+ * in one of two buffers and the callback function (func_p) is called. Single reads are 
+ * not available while the continuous convertion is running.
+ * 
+ * With oversampling the ADC converts at sample_frec * 4^k and 
+ * every 4^k convertions are added in the DMA callback and decimated to one sample 
+ * of 12 + k bits (boxcar filter). The extra bits are effective only if the signal 
+ * has some noise (at least 1 LSB) acting as dither. If sample_frec * 4^k exceeds the 
+ * ADC limit (SOC_ADC_SAMPLE_FREQ_THRES_HIGH) the output frequency is lower, 
+ * AnalogInputInit() writes the real one back to sample_frec.
+ * 
  * @param channel Channel selected
  */
 void AnalogStartContinuous(adc_ch_t channel);
@@ -95,12 +168,74 @@ void AnalogStartContinuous(adc_ch_t channel);
 void AnalogStopContinuous(adc_ch_t channel);
 
 /**
- * @brief 
+ * @brief Read the last complete frame of the continuous mode
+ * 
+ * Should be called before the next frame is completed (ADC_FRAME_SAMPLES / sample_frec), 
+ * typically from a task notified by the callback function, otherwise frames are skipped. 
+ * A frame completed during the copy is copied instead, so the values never mix two frames.
  * 
  * @param channel Channel selected.
- * @param values Read variable array
+ * @param values Read variable array, raw values (of lenght = ADC_FRAME_SAMPLES)
+ * @return uint16_t Number of samples read (0 if there is no new frame since last read)
+ */
+uint16_t AnalogInputReadContinuous(adc_ch_t channel, uint16_t *values);
+
+/**
+ * @brief Scan group initialization (uses the ADC in continuous mode)
+ * 
+ * @param config Scan group config structure
+ * @return true Scan group configured
+ * @return false Invalid configuration
+ */
+bool AnalogScanInit(analog_scan_config_t *config);
+
+/**
+ * @brief Start convertion of the scan group
+ */
+void AnalogScanStart(void);
+
+/**
+ * @brief Stop convertion of the scan group
+ */
+void AnalogScanStop(void);
+
+/**
+ * @brief Number of samples of a channel waiting to be read
+ * 
+ * @param channel Channel selected
+ * @return uint16_t Number of samples in the ring buffer
+ */
+uint16_t AnalogScanAvailable(adc_ch_t channel);
+
+/**
+ * @brief Read samples of a channel of the scan group
+ * 
+ * Should be called from a single task, while the ISR stores new frames.
+ * 
+ * @param channel Channel selected
+ * @param values Read variable array, raw values
+ * @param max_lenght Lenght of values array
+ * @return uint16_t Number of samples read
+ */
+uint16_t AnalogScanRead(adc_ch_t channel, uint16_t *values, uint16_t max_lenght);
+
+/**
+ * @brief Timestamp of the last frame stored
+ * 
+ * Sample k of any channel (counting from start) was taken around 
+ * time_us - (sample_count - 1 - k) / sample_frec.
+ * 
+ * @param time_us Time when the frame was stored (us since boot)
+ * @param sample_count Number of samples of each channel stored up to that frame
+ */
+void AnalogScanTimestamp(int64_t *time_us, uint32_t *sample_count);
+
+/**
+ * @brief Number of frames dropped because a ring buffer was full
+ * 
+ * @return uint32_t Dropped frames
  */
-void AnalogInputReadContinuous(adc_ch_t channel, uint16_t *values);
+uint32_t AnalogScanOverruns(void);
 
 /**
  * @brief Digital-to-Analog convert.
@@ -109,6 +244,45 @@ void AnalogInputReadContinuous(adc_ch_t channel, uint16_t *values);
  */
 void AnalogOutputWrite(uint8_t value);
 
+/**
+ * @brief Start playing a waveform on the analog output
+ * 
+ * Samples are written to the DAC from a timer ISR, without task involvement. 
+ * AnalogOutputInit() must be called first. A waveform already playing is stopped.
+ * 
+ * @param config Waveform config structure
+ * @return true Waveform started
+ * @return false Invalid configuration or DAC not initialized
+ */
+bool AnalogOutputWaveStart(analog_wave_config_t *config);
+
+/**
+ * @brief Queue the buffer to play when the current one ends (double buffering)
+ * 
+ * The queued buffer replaces the current one without gaps, also in loop mode. 
+ * When the callback function is called the previous buffer is free to be refilled 
+ * and queued again.
+ * 
+ * @param samples Samples to play (from 0 to 255)
+ * @param lenght Number of samples
+ * @return true Buffer queued
+ * @return false Queue full (one buffer already waiting) or waveform stopped
+ */
+bool AnalogOutputWaveQueue(const uint8_t *samples, uint16_t lenght);
+
+/**
+ * @brief Stop the waveform, the output keeps the last value written
+ */
+void AnalogOutputWaveStop(void);
+
+/**
+ * @brief Waveform state
+ * 
+ * @return true Playing
+ * @return false Stopped (or one-shot buffer finished)
+ */
+bool AnalogOutputWaveRunning(void);
+
 /** @} doxygen end group definition */
 /** @} doxygen end group definition */
 /** @} doxygen end group definition */
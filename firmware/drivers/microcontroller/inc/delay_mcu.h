@@ -13,6 +13,10 @@
  * 
  * @note All delays will block the current RTOS task, with the exception of 
  * DelayUs with usec < 50.
+ * 
+ * The timer is created on the first delay and kept running, each blocked task
+ * waits on its own slot (DELAY_SLOTS concurrent delays) with an absolute deadline.
+ * Further tasks stay blocked until a slot is released.
  *
  * @author Albano Peñalva
  *
@@ -21,12 +25,14 @@
  * |   Date	    | Description                                    						|
  * |:----------:|:----------------------------------------------------------------------|
  * | 20/10/2023 | Document creation		                         						|
+ * | 16/10/2026 | Persistent timer shared by concurrent delays							|
  * 
  **/
 
 /*==================[inclusions]=============================================*/
 #include <stdint.h>
 /*==================[macros]=================================================*/
+#define DELAY_SLOTS		8		/*!< Maximum number of tasks timed in DelayMs()/DelayUs() at the same time */
 
 /*==================[typedef]================================================*/
 
@@ -0,0 +1,130 @@
+#ifndef FORMAT_MCU_H
+#define FORMAT_MCU_H
+
+/** \addtogroup Drivers_Programable Drivers Programable
+ ** @{ */
+/** \addtogroup Drivers_Microcontroller Drivers microcontroller
+ ** @{ */
+/** \addtogroup Format Format
+ ** @{ */
+
+/** \brief Reentrant number to text conversion.
+ *
+ * All the functions write into a buffer given by the caller (no static or
+ * allocated memory), so they can be used from several tasks at the same time.
+ * Every function ends the text with '\0' and returns its lenght (without '\0').
+ *
+ * Base 10 conversion writes two digits at a time from a table of digit pairs.
+ * The CSV functions format a whole block of samples in one pass, ready to be
+ * sent with UartSendAsync() or UartSendBuffer().
+ *
+ * @author Valentina de la Rosa
+ *
+ * @section changelog
+ *
+ * |   Date	    | Description                                    						|
+ * |:----------:|:----------------------------------------------------------------------|
+ * | 16/10/2026 | Document creation		                         						|
+ *
+ **/
+
+/*==================[inclusions]=============================================*/
+#include <stdint.h>
+/*==================[macros]=================================================*/
+#define FORMAT_INT_SIZE			12		/*!< Buffer size for any int32_t or uint32_t in base 10 */
+#define FORMAT_BASE_SIZE		33		/*!< Buffer size for any uint32_t in any base */
+#define FORMAT_FLOAT_MAX_DEC	6		/*!< Maximum number of decimals of FormatFloat() */
+#define FORMAT_FLOAT_SIZE		(FORMAT_INT_SIZE + FORMAT_FLOAT_MAX_DEC + 1)	/*!< Buffer size for FormatFloat() */
+/** @brief Buffer size for FormatCsvUint16() with lenght samples */
+#define FORMAT_CSV_UINT16_SIZE(lenght)	(6 * (lenght) + 1)
+/** @brief Buffer size for FormatCsvFloat() with lenght samples */
+#define FORMAT_CSV_FLOAT_SIZE(lenght)	(FORMAT_FLOAT_SIZE * (lenght) + 1)
+/*==================[typedef]================================================*/
+
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+/**
+ * @brief Unsigned integer to decimal text
+ *
+ * @param buf Buffer (FORMAT_INT_SIZE bytes)
+ * @param val Number to convert
+ * @return uint8_t Text lenght
+ */
+uint8_t FormatUint(char *buf, uint32_t val);
+
+/**
+ * @brief Signed integer to decimal text
+ *
+ * @param buf Buffer (FORMAT_INT_SIZE bytes)
+ * @param val Number to convert
+ * @return uint8_t Text lenght
+ */
+uint8_t FormatInt(char *buf, int32_t val);
+
+/**
+ * @brief Unsigned integer to text in any base
+ *
+ * @param buf Buffer (FORMAT_BASE_SIZE bytes)
+ * @param val Number to convert
+ * @param base Base of the converted number (2 to 16)
+ * @return uint8_t Text lenght (0 if the base is not valid)
+ */
+uint8_t FormatUintBase(char *buf, uint32_t val, uint8_t base);
+
+/**
+ * @brief Fixed point number to decimal text
+ *
+ * For example, val = -12345 with decimals = 2 is converted to "-123.45".
+ *
+ * @param buf Buffer (FORMAT_FLOAT_SIZE bytes)
+ * @param val Number multiplied by 10^decimals
+ * @param decimals Number of decimals (up to 9)
+ * @return uint8_t Text lenght
+ */
+uint8_t FormatFixed(char *buf, int32_t val, uint8_t decimals);
+
+/**
+ * @brief Float to decimal text, rounded to a number of decimals
+ *
+ * @note Numbers whose absolute value does not fit in an uint32_t are converted to "ovf".
+ *
+ * @param buf Buffer (FORMAT_FLOAT_SIZE bytes)
+ * @param val Number to convert
+ * @param decimals Number of decimals (up to FORMAT_FLOAT_MAX_DEC)
+ * @return uint8_t Text lenght
+ */
+uint8_t FormatFloat(char *buf, float val, uint8_t decimals);
+
+/**
+ * @brief Format a block of samples as CSV
+ *
+ * Samples are separated by ',' and a '\n' is added after every group of
+ * columns samples (one row per sample time for interleaved channels).
+ *
+ * @param buf Buffer (FORMAT_CSV_UINT16_SIZE(lenght) bytes)
+ * @param samples Samples to format
+ * @param lenght Number of samples
+ * @param columns Samples per row
+ * @return uint32_t Text lenght
+ */
+uint32_t FormatCsvUint16(char *buf, const uint16_t *samples, uint32_t lenght, uint8_t columns);
+
+/**
+ * @brief Format a block of float samples as CSV
+ *
+ * @param buf Buffer (FORMAT_CSV_FLOAT_SIZE(lenght) bytes)
+ * @param samples Samples to format
+ * @param lenght Number of samples
+ * @param columns Samples per row
+ * @param decimals Number of decimals (up to FORMAT_FLOAT_MAX_DEC)
+ * @return uint32_t Text lenght
+ */
+uint32_t FormatCsvFloat(char *buf, const float *samples, uint32_t lenght, uint8_t columns, uint8_t decimals);
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+#endif
+
+/*==================[end of file]============================================*/
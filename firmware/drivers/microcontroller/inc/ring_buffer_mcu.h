@@ -0,0 +1,196 @@
+#ifndef RING_BUFFER_MCU_H
+#define RING_BUFFER_MCU_H
+
+/** \addtogroup Drivers_Programable Drivers Programable
+ ** @{ */
+/** \addtogroup Drivers_Microcontroller Drivers microcontroller
+ ** @{ */
+/** \addtogroup Ring_Buffer Ring Buffer
+ ** @{ */
+
+/** \brief Lock-free single producer / single consumer ring buffer.
+ *
+ * Intended to pass samples from an ISR (producer) to a task (consumer) in blocks:
+ * the producer only writes the head index and the consumer only writes the tail
+ * index, so no critical sections are needed. Elements of any size are copied
+ * in at most two chunks, and the consumer can also access the stored elements
+ * in place (RingBufferPeek() / RingBufferConsume()).
+ *
+ * With RingBufferSetConsumer() the producer notifies the consumer task only when
+ * the number of stored elements reaches a watermark, so the task wakes up once per
+ * block instead of once per sample.
+ *
+ * @author Valentina de la Rosa
+ *
+ * @section changelog
+ *
+ * |   Date	    | Description                                    						|
+ * |:----------:|:----------------------------------------------------------------------|
+ * | 16/10/2026 | Document creation		                         						|
+ * | 16/10/2026 | In place writing (RingBufferReserve() / RingBufferCommit())			|
+ *
+ **/
+
+/*==================[inclusions]=============================================*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+/*==================[macros]=================================================*/
+#define RING_CACHE_LINE		32		/*!< Head and tail are kept in different cache lines */
+/*==================[typedef]================================================*/
+/**
+ * @brief Ring buffer structure
+ *
+ * @note Fields are managed by the functions of this driver and should not be modified by the user.
+ */
+typedef struct {
+	_Alignas(RING_CACHE_LINE) atomic_uint_fast32_t head;	/*!< Elements written (producer) */
+	uint32_t overflows;										/*!< Elements dropped because the buffer was full (producer) */
+	_Alignas(RING_CACHE_LINE) atomic_uint_fast32_t tail;	/*!< Elements read (consumer) */
+	_Alignas(RING_CACHE_LINE) uint8_t *buffer;				/*!< Storage (user allocated) */
+	uint32_t mask;											/*!< Lenght - 1 */
+	uint16_t element_size;									/*!< Size of each element (bytes) */
+	uint32_t watermark;										/*!< Elements that wake up the consumer */
+	TaskHandle_t consumer;									/*!< Consumer task (NULL: no notifications) */
+} ring_buffer_t;
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+/**
+ * @brief Ring buffer initialization
+ *
+ * @param rb Ring buffer
+ * @param buffer Storage for lenght elements
+ * @param lenght Number of elements (power of two)
+ * @param element_size Size of each element in bytes
+ * @return true Ring buffer initialized
+ * @return false Lenght is not a power of two
+ */
+bool RingBufferInit(ring_buffer_t *rb, void *buffer, uint32_t lenght, uint16_t element_size);
+
+/**
+ * @brief Set the task notified by RingBufferWriteFromISR()
+ *
+ * The task is notified (vTaskNotifyGiveFromISR) when the number of stored elements
+ * reaches the watermark, and it should wait for it with RingBufferWait().
+ *
+ * @param rb Ring buffer
+ * @param task Consumer task
+ * @param watermark Number of elements (1 to lenght)
+ */
+void RingBufferSetConsumer(ring_buffer_t *rb, TaskHandle_t task, uint32_t watermark);
+
+/**
+ * @brief Write elements (producer side)
+ *
+ * @param rb Ring buffer
+ * @param data Elements to write
+ * @param n Number of elements
+ * @return uint32_t Number of elements written (the rest are dropped if the buffer is full)
+ */
+uint32_t RingBufferWrite(ring_buffer_t *rb, const void *data, uint32_t n);
+
+/**
+ * @brief Write elements from an ISR and notify the consumer on watermark
+ *
+ * @param rb Ring buffer
+ * @param data Elements to write
+ * @param n Number of elements
+ * @param task_woken Set to pdTRUE if the consumer has to be scheduled (can be NULL)
+ * @return uint32_t Number of elements written
+ */
+uint32_t RingBufferWriteFromISR(ring_buffer_t *rb, const void *data, uint32_t n, BaseType_t *task_woken);
+
+/**
+ * @brief Access the free space without copying (producer side)
+ *
+ * Returns the free space stored contiguously after the newest element, the
+ * elements written there are published with RingBufferCommit().
+ *
+ * @param rb Ring buffer
+ * @param data Pointer to the first free element
+ * @return uint32_t Number of contiguous free elements
+ */
+uint32_t RingBufferReserve(ring_buffer_t *rb, void **data);
+
+/**
+ * @brief Publish elements written with RingBufferReserve() (producer side)
+ *
+ * @param rb Ring buffer
+ * @param n Number of elements
+ */
+void RingBufferCommit(ring_buffer_t *rb, uint32_t n);
+
+/**
+ * @brief Read elements (consumer side)
+ *
+ * @param rb Ring buffer
+ * @param data Array to store the elements
+ * @param max_n Maximum number of elements to read
+ * @return uint32_t Number of elements read
+ */
+uint32_t RingBufferRead(ring_buffer_t *rb, void *data, uint32_t max_n);
+
+/**
+ * @brief Wait until the watermark is reached and read elements (consumer side)
+ *
+ * @param rb Ring buffer
+ * @param data Array to store the elements
+ * @param max_n Maximum number of elements to read
+ * @param timeout Maximum time to wait (in ticks)
+ * @return uint32_t Number of elements read (can be lower than the watermark on timeout)
+ */
+uint32_t RingBufferWait(ring_buffer_t *rb, void *data, uint32_t max_n, TickType_t timeout);
+
+/**
+ * @brief Access stored elements without copying them (consumer side)
+ *
+ * Returns the elements stored contiguously from the oldest one, they remain in
+ * the buffer until RingBufferConsume() is called.
+ *
+ * @param rb Ring buffer
+ * @param data Pointer to the oldest element
+ * @return uint32_t Number of contiguous elements
+ */
+uint32_t RingBufferPeek(ring_buffer_t *rb, const void **data);
+
+/**
+ * @brief Release elements accessed with RingBufferPeek() (consumer side)
+ *
+ * @param rb Ring buffer
+ * @param n Number of elements
+ */
+void RingBufferConsume(ring_buffer_t *rb, uint32_t n);
+
+/**
+ * @brief Number of elements stored
+ *
+ * @param rb Ring buffer
+ * @return uint32_t Number of elements
+ */
+uint32_t RingBufferAvailable(ring_buffer_t *rb);
+
+/**
+ * @brief Number of elements that can be written
+ *
+ * @param rb Ring buffer
+ * @return uint32_t Number of elements
+ */
+uint32_t RingBufferFree(ring_buffer_t *rb);
+
+/**
+ * @brief Number of elements dropped because the buffer was full
+ *
+ * @param rb Ring buffer
+ * @return uint32_t Number of elements
+ */
+uint32_t RingBufferOverflows(ring_buffer_t *rb);
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+#endif
+
+/*==================[end of file]============================================*/
@@ -0,0 +1,141 @@
+#ifndef SOFT_TIMER_MCU_H
+#define SOFT_TIMER_MCU_H
+
+/** \addtogroup Drivers_Programable Drivers Programable
+ ** @{ */
+/** \addtogroup Drivers_Microcontroller Drivers microcontroller
+ ** @{ */
+/** \addtogroup Soft_Timer Soft Timer
+ ** @{ */
+
+/** \brief Software timers multiplexed on a single hardware timer.
+ *
+ * Any number of one-shot and periodic timers share one gptimer that generates
+ * a tick (SoftTimerInit()). Timers are kept in a hashed timing wheel of
+ * SOFT_TIMER_WHEEL_SIZE slots, so starting and cancelling a timer takes constant
+ * time and each tick only visits the timers of one slot.
+ *
+ * Periodic timers are rescheduled from their previous deadline, so the period
+ * does not drift with the callback execution time. Callbacks run in the timer
+ * ISR (SOFT_TIMER_ISR, they must be short and ISR safe) or in a task
+ * (SOFT_TIMER_TASK). ISR callbacks run with interrupts enabled and return true
+ * when they woke up a higher priority task (e.g. vTaskNotifyGiveFromISR()), so
+ * the ISR yields on exit.
+ *
+ * The TIMER_A/B/C timers of timer_mcu remain available for sampling with low jitter.
+ *
+ * @author Valentina de la Rosa
+ *
+ * @section changelog
+ *
+ * |   Date	    | Description                                    						|
+ * |:----------:|:----------------------------------------------------------------------|
+ * | 16/10/2026 | Document creation		                         						|
+ * | 16/10/2026 | ISR callbacks run outside the critical section and can yield			|
+ *
+ **/
+
+/*==================[inclusions]=============================================*/
+#include <stdint.h>
+#include <stdbool.h>
+/*==================[macros]=================================================*/
+#define SOFT_TIMER_WHEEL_SIZE	256		/*!< Number of slots of the timing wheel (power of two) */
+#define SOFT_TIMER_TICK_US		1000	/*!< Default tick period (us) */
+#define SOFT_TIMER_QUEUE_SIZE	32		/*!< Callbacks waiting for the SOFT_TIMER_TASK task */
+/*==================[typedef]================================================*/
+/**
+ * @brief Context where the callback of a timer runs
+ */
+typedef enum soft_timer_modes{
+	SOFT_TIMER_ISR,			/*!< Timer ISR (short and ISR safe callbacks) */
+	SOFT_TIMER_TASK,		/*!< Soft timer task */
+} soft_timer_mode_t;
+/**
+ * @brief Software timer
+ *
+ * @note Allocated by the user, fields are managed by the functions of this driver.
+ */
+typedef struct soft_timer {
+	struct soft_timer *next;	/*!< Next timer in the wheel slot */
+	struct soft_timer *prev;	/*!< Previous timer in the wheel slot */
+	uint32_t expiry;			/*!< Tick of the next expiration */
+	uint32_t period;			/*!< Period (ticks), 0 for one-shot timers */
+	struct soft_timer *fired;	/*!< Next timer expired in the same tick */
+	bool (*func_p)(void*);		/*!< Callback, returns true if a higher priority task was woken (ignored in SOFT_TIMER_TASK) */
+	void *param_p;				/*!< Callback parameters */
+	soft_timer_mode_t mode;		/*!< Context of the callback */
+	bool active;				/*!< Timer in the wheel */
+} soft_timer_t;
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+/**
+ * @brief Start the hardware timer and the task of the software timers
+ *
+ * @param tick_us Tick period (us) (= 0 for SOFT_TIMER_TICK_US), resolution of all the software timers
+ */
+void SoftTimerInit(uint32_t tick_us);
+
+/**
+ * @brief Software timer configuration
+ *
+ * @param timer Timer
+ * @param func_p Pointer to callback function: bool func(void *param_p), returns true if 
+ * a higher priority task was woken (only used in SOFT_TIMER_ISR)
+ * @param param_p Pointer to callback function parameters
+ * @param mode Context of the callback
+ */
+void SoftTimerSetup(soft_timer_t *timer, void *func_p, void *param_p, soft_timer_mode_t mode);
+
+/**
+ * @brief Start (or restart) a timer
+ *
+ * Times are rounded up to ticks, the first expiration is at least one tick after the call.
+ *
+ * @note Can be called from callbacks and ISRs.
+ *
+ * @param timer Timer
+ * @param delay_us Time to the first expiration (us)
+ * @param period_us Period (us) (= 0 for one-shot timers)
+ */
+void SoftTimerStart(soft_timer_t *timer, uint32_t delay_us, uint32_t period_us);
+
+/**
+ * @brief Cancel a timer
+ *
+ * @note A SOFT_TIMER_TASK callback already queued for the task, or a SOFT_TIMER_ISR 
+ * callback of a timer that expired in the same tick as the caller, still runs.
+ *
+ * @param timer Timer
+ */
+void SoftTimerCancel(soft_timer_t *timer);
+
+/**
+ * @brief Check if a timer is running
+ *
+ * @param timer Timer
+ * @return true Timer running
+ * @return false Timer cancelled or one-shot timer expired
+ */
+bool SoftTimerActive(soft_timer_t *timer);
+
+/**
+ * @brief Ticks since SoftTimerInit()
+ *
+ * @return uint32_t Number of ticks
+ */
+uint32_t SoftTimerTicks(void);
+
+/**
+ * @brief Number of SOFT_TIMER_TASK callbacks lost because the task queue was full
+ *
+ * @return uint32_t Number of callbacks
+ */
+uint32_t SoftTimerLostCallbacks(void);
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+#endif
+
+/*==================[end of file]============================================*/
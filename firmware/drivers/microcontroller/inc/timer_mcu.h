@@ -9,6 +9,17 @@
  ** @{ */
 
 /** \brief Timer driver for the ESP-EDU Board.
+ * 
+ * With TIMER_INSTRUMENTATION = 1 (e.g. add_compile_definitions(TIMER_INSTRUMENTATION=1)
+ * in the project CMakeLists.txt) every alarm is timestamped, and tasks notified with
+ * TimerNotifyFromISR() can stamp their wake up with TimerTaskWoken(). Latencies,
+ * period jitter and overruns are available through TimerGetStats() (and TimerDumpStats(),
+ * declared in timer_stats_mcu.h).
+ * When disabled the timestamps are compiled out and the statistics are always 0.
+ * 
+ * Periodic tasks can also pace themselves with TimerPeriodicWait(): deadlines are
+ * absolute (us, counted from a shared epoch) so execution time does not accumulate
+ * as drift, and several activities started with different phases stay aligned.
  * 
  * @author Albano Peñalva
  *
@@ -17,12 +28,20 @@
  * |   Date	    | Description                                    						|
  * |:----------:|:----------------------------------------------------------------------|
  * | 20/10/2023 | Document creation		                         						|
+ * | 16/10/2026 | Latency and jitter instrumentation (TIMER_INSTRUMENTATION)			|
+ * | 16/10/2026 | Drift-free periodic tasks with absolute deadlines						|
  * 
  **/
 
 /*==================[inclusions]=============================================*/
 #include "stdint.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 /*==================[macros]=================================================*/
+#ifndef TIMER_INSTRUMENTATION
+#define TIMER_INSTRUMENTATION	0	/*!< 1 to timestamp alarms and task wake ups */
+#endif
+#define TIMER_HISTOGRAM_BINS	12	/*!< Wake latency histogram bins: 0 us, then [2^(i-1), 2^i) us, the last one is open */
 
 /*==================[typedef]================================================*/
 /**
@@ -42,6 +61,40 @@ typedef struct {
 	void *func_p;			/*!< Pointer to callback function to call periodically */
 	void *param_p;			/*!< Pointer to callback function parameter */
 } timer_config_t;
+/**
+ * @brief Timer instrumentation statistics (all times in us)
+ */
+typedef struct {
+	uint32_t alarms;							/*!< Alarms (timer interrupts) */
+	uint32_t wakes;								/*!< Task wake ups stamped with TimerTaskWoken() */
+	uint32_t overruns;							/*!< Alarms before the task woke up from the previous one */
+	uint32_t isr_latency_min;					/*!< Minimum time from alarm to ISR */
+	uint32_t isr_latency_max;					/*!< Maximum time from alarm to ISR */
+	uint32_t wake_latency_min;					/*!< Minimum time from alarm to task wake up */
+	uint32_t wake_latency_max;					/*!< Maximum time from alarm to task wake up */
+	uint32_t period_min;						/*!< Minimum time between ISRs */
+	uint32_t period_max;						/*!< Maximum time between ISRs */
+	uint32_t wake_histogram[TIMER_HISTOGRAM_BINS];	/*!< Wake latency histogram */
+} timer_stats_t;
+/**
+ * @brief What TimerPeriodicWait() does when deadlines were missed
+ */
+typedef enum timer_overrun_policies {
+	TIMER_OVERRUN_SKIP,			/*!< Drop the missed activations, keep the phase */
+	TIMER_OVERRUN_CATCH_UP,		/*!< Run the missed activations without waiting, keep the phase */
+	TIMER_OVERRUN_REPORT,		/*!< Restart the schedule one period after now (phase is lost) */
+} timer_overrun_t;
+/**
+ * @brief Periodic activity with absolute deadlines
+ * 
+ * @note Fields are managed by the TimerPeriodic functions.
+ */
+typedef struct {
+	int64_t next;				/*!< Next deadline (us, esp_timer time base) */
+	uint32_t period;			/*!< Period (us) */
+	timer_overrun_t policy;		/*!< Overrun policy */
+	uint32_t overruns;			/*!< Activations dropped (or run late with TIMER_OVERRUN_CATCH_UP) */
+} timer_periodic_t;
 /*==================[external data declaration]==============================*/
 
 /*==================[external functions declaration]=========================*/
@@ -98,6 +151,85 @@ void TimerReset(timer_mcu_t timer);
  */
 void TimerUpdatePeriod(timer_mcu_t timer, uint32_t period);
 
+/**
+ * @brief Notify a task from a timer callback
+ * 
+ * Replaces vTaskNotifyGiveFromISR() in timer callbacks so the alarm is matched with
+ * the following TimerTaskWoken() of the task. The timer interrupt only requests a
+ * context switch when a notified task has higher priority than the interrupted one
+ * (callbacks that do not use it always request one).
+ * 
+ * @param timer Timer whose callback is running
+ * @param task Task to notify
+ * @return BaseType_t pdTRUE if the notified task has higher priority than the interrupted one
+ */
+BaseType_t TimerNotifyFromISR(timer_mcu_t timer, TaskHandle_t task);
+
+/**
+ * @brief Stamp the wake up of the task notified by a timer
+ * 
+ * Call it right after ulTaskNotifyTake() returns.
+ * 
+ * @param timer Timer that notified the task
+ */
+void TimerTaskWoken(timer_mcu_t timer);
+
+/**
+ * @brief Get the instrumentation statistics of a timer
+ * 
+ * @param timer Timer number
+ * @param stats Statistics since TimerInit() or TimerResetStats()
+ */
+void TimerGetStats(timer_mcu_t timer, timer_stats_t *stats);
+
+/**
+ * @brief Reset the instrumentation statistics of a timer
+ * 
+ * @param timer Timer number
+ */
+void TimerResetStats(timer_mcu_t timer);
+
+/**
+ * @brief Epoch shared by all the periodic activities
+ * 
+ * Set on the first call, the deadlines of every periodic activity are
+ * epoch + phase + k * period.
+ * 
+ * @return int64_t Epoch (us, esp_timer time base)
+ */
+int64_t TimerEpoch(void);
+
+/**
+ * @brief Periodic activity initialization
+ * 
+ * The first deadline is the next epoch + phase + k * period after now.
+ * 
+ * @param periodic Periodic activity
+ * @param period_us Period (us)
+ * @param phase_us Offset from the epoch (us), to align several activities
+ * @param policy What to do when deadlines are missed
+ */
+void TimerPeriodicInit(timer_periodic_t *periodic, uint32_t period_us, uint32_t phase_us, timer_overrun_t policy);
+
+/**
+ * @brief Block the calling task until the next deadline
+ * 
+ * Waits with vTaskDelay() up to the last RTOS tick and with DelayUs() the rest, so the
+ * wake up has us resolution.
+ * 
+ * @param periodic Periodic activity
+ * @return uint32_t Whole periods elapsed since the deadline (0 when on time)
+ */
+uint32_t TimerPeriodicWait(timer_periodic_t *periodic);
+
+/**
+ * @brief Change the period from the next deadline on
+ * 
+ * @param periodic Periodic activity
+ * @param period_us New period (us)
+ */
+void TimerPeriodicUpdate(timer_periodic_t *periodic, uint32_t period_us);
+
 /** @} doxygen end group definition */
 /** @} doxygen end group definition */
 /** @} doxygen end group definition */
@@ -0,0 +1,48 @@
+#ifndef TIMER_STATS_MCU_H
+#define TIMER_STATS_MCU_H
+
+/** \addtogroup Drivers_Programable Drivers Programable
+ ** @{ */
+/** \addtogroup Drivers_Microcontroller Drivers microcontroller
+ ** @{ */
+/** \addtogroup Timer Timer
+ ** @{ */
+
+/** \brief Text report of the timer instrumentation statistics.
+ *
+ * Kept apart from timer_mcu.h so the timer driver does not depend on the UART driver.
+ *
+ * @author Albano Peñalva
+ *
+ * @section changelog
+ *
+ * |   Date	    | Description                                    						|
+ * |:----------:|:----------------------------------------------------------------------|
+ * | 16/10/2026 | Document creation		                         						|
+ *
+ **/
+
+/*==================[inclusions]=============================================*/
+#include "timer_mcu.h"
+#include "uart_mcu.h"
+/*==================[macros]=================================================*/
+
+/*==================[typedef]================================================*/
+
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+/**
+ * @brief Send the instrumentation statistics of a timer as text (UartPrintf())
+ * 
+ * @param timer Timer number
+ * @param port Port for sending data (initialized with UartInit())
+ */
+void TimerDumpStats(timer_mcu_t timer, uart_mcu_port_t port);
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+#endif /* TIMER_STATS_MCU_H */
+
+/*==================[end of file]============================================*/
@@ -17,13 +17,29 @@
  * |   Date	    | Description                                    						|
  * |:----------:|:----------------------------------------------------------------------|
  * | 02/07/2024 | Document creation		                         						|
+ * | 16/10/2026 | Framed binary streaming of samples									|
+ * | 16/10/2026 | Non-blocking transmission through a TX ring and task					|
+ * | 16/10/2026 | UartItoa() based on format_mcu										|
+ * | 16/10/2026 | Line mode receiver with pattern detection and RX statistics			|
  * 
  **/
 
 /*==================[inclusions]=============================================*/
 #include "stdint.h"
+#include "stdbool.h"
 /*==================[macros]=================================================*/
 #define UART_NO_INT	0		/*!< Flag used when no reading interruption is required */
+#define UART_TX_RING_SIZE	1024	/*!< Default TX ring size (bytes) */
+#define UART_TX_QUEUE_SIZE	16		/*!< Maximum number of pending asynchronous transmissions */
+#define UART_PRINTF_MAX		128		/*!< Maximum lenght of an UartPrintf() message split by the end of the TX ring */
+#define UART_LINE_RING_SIZE	1024	/*!< Default line ring size (bytes) */
+#define UART_LINE_MAX		200		/*!< Maximum lenght of a received line, including the delimiter */
+#define UART_LINE_QUEUE_SIZE	16		/*!< Maximum number of complete lines not released */
+#define UART_STREAM_SYNC_0		0xA5	/*!< First synchronization byte of a stream frame */
+#define UART_STREAM_SYNC_1		0x5A	/*!< Second synchronization byte of a stream frame */
+#define UART_STREAM_HEADER		8		/*!< Sync (2), sequence (1), format (1), samples (2), payload lenght (2) */
+#define UART_STREAM_MAX_SAMPLES	512		/*!< Maximum number of samples in a stream frame */
+#define UART_STREAM_MAX_FRAME	(UART_STREAM_HEADER + 3 * UART_STREAM_MAX_SAMPLES + 2)	/*!< Worst case frame size (bytes) */
 /*==================[typedef]================================================*/
 /**
  * @brief List of UART ports available in ESP-EDU
@@ -40,7 +56,45 @@ typedef struct {
 	uint32_t baud_rate;		/*!< baudrate (bits per second) */
 	void *func_p;			/*!< Pointer to callback function to call when receiving data (= UART_NO_INT if not requiered)*/
 	void *param_p;			/*!< Pointer to callback function parameters */
+	uint32_t tx_ring_size;	/*!< TX ring size for asynchronous transmission (bytes, power of two) (= 0 for UART_TX_RING_SIZE) */
+	char line_delimiter;	/*!< Line mode delimiter (e.g. '\n'), func_p is called once per complete line (= 0 for byte mode) */
+	uint32_t line_ring_size;	/*!< Line ring size in line mode (bytes, power of two) (= 0 for UART_LINE_RING_SIZE) */
 } serial_config_t;
+/**
+ * @brief Receive statistics of a port
+ */
+typedef struct {
+	uint32_t lines;				/*!< Complete lines received (line mode) */
+	uint32_t dropped_lines;		/*!< Lines dropped because the line ring or queue were full (line mode) */
+	uint32_t long_lines;		/*!< Lines dropped because they were longer than UART_LINE_MAX (line mode) */
+	uint32_t read_errors;		/*!< Lines dropped because the UART driver read failed (line mode) */
+	uint32_t pattern_overflows;	/*!< Delimiter positions lost, the RX buffer was flushed (line mode) */
+	uint32_t fifo_overflows;	/*!< Hardware FIFO overflows, the RX buffer was flushed */
+	uint32_t buffer_full;		/*!< Driver RX buffer full, the RX buffer was flushed */
+} uart_rx_stats_t;
+/**
+ * @brief Sample encoding of a stream frame
+ */
+typedef enum uart_stream_formats{
+	UART_STREAM_RAW16,		/*!< 16 bits little endian samples (2 bytes per sample) */
+	UART_STREAM_PACKED12,	/*!< 12 bits samples, two samples packed in 3 bytes */
+	UART_STREAM_DELTA,		/*!< Zigzag varint of the difference with the previous sample (1 byte for slow signals) */
+} uart_stream_format_t;
+/**
+ * @brief Binary stream state
+ * 
+ * Frame layout (multi-byte fields are little endian):
+ * | sync (0xA5 0x5A) | sequence | format | samples (2) | payload lenght (2) | payload | CRC16 (2) |
+ * 
+ * CRC16 is CCITT (polynomial 0x1021, initial value 0xFFFF) computed from the
+ * sequence byte to the end of the payload. In UART_STREAM_DELTA frames the first
+ * sample is coded relative to 0, so every frame can be decoded on its own.
+ */
+typedef struct {
+	uart_mcu_port_t port;			/*!< Port for sending frames */
+	uart_stream_format_t format;	/*!< Sample encoding */
+	uint8_t sequence;				/*!< Sequence number of the next frame */
+} uart_stream_t;
 /*==================[external data declaration]==============================*/
 
 /*==================[external functions declaration]=========================*/
@@ -95,17 +149,138 @@ void UartSendString(uart_mcu_port_t port, const char *msg);
  * @param data Pointer to array of data to be transmitted
  * @param nbytes Number of bytes to be sended
  */
-void UartSendBuffer(uart_mcu_port_t port, const char *data, uint8_t nbytes);
+void UartSendBuffer(uart_mcu_port_t port, const char *data, uint16_t nbytes);
+
+/**
+ * @brief Send multiple bytes without waiting for the UART (copied to the TX ring)
+ * 
+ * Data is copied to the TX ring of the port and sent by the TX task, in order with
+ * the rest of the asynchronous transmissions.
+ * 
+ * @note Asynchronous functions can be called from several tasks, but not from ISRs. 
+ * The TX ring and task of the port are created on the first asynchronous transmission.
+ * 
+ * @param port Port for sending data
+ * @param data Pointer to array of data to be transmitted
+ * @param lenght Number of bytes to be sended
+ * @param func_p Function called by the TX task when data was sent (NULL if not requiered)
+ * @param param_p Pointer to callback function parameters
+ * @return true Data queued
+ * @return false Not enough room in the TX ring, or not enough memory for it (nothing is queued)
+ */
+bool UartSendAsync(uart_mcu_port_t port, const void *data, uint32_t lenght, void *func_p, void *param_p);
+
+/**
+ * @brief Send a buffer of any lenght without copying it
+ * 
+ * The buffer must not be modified until func_p is called.
+ * 
+ * @param port Port for sending data
+ * @param data Pointer to array of data to be transmitted
+ * @param lenght Number of bytes to be sended
+ * @param func_p Function called by the TX task when the buffer can be reused (NULL if not requiered)
+ * @param param_p Pointer to callback function parameters
+ * @return true Buffer queued
+ * @return false Too many pending transmissions, or not enough memory for the TX task
+ */
+bool UartSendBufferAsync(uart_mcu_port_t port, const void *data, uint32_t lenght, void *func_p, void *param_p);
+
+/**
+ * @brief Formatted asynchronous transmission (printf style)
+ * 
+ * The message is formatted directly in the TX ring when it fits before its end.
+ * 
+ * @param port Port for sending data
+ * @param format printf format string
+ * @param ... Values to format
+ * @return uint16_t Number of characters queued (0 if there was no room or memory for the message)
+ */
+uint16_t UartPrintf(uart_mcu_port_t port, const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+/**
+ * @brief Free space of the TX ring
+ * 
+ * @param port Port
+ * @return uint32_t Number of bytes
+ */
+uint32_t UartTxFree(uart_mcu_port_t port);
+
+/**
+ * @brief Get the oldest complete line received in line mode, without copying it
+ * 
+ * The delimiter (and a '\r' before it) is replaced by '\0'. The line stays in
+ * the line ring until UartReleaseLine() is called.
+ * 
+ * @param port Port to read from
+ * @param line Pointer to the line
+ * @param lenght Line lenght (without delimiter)
+ * @param timeout_ms Maximum time to wait for a line (ms)
+ * @return true A line was received
+ * @return false Timeout (or the port is not in line mode)
+ */
+bool UartReadLine(uart_mcu_port_t port, const char **line, uint16_t *lenght, uint32_t timeout_ms);
+
+/**
+ * @brief Release the line returned by UartReadLine()
+ * 
+ * @param port Port
+ */
+void UartReleaseLine(uart_mcu_port_t port);
+
+/**
+ * @brief Receive statistics, used to size the RX buffers under load
+ * 
+ * @param port Port
+ * @param stats Statistics since UartInit()
+ */
+void UartRxStats(uart_mcu_port_t port, uart_rx_stats_t *stats);
 
 /**
  * @brief Convert a number to a String (char array ended with '\0')
  * 
+ * @note The String is stored in a static buffer, overwritten by the next call (also from
+ * other tasks). Use FormatUint() or FormatUintBase() (format_mcu.h) with a buffer of the caller.
+ * 
  * @param val Number to be converted
  * @param base Base of the converted number (2: binary, 10: decimal, 16: hexadecimal)
  * @return uint8_t* 
  */
 uint8_t* UartItoa(uint32_t val, uint8_t base);
 
+/**
+ * @brief Binary stream initialization
+ * 
+ * @param stream Stream state
+ * @param port Port for sending frames (must be initialized with UartInit())
+ * @param format Sample encoding
+ */
+void UartStreamInit(uart_stream_t *stream, uart_mcu_port_t port, uart_stream_format_t format);
+
+/**
+ * @brief Encode samples in a stream frame without sending it
+ * 
+ * @param stream Stream state (the sequence number is incremented)
+ * @param samples Samples to encode (12 bits for UART_STREAM_PACKED12)
+ * @param lenght Number of samples (up to UART_STREAM_MAX_SAMPLES)
+ * @param frame Array to store the frame (UART_STREAM_MAX_FRAME bytes)
+ * @return uint16_t Frame size (bytes), 0 if lenght is out of range
+ */
+uint16_t UartStreamEncode(uart_stream_t *stream, const uint16_t *samples, uint16_t lenght, uint8_t *frame);
+
+/**
+ * @brief Send samples through a binary stream
+ * 
+ * Samples are split in frames of up to UART_STREAM_MAX_SAMPLES and each frame
+ * is written to the UART driver in a single call.
+ * 
+ * @note Not reentrant for the same port.
+ * 
+ * @param stream Stream state
+ * @param samples Samples to send
+ * @param lenght Number of samples
+ */
+void UartStreamSend(uart_stream_t *stream, const uint16_t *samples, uint32_t lenght);
+
 /** @} doxygen end group definition */
 /** @} doxygen end group definition */
 /** @} doxygen end group definition */
@@ -10,22 +10,287 @@
  */
 
 /*==================[inclusions]=============================================*/
+#include <string.h>
+#include <stdatomic.h>
 #include "analog_io_mcu.h"
 #include "driver/gptimer.h"
 #include "driver/sdm.h"
 #include "esp_adc/adc_cali_scheme.h"
 #include "esp_adc/adc_oneshot.h"
 #include "esp_adc/adc_continuous.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
 /*==================[macros and definitions]=================================*/
 #define ADC_BITWIDTH 		SOC_ADC_DIGI_MAX_BITWIDTH	// 12 bit resolution
 #define ADC_ATTENUATION		ADC_ATTEN_DB_12				// 12dB attenuation (for 0-3,3V ADC range)
+#define ADC_STORED_FRAMES	4							// frames stored by the continuous driver
+#define ADC_SCAN_NO_SLOT	0xFF						// channel not included in the scan group
+#define ADC_MAX_CODE		((1 << ADC_BITWIDTH) - 1)
+#define ADC_FULL_SCALE_MV	3300						// nominal full scale (without calibration)
+#define CALI_STEP_BITS		6							// calibration table step: 64 codes
+#define CALI_STEP			(1 << CALI_STEP_BITS)
+#define CALI_POINTS			(((ADC_MAX_CODE + 1) >> CALI_STEP_BITS) + 1)
+#define ADC_MAX_OVERSAMPLING	4						// up to 4^4 samples averaged (16 bits)
+#define WAVE_RESOLUTION_HZ	10000000					// waveform timer resolution: 0.1us
+#define DAC_OFFSET			128							// density = value - DAC_OFFSET
+#if CONFIG_IDF_TARGET_ESP32 || CONFIG_IDF_TARGET_ESP32S2
+#define ADC_OUTPUT_TYPE		ADC_DIGI_OUTPUT_FORMAT_TYPE1
+#define ADC_GET_DATA(p)		((p)->type1.data)
+#define ADC_GET_CHANNEL(p)	((p)->type1.channel)
+#else
+#define ADC_OUTPUT_TYPE		ADC_DIGI_OUTPUT_FORMAT_TYPE2
+#define ADC_GET_DATA(p)		((p)->type2.data)
+#define ADC_GET_CHANNEL(p)	((p)->type2.channel)
+#endif
 /*==================[internal data declaration]==============================*/
 adc_cali_handle_t adc_calibration_single_0, adc_calibration_single_1, adc_calibration_single_2, adc_calibration_single_3;
+adc_cali_handle_t *adc_calibration[] = {&adc_calibration_single_0, &adc_calibration_single_1, &adc_calibration_single_2, &adc_calibration_single_3};
+static uint16_t adc_cali_table[CH3 + 1][CALI_POINTS];	/*!< Voltage (mV) every CALI_STEP codes, for each channel */
+static bool adc_cali_table_ready[CH3 + 1] = {false};
+static uint8_t adc_cali_extra_bits[CH3 + 1] = {0};		/*!< Extra bits of the values of each channel (oversampling) */
 adc_oneshot_unit_handle_t adc1_single; 
-adc_continuous_handle_t adc2_cont;
+adc_continuous_handle_t adc1_cont = NULL;
 sdm_channel_handle_t dac = NULL;
 bool adc1_single_used = false;
+uint32_t adc_cont_frame_bytes = 0;					/*!< DMA frame size of the continuous handle */
+adc_ch_t adc_cont_channel;							/*!< Channel sampled in continuous mode */
+void (*adc_cont_func_p)(void*) = NULL;				/*!< Frame complete callback */
+void *adc_cont_param_p;								/*!< Frame complete callback parameters */
+static uint16_t adc_frame[2][ADC_FRAME_SAMPLES];	/*!< Double buffer for continuous mode frames */
+static volatile uint16_t adc_frame_lenght[2];		/*!< Number of samples of each frame */
+static volatile uint8_t adc_frame_write = 0;		/*!< Buffer being written by the next frame */
+static volatile bool adc_frame_new = false;			/*!< Complete frame not read yet */
+static atomic_uint adc_frame_seq;					/*!< Frames completed (a buffer is reused after each one) */
+static uint16_t adc_frame_fill = 0;					/*!< Samples stored in the frame being written */
+static uint8_t adc_ovs_bits = 0;					/*!< Oversampling: extra bits (k) */
+static uint32_t adc_ovs_acc = 0;					/*!< Oversampling: accumulated raw samples */
+static uint16_t adc_ovs_count = 0;					/*!< Oversampling: number of accumulated samples */
+/**
+ * @brief Scan group state
+ */
+typedef struct {
+	bool active;									/*!< Continuous driver configured for the scan group */
+	uint8_t n_channels;								/*!< Number of channels */
+	uint8_t slot[SOC_ADC_MAX_CHANNEL_NUM];			/*!< Group position of each ADC channel */
+	uint16_t *buffers[ADC_SCAN_MAX_CHANNELS];		/*!< Ring buffer of each channel */
+	uint16_t mask;									/*!< Ring buffer lenght - 1 */
+	volatile uint32_t head[ADC_SCAN_MAX_CHANNELS];	/*!< Samples written on each ring (by ISR) */
+	volatile uint32_t tail[ADC_SCAN_MAX_CHANNELS];	/*!< Samples read from each ring (by task) */
+	int64_t frame_time;								/*!< Time of the last stored frame (us) */
+	uint32_t frame_samples;							/*!< Samples per channel up to the last stored frame */
+	volatile uint32_t overruns;						/*!< Frames dropped because a ring buffer was full */
+} adc_scan_t;
+static adc_scan_t adc_scan = {.active = false};
+static portMUX_TYPE adc_scan_mux = portMUX_INITIALIZER_UNLOCKED;
+/**
+ * @brief Waveform player state
+ */
+typedef struct {
+	gptimer_handle_t timer;							/*!< Sample rate timer */
+	const uint8_t * volatile samples;				/*!< Buffer being played */
+	volatile uint16_t lenght;						/*!< Lenght of the buffer being played */
+	volatile uint16_t idx;							/*!< Next sample */
+	const uint8_t * volatile next_samples;			/*!< Queued buffer (NULL if empty) */
+	volatile uint16_t next_lenght;					/*!< Lenght of the queued buffer */
+	bool loop;										/*!< Repeat buffer while no other buffer is queued */
+	volatile bool running;							/*!< Timer running */
+	void (*func_p)(void*);							/*!< Buffer finished callback */
+	void *param_p;									/*!< Buffer finished callback parameters */
+} dac_wave_t;
+static dac_wave_t dac_wave = {.timer = NULL};
 /*==================[internal functions declaration]=========================*/
+/**
+ * @brief Copy a DMA frame to the per channel ring buffers of the scan group
+ * 
+ * The whole frame is dropped if any ring buffer has no room for it, so all the
+ * channels stay aligned in time.
+ */
+static void IRAM_ATTR ScanStoreFrame(const adc_digi_output_data_t *data, uint16_t n){
+	uint32_t room = n / adc_scan.n_channels + 1;
+	for(uint8_t c=0; c<adc_scan.n_channels; c++){
+		if((adc_scan.head[c] - adc_scan.tail[c] + room) > (uint32_t)adc_scan.mask + 1){
+			adc_scan.overruns++;
+			return;
+		}
+	}
+	for(uint16_t i=0; i<n; i++){
+		uint8_t ch = ADC_GET_CHANNEL(&data[i]);
+		uint8_t c = (ch < SOC_ADC_MAX_CHANNEL_NUM) ? adc_scan.slot[ch] : ADC_SCAN_NO_SLOT;
+		if(c != ADC_SCAN_NO_SLOT){
+			adc_scan.buffers[c][adc_scan.head[c] & adc_scan.mask] = ADC_GET_DATA(&data[i]);
+			adc_scan.head[c]++;
+		}
+	}
+	portENTER_CRITICAL_ISR(&adc_scan_mux);
+	adc_scan.frame_time = esp_timer_get_time();
+	adc_scan.frame_samples = adc_scan.head[0];
+	portEXIT_CRITICAL_ISR(&adc_scan_mux);
+}
+
+/**
+ * @brief Store the samples of a DMA frame in the frame double buffer
+ * 
+ * With oversampling 4^k raw samples are accumulated (boxcar filter) and decimated 
+ * to one sample of 12 + k bits.
+ * 
+ * @return true A frame was completed
+ */
+static bool IRAM_ATTR FrameStore(const adc_digi_output_data_t *data, uint16_t n){
+	bool complete = false;
+	uint16_t ratio = 1 << (2 * adc_ovs_bits);
+	for(uint16_t i=0; i<n; i++){
+		adc_ovs_acc += ADC_GET_DATA(&data[i]);
+		if(++adc_ovs_count == ratio){
+			uint8_t buf = adc_frame_write;
+			adc_frame[buf][adc_frame_fill++] = adc_ovs_acc >> adc_ovs_bits;
+			adc_ovs_acc = 0;
+			adc_ovs_count = 0;
+			if(adc_frame_fill == ADC_FRAME_SAMPLES){
+				adc_frame_lenght[buf] = adc_frame_fill;
+				adc_frame_fill = 0;
+				adc_frame_write = !buf;
+				adc_frame_new = true;
+				// samples of the reused buffer are written after this
+				atomic_fetch_add_explicit(&adc_frame_seq, 1, memory_order_acq_rel);
+				complete = true;
+			}
+		}
+	}
+	return complete;
+}
+
+static bool IRAM_ATTR adc_cont_isr(adc_continuous_handle_t handle, const adc_continuous_evt_data_t *edata, void *user_data){
+	(void)handle;
+	(void)user_data;
+	const adc_digi_output_data_t *data = (const adc_digi_output_data_t *)edata->conv_frame_buffer;
+	uint16_t n = edata->size / SOC_ADC_DIGI_RESULT_BYTES;
+	if(adc_scan.active){
+		ScanStoreFrame(data, n);
+	}else if(!FrameStore(data, n)){
+		return false;
+	}
+	if(adc_cont_func_p != NULL){
+		adc_cont_func_p(adc_cont_param_p);
+	}
+	return true;
+}
+
+static bool IRAM_ATTR dac_wave_isr(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *user_data){
+	(void)edata;
+	(void)user_data;
+	sdm_channel_set_pulse_density(dac, (int8_t)(dac_wave.samples[dac_wave.idx] - DAC_OFFSET));
+	if(++dac_wave.idx < dac_wave.lenght){
+		return false;
+	}
+	// end of buffer: continue with the queued one, repeat it or stop
+	dac_wave.idx = 0;
+	if(dac_wave.next_samples != NULL){
+		dac_wave.samples = dac_wave.next_samples;
+		dac_wave.lenght = dac_wave.next_lenght;
+		dac_wave.next_samples = NULL;
+	}else if(!dac_wave.loop){
+		gptimer_stop(timer);
+		dac_wave.running = false;
+	}
+	if(dac_wave.func_p != NULL){
+		dac_wave.func_p(dac_wave.param_p);
+	}
+	return true;
+}
+
+/**
+ * @brief Configure the continuous driver (ADC1) with a conversion pattern
+ * 
+ * @param channels Channels in conversion order
+ * @param n_channels Number of channels
+ * @param frec Sample frequency of each channel (Hz)
+ * @return uint32_t Real sample frequency of each channel, after clamping to the ADC limits (Hz)
+ */
+static uint32_t ContinuousConfig(const adc_ch_t *channels, uint8_t n_channels, uint32_t frec){
+	// frames hold the same number of samples of every channel
+	uint32_t frame_bytes = (ADC_FRAME_SAMPLES / n_channels) * n_channels * SOC_ADC_DIGI_RESULT_BYTES;
+	if((adc1_cont != NULL) && (adc_cont_frame_bytes != frame_bytes)){
+		adc_continuous_deinit(adc1_cont);
+		adc1_cont = NULL;
+	}
+	if(adc1_cont == NULL){
+		adc_continuous_handle_cfg_t handle_config = {
+			.max_store_buf_size = ADC_STORED_FRAMES * frame_bytes,
+			.conv_frame_size = frame_bytes,
+		};
+		ESP_ERROR_CHECK(adc_continuous_new_handle(&handle_config, &adc1_cont));
+		adc_continuous_evt_cbs_t cbs = {
+			.on_conv_done = adc_cont_isr,
+		};
+		ESP_ERROR_CHECK(adc_continuous_register_event_callbacks(adc1_cont, &cbs, NULL));
+		adc_cont_frame_bytes = frame_bytes;
+	}
+	frec *= n_channels;
+	if(frec < SOC_ADC_SAMPLE_FREQ_THRES_LOW){
+		frec = SOC_ADC_SAMPLE_FREQ_THRES_LOW;
+	}else if(frec > SOC_ADC_SAMPLE_FREQ_THRES_HIGH){
+		frec = SOC_ADC_SAMPLE_FREQ_THRES_HIGH;
+	}
+	// CH0 to CH3 are ADC1 channels 0 to 3
+	adc_digi_pattern_config_t pattern[ADC_SCAN_MAX_CHANNELS];
+	for(uint8_t i=0; i<n_channels; i++){
+		pattern[i].atten = ADC_ATTENUATION;
+		pattern[i].channel = channels[i];
+		pattern[i].unit = ADC_UNIT_1;
+		pattern[i].bit_width = ADC_BITWIDTH;
+	}
+	adc_continuous_config_t cont_config = {
+		.pattern_num = n_channels,
+		.adc_pattern = pattern,
+		.sample_freq_hz = frec,
+		.conv_mode = ADC_CONV_SINGLE_UNIT_1,
+		.format = ADC_OUTPUT_TYPE,
+	};
+	ESP_ERROR_CHECK(adc_continuous_config(adc1_cont, &cont_config));
+	return frec / n_channels;
+}
+
+/**
+ * @brief Build the calibration table of a channel from its calibration curve
+ * 
+ * The curve is evaluated every CALI_STEP codes, so conversions only need a table 
+ * lookup and a linear interpolation. If the curve is not available (eFuse not 
+ * burnt) the nominal linear conversion is used.
+ * 
+ * @param channel Channel selected
+ */
+static void CalibrationInit(adc_ch_t channel){
+	adc_cali_handle_t *handle = adc_calibration[channel];
+	if(adc_cali_table_ready[channel]){
+		return;
+	}
+	if(*handle == NULL){
+		adc_cali_curve_fitting_config_t cali_config = {
+			.unit_id = ADC_UNIT_1,
+			.chan = (adc_channel_t)channel, 
+			.atten = ADC_ATTENUATION,
+			.bitwidth = ADC_BITWIDTH,
+		};
+		if(adc_cali_create_scheme_curve_fitting(&cali_config, handle) != ESP_OK){
+			*handle = NULL;
+		}
+	}
+	int mv;
+	for(uint16_t i=0; i<CALI_POINTS - 1; i++){
+		if((*handle == NULL) || (adc_cali_raw_to_voltage(*handle, i << CALI_STEP_BITS, &mv) != ESP_OK)){
+			mv = ((i << CALI_STEP_BITS) * ADC_FULL_SCALE_MV + ADC_MAX_CODE / 2) / ADC_MAX_CODE;
+		}
+		adc_cali_table[channel][i] = mv;
+	}
+	// last point (ADC_MAX_CODE + 1) extrapolated from the last valid code
+	int mv_last;
+	if((*handle == NULL) || (adc_cali_raw_to_voltage(*handle, ADC_MAX_CODE, &mv_last) != ESP_OK)){
+		mv_last = ADC_FULL_SCALE_MV;
+	}
+	uint16_t prev = adc_cali_table[channel][CALI_POINTS - 2];
+	adc_cali_table[channel][CALI_POINTS - 1] = mv_last + (mv_last - prev + (CALI_STEP - 1) / 2) / (CALI_STEP - 1);
+	adc_cali_table_ready[channel] = true;
+}
 
 /*==================[internal data definition]===============================*/
 adc_oneshot_unit_init_cfg_t init_config_single = {
@@ -54,65 +319,31 @@ void AnalogInputInit(analog_input_config_t *config){
 			switch(config->input){
 				case CH0:
     				adc_oneshot_config_channel(adc1_single, ADC_CHANNEL_0, &adc_config_single);
-					// create calibration curve
-					adc_cali_curve_fitting_config_t cali_config_0 = {
-						.unit_id = ADC_UNIT_1,
-						.chan = ADC_CHANNEL_0, 
-						.atten = ADC_ATTENUATION,
-						.bitwidth = ADC_BITWIDTH,
-					};
-					ESP_ERROR_CHECK(adc_cali_create_scheme_curve_fitting(&cali_config_0, &adc_calibration_single_0));
 				break;
 				case CH1:
     				adc_oneshot_config_channel(adc1_single, ADC_CHANNEL_1, &adc_config_single);
-					// create calibration curve
-					adc_cali_curve_fitting_config_t cali_config_1 = {
-						.unit_id = ADC_UNIT_1,
-						.chan = ADC_CHANNEL_1, 
-						.atten = ADC_ATTENUATION,
-						.bitwidth = ADC_BITWIDTH,
-					};
-					ESP_ERROR_CHECK(adc_cali_create_scheme_curve_fitting(&cali_config_1, &adc_calibration_single_1));
 				break;
 				case CH2:
     				adc_oneshot_config_channel(adc1_single, ADC_CHANNEL_2, &adc_config_single);
-					// create calibration curve
-					adc_cali_curve_fitting_config_t cali_config_2 = {
-						.unit_id = ADC_UNIT_1,
-						.chan = ADC_CHANNEL_2, 
-						.atten = ADC_ATTENUATION,
-						.bitwidth = ADC_BITWIDTH,
-					};
-					ESP_ERROR_CHECK(adc_cali_create_scheme_curve_fitting(&cali_config_2, &adc_calibration_single_2));
 				break;
 				case CH3:
     				adc_oneshot_config_channel(adc1_single, ADC_CHANNEL_3, &adc_config_single);
-					// create calibration curve
-					adc_cali_curve_fitting_config_t cali_config_3 = {
-						.unit_id = ADC_UNIT_1,
-						.chan = ADC_CHANNEL_3, 
-						.atten = ADC_ATTENUATION,
-						.bitwidth = ADC_BITWIDTH,
-					};
-					ESP_ERROR_CHECK(adc_cali_create_scheme_curve_fitting(&cali_config_3, &adc_calibration_single_3));
 				break;
 			}
+			// calibration curve and table (created once per channel)
+			CalibrationInit(config->input);
+			adc_cali_extra_bits[config->input] = 0;
 		break;
 		case ADC_CONTINUOUS:
-			switch(config->input){
-				case CH0:
-
-				break;
-				case CH1:
-
-				break;
-				case CH2:
-
-				break;
-				case CH3:
-
-				break;
-			}
+			adc_ovs_bits = (config->oversampling > ADC_MAX_OVERSAMPLING) ? ADC_MAX_OVERSAMPLING : config->oversampling;
+			// raw sample frequency is 4^k times the output frequency, the real output frequency is reported back
+			config->sample_frec = ContinuousConfig(&config->input, 1, (uint32_t)config->sample_frec << (2 * adc_ovs_bits)) >> (2 * adc_ovs_bits);
+			CalibrationInit(config->input);
+			adc_cali_extra_bits[config->input] = adc_ovs_bits;
+			adc_scan.active = false;
+			adc_cont_channel = config->input;
+			adc_cont_func_p = config->func_p;
+			adc_cont_param_p = config->param_p;
 		break;
 	}
 }
@@ -145,22 +376,207 @@ void AnalogInputReadSingle(adc_ch_t channel, uint16_t *value){
 }
 
 void AnalogStartContinuous(adc_ch_t channel){
-
+	if((adc1_cont != NULL) && !adc_scan.active && (channel == adc_cont_channel)){
+		adc_frame_write = 0;
+		adc_frame_new = false;
+		adc_frame_fill = 0;
+		adc_ovs_acc = 0;
+		adc_ovs_count = 0;
+		adc_continuous_start(adc1_cont);
+	}
 }
 
 void AnalogStopContinuous(adc_ch_t channel){
+	if((adc1_cont != NULL) && !adc_scan.active && (channel == adc_cont_channel)){
+		adc_continuous_stop(adc1_cont);
+	}
+}
+
+uint16_t AnalogInputReadContinuous(adc_ch_t channel, uint16_t *values){
+	if(!adc_frame_new || adc_scan.active || (channel != adc_cont_channel)){
+		return 0;
+	}
+	uint32_t seq;
+	uint16_t n;
+	do{
+		seq = atomic_load_explicit(&adc_frame_seq, memory_order_acquire);
+		adc_frame_new = false;
+		// last complete frame is the one not being written
+		uint8_t buf = !adc_frame_write;
+		n = adc_frame_lenght[buf];
+		memcpy(values, adc_frame[buf], n * sizeof(uint16_t));
+		atomic_thread_fence(memory_order_acquire);
+		// a frame completed during the copy: the buffer may be partly overwritten, copy the new one
+	}while(atomic_load_explicit(&adc_frame_seq, memory_order_relaxed) != seq);
+	return n;
+}
+
+void AnalogInputRawToMv(adc_ch_t channel, const uint16_t *raw, uint16_t *mv, uint16_t lenght){
+	const uint16_t *table = adc_cali_table[channel];
+	uint8_t shift = CALI_STEP_BITS + adc_cali_extra_bits[channel];
+	uint32_t max_code = ((ADC_MAX_CODE + 1) << adc_cali_extra_bits[channel]) - 1;
+	for(uint16_t i=0; i<lenght; i++){
+		uint32_t code = (raw[i] > max_code) ? max_code : raw[i];
+		uint16_t idx = code >> shift;
+		int32_t frac = code & ((1 << shift) - 1);
+		int32_t delta = (int32_t)table[idx + 1] - table[idx];
+		mv[i] = table[idx] + ((delta * frac + (1 << (shift - 1))) >> shift);
+	}
+}
+
+void AnalogInputRawToMvFloat(adc_ch_t channel, const uint16_t *raw, float *mv, uint16_t lenght){
+	const uint16_t *table = adc_cali_table[channel];
+	uint8_t shift = CALI_STEP_BITS + adc_cali_extra_bits[channel];
+	uint32_t max_code = ((ADC_MAX_CODE + 1) << adc_cali_extra_bits[channel]) - 1;
+	float step = 1.0f / (1 << shift);
+	for(uint16_t i=0; i<lenght; i++){
+		uint32_t code = (raw[i] > max_code) ? max_code : raw[i];
+		uint16_t idx = code >> shift;
+		float frac = (code & ((1 << shift) - 1)) * step;
+		mv[i] = table[idx] + (table[idx + 1] - (float)table[idx]) * frac;
+	}
+}
+
+bool AnalogScanInit(analog_scan_config_t *config){
+	if((config->n_channels == 0) || (config->n_channels > ADC_SCAN_MAX_CHANNELS) ||
+	   (config->buffer_lenght < 2) || (config->buffer_lenght & (config->buffer_lenght - 1))){
+		return false;
+	}
+	memset(&adc_scan, 0, sizeof(adc_scan_t));
+	memset(adc_scan.slot, ADC_SCAN_NO_SLOT, sizeof(adc_scan.slot));
+	for(uint8_t i=0; i<config->n_channels; i++){
+		if((config->channels[i] > CH3) || (adc_scan.slot[config->channels[i]] != ADC_SCAN_NO_SLOT) || (config->buffers[i] == NULL)){
+			return false;
+		}
+		adc_scan.slot[config->channels[i]] = i;
+		adc_scan.buffers[i] = config->buffers[i];
+		CalibrationInit(config->channels[i]);
+		adc_cali_extra_bits[config->channels[i]] = 0;
+	}
+	adc_scan.n_channels = config->n_channels;
+	adc_scan.mask = config->buffer_lenght - 1;
+	config->sample_frec = ContinuousConfig(config->channels, config->n_channels, config->sample_frec);
+	adc_cont_func_p = config->func_p;
+	adc_cont_param_p = config->param_p;
+	adc_scan.active = true;
+	return true;
+}
 
+void AnalogScanStart(void){
+	if((adc1_cont != NULL) && adc_scan.active){
+		adc_continuous_start(adc1_cont);
+	}
+}
+
+void AnalogScanStop(void){
+	if((adc1_cont != NULL) && adc_scan.active){
+		adc_continuous_stop(adc1_cont);
+	}
+}
+
+uint16_t AnalogScanAvailable(adc_ch_t channel){
+	if(!adc_scan.active || (channel > CH3) || (adc_scan.slot[channel] == ADC_SCAN_NO_SLOT)){
+		return 0;
+	}
+	uint8_t c = adc_scan.slot[channel];
+	return adc_scan.head[c] - adc_scan.tail[c];
 }
 
-void AnalogInputReadContinuous(adc_ch_t channel, uint16_t *values){
+uint16_t AnalogScanRead(adc_ch_t channel, uint16_t *values, uint16_t max_lenght){
+	uint16_t n = AnalogScanAvailable(channel);
+	if(n == 0){
+		return 0;
+	}
+	uint8_t c = adc_scan.slot[channel];
+	uint32_t tail = adc_scan.tail[c];
+	if(n > max_lenght){
+		n = max_lenght;
+	}
+	for(uint16_t i=0; i<n; i++){
+		values[i] = adc_scan.buffers[c][(tail + i) & adc_scan.mask];
+	}
+	adc_scan.tail[c] = tail + n;
+	return n;
+}
+
+void AnalogScanTimestamp(int64_t *time_us, uint32_t *sample_count){
+	portENTER_CRITICAL(&adc_scan_mux);
+	*time_us = adc_scan.frame_time;
+	*sample_count = adc_scan.frame_samples;
+	portEXIT_CRITICAL(&adc_scan_mux);
+}
 
+uint32_t AnalogScanOverruns(void){
+	return adc_scan.overruns;
 }
 
 void AnalogOutputWrite(uint8_t value){
-	int8_t density = value - 128;
+	int8_t density = value - DAC_OFFSET;
 	sdm_channel_set_pulse_density(dac, density);
 }
 
+bool AnalogOutputWaveStart(analog_wave_config_t *config){
+	if((dac == NULL) || (config->samples == NULL) || (config->lenght == 0) ||
+	   (config->sample_frec == 0) || (config->sample_frec > WAVE_RESOLUTION_HZ / 2)){
+		return false;
+	}
+	if(dac_wave.timer == NULL){
+		gptimer_config_t timer_config = {
+			.clk_src = GPTIMER_CLK_SRC_DEFAULT,
+			.direction = GPTIMER_COUNT_UP,
+			.resolution_hz = WAVE_RESOLUTION_HZ,
+		};
+		if(gptimer_new_timer(&timer_config, &dac_wave.timer) != ESP_OK){
+			dac_wave.timer = NULL;
+			return false;
+		}
+		gptimer_event_callbacks_t cbs = {
+			.on_alarm = dac_wave_isr,
+		};
+		gptimer_register_event_callbacks(dac_wave.timer, &cbs, NULL);
+		gptimer_enable(dac_wave.timer);
+	}
+	AnalogOutputWaveStop();
+	dac_wave.samples = config->samples;
+	dac_wave.lenght = config->lenght;
+	dac_wave.idx = 0;
+	dac_wave.next_samples = NULL;
+	dac_wave.loop = config->loop;
+	dac_wave.func_p = config->func_p;
+	dac_wave.param_p = config->param_p;
+	gptimer_alarm_config_t alarm_config = {
+		.alarm_count = (WAVE_RESOLUTION_HZ + config->sample_frec / 2) / config->sample_frec,
+		.reload_count = 0,
+		.flags.auto_reload_on_alarm = true,
+	};
+	gptimer_set_alarm_action(dac_wave.timer, &alarm_config);
+	gptimer_set_raw_count(dac_wave.timer, 0);
+	dac_wave.running = true;
+	gptimer_start(dac_wave.timer);
+	return true;
+}
+
+bool AnalogOutputWaveQueue(const uint8_t *samples, uint16_t lenght){
+	if((samples == NULL) || (lenght == 0) || !dac_wave.running || (dac_wave.next_samples != NULL)){
+		return false;
+	}
+	dac_wave.next_lenght = lenght;
+	dac_wave.next_samples = samples;
+	return true;
+}
+
+void AnalogOutputWaveStop(void){
+	if((dac_wave.timer != NULL) && dac_wave.running){
+		gptimer_stop(dac_wave.timer);
+	}
+	dac_wave.running = false;
+	dac_wave.next_samples = NULL;
+}
+
+bool AnalogOutputWaveRunning(void){
+	return dac_wave.running;
+}
+
 /** @} doxygen end group definition */
 /** @} doxygen end group definition */
 /** @} doxygen end group definition */
@@ -22,21 +22,160 @@
 #define SEC					1000000	/*!< 1sec = 1000msec */
 #define MIN_US				50	    /*!< minimun delay in usec to use gptimer */
 #define MIN_MS				100	    /*!< minimun delay in msec to use vTaskDelay */
+#define NO_DEADLINE			UINT64_MAX	/*!< Slot not waiting for the timer */
 /*==================[internal data declaration]==============================*/
-SemaphoreHandle_t xDelaySemaphore = NULL;
+/**
+ * @brief Delay service state
+ */
+typedef enum {
+	DELAY_UNINIT,						/*!< Timer not created */
+	DELAY_STARTING,						/*!< Timer being created by the first caller */
+	DELAY_READY,						/*!< Timer running */
+} delay_state_t;
+/**
+ * @brief Wait slot of a blocked task
+ */
+typedef struct {
+	uint64_t deadline;					/*!< Absolute timer count to wake up */
+	bool used;							/*!< Slot owned by a task (until it takes the semaphore) */
+	SemaphoreHandle_t sem;				/*!< Binary semaphore given by the ISR */
+	StaticSemaphore_t sem_buffer;		/*!< Static storage of the semaphore */
+} delay_slot_t;
+static delay_slot_t delay_slot[DELAY_SLOTS];
+static SemaphoreHandle_t delay_free;			/*!< Counts the free slots */
+static StaticSemaphore_t delay_free_buffer;
+static gptimer_handle_t delay_timer = NULL;
+static volatile delay_state_t delay_state = DELAY_UNINIT;
+static portMUX_TYPE delay_mux = portMUX_INITIALIZER_UNLOCKED;
 /*==================[internal functions declaration]=========================*/
-static bool IRAM_ATTR delay_isr(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *user_data){
-	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-	gptimer_stop(timer);
-	xSemaphoreGiveFromISR(xDelaySemaphore, &xHigherPriorityTaskWoken);
-	return (xHigherPriorityTaskWoken == pdTRUE);
-}
+static bool IRAM_ATTR delay_isr(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *user_data);
 /*==================[internal data definition]===============================*/
 
 /*==================[external data definition]===============================*/
 
 /*==================[internal functions definition]==========================*/
+/**
+ * @brief Program the alarm for the earliest deadline (delay_mux taken)
+ * 
+ * @return true The earliest deadline was already reached when programming the alarm
+ */
+static bool IRAM_ATTR DelayArm(void){
+	uint64_t next = NO_DEADLINE;
+	uint64_t count;
+	for(uint8_t i=0; i<DELAY_SLOTS; i++){
+		if(delay_slot[i].deadline < next){
+			next = delay_slot[i].deadline;
+		}
+	}
+	if(next == NO_DEADLINE){
+		return false;
+	}
+	gptimer_alarm_config_t alarm_config = {
+		.alarm_count = next,
+	};
+	gptimer_set_alarm_action(delay_timer, &alarm_config);
+	gptimer_get_raw_count(delay_timer, &count);
+	return count >= next;
+}
+
+/**
+ * @brief Wake up the tasks whose deadline was reached and program the next alarm (delay_mux taken)
+ */
+static void IRAM_ATTR DelayUpdate(BaseType_t *task_woken){
+	uint64_t count;
+	do{
+		gptimer_get_raw_count(delay_timer, &count);
+		for(uint8_t i=0; i<DELAY_SLOTS; i++){
+			if(delay_slot[i].deadline <= count){
+				delay_slot[i].deadline = NO_DEADLINE;
+				xSemaphoreGiveFromISR(delay_slot[i].sem, task_woken);
+			}
+		}
+	}while(DelayArm());
+}
+
+static bool IRAM_ATTR delay_isr(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *user_data){
+	(void)timer;
+	(void)edata;
+	(void)user_data;
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+	portENTER_CRITICAL_ISR(&delay_mux);
+	DelayUpdate(&xHigherPriorityTaskWoken);
+	portEXIT_CRITICAL_ISR(&delay_mux);
+	return (xHigherPriorityTaskWoken == pdTRUE);
+}
 
+/**
+ * @brief Create and start the timer shared by all delays (only once)
+ * 
+ * Tasks arriving while another one creates the timer sleep until it is running.
+ */
+static void DelayServiceInit(void){
+	bool first = false;
+	portENTER_CRITICAL(&delay_mux);
+	if(delay_state == DELAY_UNINIT){
+		delay_state = DELAY_STARTING;
+		first = true;
+	}
+	portEXIT_CRITICAL(&delay_mux);
+	if(!first){
+		while(delay_state != DELAY_READY){
+			vTaskDelay(1);
+		}
+		return;
+	}
+	delay_free = xSemaphoreCreateCountingStatic(DELAY_SLOTS, DELAY_SLOTS, &delay_free_buffer);
+	for(uint8_t i=0; i<DELAY_SLOTS; i++){
+		delay_slot[i].deadline = NO_DEADLINE;
+		delay_slot[i].used = false;
+		delay_slot[i].sem = xSemaphoreCreateBinaryStatic(&delay_slot[i].sem_buffer);
+	}
+	gptimer_config_t delay_timer_config = {
+		.clk_src = GPTIMER_CLK_SRC_DEFAULT,
+		.direction = GPTIMER_COUNT_UP,
+		.resolution_hz = US_RESOLUTION_HZ,
+	};
+	ESP_ERROR_CHECK(gptimer_new_timer(&delay_timer_config, &delay_timer));
+	gptimer_event_callbacks_t delay_alarm = {
+		.on_alarm = delay_isr,
+	};
+	ESP_ERROR_CHECK(gptimer_register_event_callbacks(delay_timer, &delay_alarm, NULL));
+	ESP_ERROR_CHECK(gptimer_enable(delay_timer));
+	ESP_ERROR_CHECK(gptimer_start(delay_timer));
+	delay_state = DELAY_READY;
+}
+
+/**
+ * @brief Block the calling task for usec using a wait slot
+ * 
+ * With DELAY_SLOTS tasks already waiting, the task blocks until a slot is released.
+ */
+static void DelayWait(uint32_t usec){
+	delay_slot_t *slot = NULL;
+	BaseType_t task_woken = pdFALSE;
+	uint64_t count;
+	DelayServiceInit();
+	xSemaphoreTake(delay_free, portMAX_DELAY);
+	portENTER_CRITICAL(&delay_mux);
+	for(uint8_t i=0; i<DELAY_SLOTS; i++){
+		if(!delay_slot[i].used){
+			slot = &delay_slot[i];
+			slot->used = true;
+			gptimer_get_raw_count(delay_timer, &count);
+			slot->deadline = count + usec;
+			DelayUpdate(&task_woken);
+			break;
+		}
+	}
+	portEXIT_CRITICAL(&delay_mux);
+	if(task_woken == pdTRUE){
+		// a waiting task with a higher priority was released while arming
+		taskYIELD();
+	}
+	xSemaphoreTake(slot->sem, portMAX_DELAY);
+	slot->used = false;
+	xSemaphoreGive(delay_free);
+}
 /*==================[external functions definition]==========================*/
 void DelaySec(uint16_t sec){
     vTaskDelay(sec * MSEC / portTICK_PERIOD_MS);
@@ -45,32 +184,7 @@ void DelaySec(uint16_t sec){
 void DelayMs(uint16_t msec){
     // If the delay is too short, use the ESP32's internal timer
     if(msec<=MIN_MS){ 
-        if(xDelaySemaphore == NULL){
-            xDelaySemaphore = xSemaphoreCreateBinary();
-            gptimer_handle_t delay_timer = NULL;
-            gptimer_config_t delay_timer_config = {
-                .clk_src = GPTIMER_CLK_SRC_DEFAULT,
-                .direction = GPTIMER_COUNT_UP,
-                .resolution_hz = US_RESOLUTION_HZ,
-            };
-            gptimer_new_timer(&delay_timer_config, &delay_timer);
-            gptimer_event_callbacks_t delay_alarm = {
-                .on_alarm = delay_isr,
-            };
-            gptimer_register_event_callbacks(delay_timer, &delay_alarm, NULL);
-            gptimer_enable(delay_timer);
-            gptimer_alarm_config_t alarm_config = {
-                .alarm_count = msec*MSEC, 
-            };
-            gptimer_set_alarm_action(delay_timer, &alarm_config);
-            gptimer_start(delay_timer);
-            if(xDelaySemaphore != NULL){
-                xSemaphoreTake(xDelaySemaphore, portMAX_DELAY);
-                xDelaySemaphore = NULL;
-            }
-            gptimer_disable(delay_timer);
-            gptimer_del_timer(delay_timer);
-        }
+        DelayWait(msec*MSEC);
     }else{       
         // If the delay is longer than the minimum delay, use vTaskDelay
         vTaskDelay(msec / portTICK_PERIOD_MS);
@@ -83,33 +197,8 @@ void DelayUs(uint16_t usec){
         esp_rom_delay_us(usec);
     }else{
         /* If the delay is longer than the minimum, use the ESP32's internal timer */
-        if(xDelaySemaphore == NULL){
-	        xDelaySemaphore = xSemaphoreCreateBinary();
-            gptimer_handle_t delay_timer = NULL;
-            gptimer_config_t delay_timer_config = {
-                .clk_src = GPTIMER_CLK_SRC_DEFAULT,
-                .direction = GPTIMER_COUNT_UP,
-                .resolution_hz = US_RESOLUTION_HZ,
-            };
-            gptimer_new_timer(&delay_timer_config, &delay_timer);
-            gptimer_event_callbacks_t delay_alarm = {
-                .on_alarm = delay_isr,
-            };
-            gptimer_register_event_callbacks(delay_timer, &delay_alarm, NULL);
-            gptimer_enable(delay_timer);
-            gptimer_alarm_config_t alarm_config = {
-                .alarm_count = usec, 
-            };
-            gptimer_set_alarm_action(delay_timer, &alarm_config);
-            gptimer_start(delay_timer);
-            if(xDelaySemaphore != NULL){
-                /* Wait for the timer to finish */
-                xSemaphoreTake(xDelaySemaphore, portMAX_DELAY);
-                xDelaySemaphore = NULL;
-            }
-            gptimer_disable(delay_timer);
-            gptimer_del_timer(delay_timer);
-        }
+        DelayWait(usec);
     }
 }
 
+/*==================[end of file]============================================*/
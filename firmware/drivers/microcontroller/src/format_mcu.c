@@ -0,0 +1,205 @@
+/**
+ * @file format_mcu.c
+ * @author Valentina de la Rosa (valentina.delarosa@ingenieria.uner.edu.ar)
+ * @brief Reentrant number to text conversion
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include "format_mcu.h"
+#include <string.h>
+/*==================[macros and definitions]=================================*/
+
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+/**
+ * @brief Decimal digits of 0 to 99
+ */
+static const char digit_pairs[201] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
+
+static const uint32_t pow10_table[10] = {
+	1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+/**
+ * @brief Number of decimal digits of val
+ */
+static uint8_t DecimalDigits(uint32_t val){
+	uint8_t n = 1;
+	while((n < 10) && (val >= pow10_table[n])){
+		n++;
+	}
+	return n;
+}
+
+/**
+ * @brief Write exactly n decimal digits of val (with leading zeros), without '\0'
+ */
+static void WriteDigits(char *buf, uint32_t val, uint8_t n){
+	char *p = buf + n;
+	while(n >= 2){
+		uint32_t q = val / 100;
+		p -= 2;
+		memcpy(p, &digit_pairs[2 * (val - q * 100)], 2);
+		val = q;
+		n -= 2;
+	}
+	if(n){
+		*--p = '0' + val % 10;
+	}
+}
+/*==================[external functions definition]==========================*/
+uint8_t FormatUint(char *buf, uint32_t val){
+	uint8_t n = DecimalDigits(val);
+	WriteDigits(buf, val, n);
+	buf[n] = '\0';
+	return n;
+}
+
+uint8_t FormatInt(char *buf, int32_t val){
+	if(val < 0){
+		*buf = '-';
+		return 1 + FormatUint(buf + 1, -(uint32_t)val);
+	}
+	return FormatUint(buf, val);
+}
+
+uint8_t FormatUintBase(char *buf, uint32_t val, uint8_t base){
+	char tmp[32];
+	uint8_t n = 0;
+	if((base < 2) || (base > 16)){
+		buf[0] = '\0';
+		return 0;
+	}
+	if(base == 10){
+		return FormatUint(buf, val);
+	}
+	do{
+		tmp[n++] = "0123456789abcdef"[val % base];
+		val /= base;
+	}while(val);
+	for(uint8_t i=0; i<n; i++){
+		buf[i] = tmp[n - 1 - i];
+	}
+	buf[n] = '\0';
+	return n;
+}
+
+uint8_t FormatFixed(char *buf, int32_t val, uint8_t decimals){
+	char *p = buf;
+	uint32_t abs_val = val;
+	if(decimals > 9){
+		decimals = 9;
+	}
+	if(val < 0){
+		*p++ = '-';
+		abs_val = -(uint32_t)val;
+	}
+	if(decimals == 0){
+		return (p - buf) + FormatUint(p, abs_val);
+	}
+	p += FormatUint(p, abs_val / pow10_table[decimals]);
+	*p++ = '.';
+	WriteDigits(p, abs_val % pow10_table[decimals], decimals);
+	p += decimals;
+	*p = '\0';
+	return p - buf;
+}
+
+uint8_t FormatFloat(char *buf, float val, uint8_t decimals){
+	char *p = buf;
+	if(val != val){
+		memcpy(buf, "nan", 4);
+		return 3;
+	}
+	if(decimals > FORMAT_FLOAT_MAX_DEC){
+		decimals = FORMAT_FLOAT_MAX_DEC;
+	}
+	if(val < 0){
+		*p++ = '-';
+		val = -val;
+	}
+	if(val >= 4294967295.0f){
+		memcpy(p, "ovf", 4);
+		return (p - buf) + 3;
+	}
+	// round once, then split the scaled value in integer and decimal parts
+	uint64_t scaled = (uint64_t)((double)val * pow10_table[decimals] + 0.5);
+	uint32_t integer = scaled / pow10_table[decimals];
+	uint32_t fraction = scaled - (uint64_t)integer * pow10_table[decimals];
+	if((integer == 0) && (fraction == 0) && (p != buf)){
+		p = buf;		// no "-0"
+	}
+	p += FormatUint(p, integer);
+	if(decimals){
+		*p++ = '.';
+		WriteDigits(p, fraction, decimals);
+		p += decimals;
+	}
+	*p = '\0';
+	return p - buf;
+}
+
+uint32_t FormatCsvUint16(char *buf, const uint16_t *samples, uint32_t lenght, uint8_t columns){
+	char *p = buf;
+	uint8_t column = 0;
+	for(uint32_t i=0; i<lenght; i++){
+		uint8_t n = DecimalDigits(samples[i]);
+		WriteDigits(p, samples[i], n);
+		p += n;
+		if(++column >= columns){
+			*p++ = '\n';
+			column = 0;
+		}else{
+			*p++ = ',';
+		}
+	}
+	if(column){
+		p[-1] = '\n';
+	}
+	*p = '\0';
+	return p - buf;
+}
+
+uint32_t FormatCsvFloat(char *buf, const float *samples, uint32_t lenght, uint8_t columns, uint8_t decimals){
+	char *p = buf;
+	uint8_t column = 0;
+	for(uint32_t i=0; i<lenght; i++){
+		p += FormatFloat(p, samples[i], decimals);
+		if(++column >= columns){
+			*p++ = '\n';
+			column = 0;
+		}else{
+			*p++ = ',';
+		}
+	}
+	if(column){
+		p[-1] = '\n';
+	}
+	*p = '\0';
+	return p - buf;
+}
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/*==================[end of file]============================================*/
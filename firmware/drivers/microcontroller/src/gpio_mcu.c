@@ -24,7 +24,7 @@ typedef struct{
 	bool state;					/*!< GPIO output state */
 } digital_io_t;
 /*==================[internal data declaration]==============================*/
-
+static bool isr_service_installed = false;
 /*==================[internal functions declaration]=========================*/
 
 /*==================[internal data definition]===============================*/
@@ -62,7 +62,13 @@ gpio_flex_glitch_filter_config_t filter_config = {
 /*==================[external data definition]===============================*/
 
 /*==================[internal functions definition]==========================*/
-
+static void GPIOAddIsr(gpio_t pin, void *ptr_int_func, void *args){
+	if(!isr_service_installed){	
+		gpio_install_isr_service(0);
+		isr_service_installed = true;
+	}
+    gpio_isr_handler_add(gpio_list[pin].pin, ptr_int_func, (void *)args);	
+}
 /*==================[external functions definition]==========================*/
 void GPIOInit(gpio_t pin, io_t io){
 	if((pin == GPIO_14) || (pin > GPIO_23)){
@@ -103,17 +109,22 @@ bool GPIORead(gpio_t pin){
 }
 
 void GPIOActivInt(gpio_t pin, void *ptr_int_func, bool edge, void *args){
-	static bool isr_service_installed = false;
 	if(edge){
 		gpio_set_intr_type(gpio_list[pin].pin, GPIO_INTR_POSEDGE);
 	} else{
 		gpio_set_intr_type(gpio_list[pin].pin, GPIO_INTR_NEGEDGE);
 	}
-	if(!isr_service_installed){	
-		gpio_install_isr_service(0);
-		isr_service_installed = true;
-	}
-    gpio_isr_handler_add(gpio_list[pin].pin, ptr_int_func, (void *)args);	
+	GPIOAddIsr(pin, ptr_int_func, args);
+}
+
+void GPIOActivIntAnyEdge(gpio_t pin, void *ptr_int_func, void *args){
+	gpio_set_intr_type(gpio_list[pin].pin, GPIO_INTR_ANYEDGE);
+	GPIOAddIsr(pin, ptr_int_func, args);
+}
+
+void GPIODeactivInt(gpio_t pin){
+	gpio_isr_handler_remove(gpio_list[pin].pin);
+	gpio_set_intr_type(gpio_list[pin].pin, GPIO_INTR_DISABLE);
 }
 
 void GPIOInputFilter(gpio_t pin){
@@ -0,0 +1,177 @@
+/**
+ * @file ring_buffer_mcu.c
+ * @author Valentina de la Rosa (valentina.delarosa@ingenieria.uner.edu.ar)
+ * @brief Lock-free single producer / single consumer ring buffer
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include "ring_buffer_mcu.h"
+#include <string.h>
+#include "esp_attr.h"
+/*==================[macros and definitions]=================================*/
+
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+/**
+ * @brief Copy elements to the buffer and publish them
+ *
+ * @return uint32_t Number of elements stored after writing
+ */
+static uint32_t IRAM_ATTR Store(ring_buffer_t *rb, const void *data, uint32_t *n){
+	uint32_t head = atomic_load_explicit(&rb->head, memory_order_relaxed);
+	uint32_t tail = atomic_load_explicit(&rb->tail, memory_order_acquire);
+	uint32_t room = (rb->mask + 1) - (head - tail);
+	if(*n > room){
+		rb->overflows += *n - room;
+		*n = room;
+	}
+	uint32_t idx = head & rb->mask;
+	uint32_t first = rb->mask + 1 - idx;
+	if(first > *n){
+		first = *n;
+	}
+	memcpy(&rb->buffer[idx * rb->element_size], data, first * rb->element_size);
+	memcpy(rb->buffer, (const uint8_t *)data + first * rb->element_size, (*n - first) * rb->element_size);
+	atomic_store_explicit(&rb->head, head + *n, memory_order_release);
+	return head + *n - tail;
+}
+/*==================[external functions definition]==========================*/
+bool RingBufferInit(ring_buffer_t *rb, void *buffer, uint32_t lenght, uint16_t element_size){
+	if((lenght == 0) || (lenght & (lenght - 1)) || (element_size == 0)){
+		return false;
+	}
+	atomic_init(&rb->head, 0);
+	atomic_init(&rb->tail, 0);
+	rb->overflows = 0;
+	rb->buffer = buffer;
+	rb->mask = lenght - 1;
+	rb->element_size = element_size;
+	rb->watermark = 1;
+	rb->consumer = NULL;
+	return true;
+}
+
+void RingBufferSetConsumer(ring_buffer_t *rb, TaskHandle_t task, uint32_t watermark){
+	if(watermark == 0){
+		watermark = 1;
+	}else if(watermark > rb->mask + 1){
+		watermark = rb->mask + 1;
+	}
+	rb->watermark = watermark;
+	rb->consumer = task;
+}
+
+uint32_t RingBufferWrite(ring_buffer_t *rb, const void *data, uint32_t n){
+	Store(rb, data, &n);
+	return n;
+}
+
+uint32_t IRAM_ATTR RingBufferWriteFromISR(ring_buffer_t *rb, const void *data, uint32_t n, BaseType_t *task_woken){
+	uint32_t stored = Store(rb, data, &n);
+	// notify only when the watermark is crossed
+	if((rb->consumer != NULL) && (n > 0) && (stored >= rb->watermark) && ((stored - n) < rb->watermark)){
+		vTaskNotifyGiveFromISR(rb->consumer, task_woken);
+	}
+	return n;
+}
+
+uint32_t RingBufferReserve(ring_buffer_t *rb, void **data){
+	uint32_t head = atomic_load_explicit(&rb->head, memory_order_relaxed);
+	uint32_t tail = atomic_load_explicit(&rb->tail, memory_order_acquire);
+	uint32_t idx = head & rb->mask;
+	uint32_t n = (rb->mask + 1) - (head - tail);
+	if(n > rb->mask + 1 - idx){
+		n = rb->mask + 1 - idx;
+	}
+	*data = &rb->buffer[idx * rb->element_size];
+	return n;
+}
+
+void RingBufferCommit(ring_buffer_t *rb, uint32_t n){
+	uint32_t head = atomic_load_explicit(&rb->head, memory_order_relaxed);
+	atomic_store_explicit(&rb->head, head + n, memory_order_release);
+}
+
+uint32_t RingBufferRead(ring_buffer_t *rb, void *data, uint32_t max_n){
+	uint32_t n = 0;
+	const void *chunk;
+	// at most two contiguous chunks
+	for(uint8_t i=0; (i<2) && (n < max_n); i++){
+		uint32_t lenght = RingBufferPeek(rb, &chunk);
+		if(lenght == 0){
+			break;
+		}
+		if(lenght > max_n - n){
+			lenght = max_n - n;
+		}
+		memcpy((uint8_t *)data + n * rb->element_size, chunk, lenght * rb->element_size);
+		RingBufferConsume(rb, lenght);
+		n += lenght;
+	}
+	return n;
+}
+
+uint32_t RingBufferWait(ring_buffer_t *rb, void *data, uint32_t max_n, TickType_t timeout){
+	TickType_t start = xTaskGetTickCount();
+	TickType_t remaining = timeout;
+	// a stale notification (from a write already read) only restarts the wait
+	while(RingBufferAvailable(rb) < rb->watermark){
+		if(ulTaskNotifyTake(pdTRUE, remaining) == 0){
+			break;
+		}
+		if(timeout != portMAX_DELAY){
+			TickType_t elapsed = xTaskGetTickCount() - start;
+			if(elapsed >= timeout){
+				break;
+			}
+			remaining = timeout - elapsed;
+		}
+	}
+	return RingBufferRead(rb, data, max_n);
+}
+
+uint32_t RingBufferPeek(ring_buffer_t *rb, const void **data){
+	uint32_t tail = atomic_load_explicit(&rb->tail, memory_order_relaxed);
+	uint32_t head = atomic_load_explicit(&rb->head, memory_order_acquire);
+	uint32_t idx = tail & rb->mask;
+	uint32_t n = head - tail;
+	if(n > rb->mask + 1 - idx){
+		n = rb->mask + 1 - idx;
+	}
+	*data = &rb->buffer[idx * rb->element_size];
+	return n;
+}
+
+void RingBufferConsume(ring_buffer_t *rb, uint32_t n){
+	uint32_t tail = atomic_load_explicit(&rb->tail, memory_order_relaxed);
+	atomic_store_explicit(&rb->tail, tail + n, memory_order_release);
+}
+
+uint32_t RingBufferAvailable(ring_buffer_t *rb){
+	return atomic_load_explicit(&rb->head, memory_order_acquire) - atomic_load_explicit(&rb->tail, memory_order_relaxed);
+}
+
+uint32_t RingBufferFree(ring_buffer_t *rb){
+	return (rb->mask + 1) - (atomic_load_explicit(&rb->head, memory_order_relaxed) - atomic_load_explicit(&rb->tail, memory_order_acquire));
+}
+
+uint32_t RingBufferOverflows(ring_buffer_t *rb){
+	return rb->overflows;
+}
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/*==================[end of file]============================================*/
@@ -0,0 +1,210 @@
+/**
+ * @file soft_timer_mcu.c
+ * @author Valentina de la Rosa (valentina.delarosa@ingenieria.uner.edu.ar)
+ * @brief Software timers multiplexed on a single hardware timer
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include "soft_timer_mcu.h"
+#include "driver/gptimer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+/*==================[macros and definitions]=================================*/
+#define US_RESOLUTION_HZ	1000000						/*!< 1usec */
+#define WHEEL_MASK			(SOFT_TIMER_WHEEL_SIZE - 1)
+#define SOFT_TIMER_STACK	2048						/*!< Stack of the callbacks task */
+#define SOFT_TIMER_PRIORITY	(configMAX_PRIORITIES - 2)	/*!< Priority of the callbacks task */
+/*==================[internal data declaration]==============================*/
+static gptimer_handle_t soft_timer_hw = NULL;			/*!< Hardware timer generating the tick */
+static soft_timer_t *soft_timer_wheel[SOFT_TIMER_WHEEL_SIZE];	/*!< Timers of each slot */
+static soft_timer_t *soft_timer_cursor = NULL;			/*!< Next timer visited by the tick ISR */
+static volatile uint32_t soft_timer_ticks = 0;			/*!< Ticks since SoftTimerInit() */
+static uint32_t soft_timer_tick_us;						/*!< Tick period (us) */
+static uint32_t soft_timer_lost = 0;					/*!< SOFT_TIMER_TASK callbacks lost */
+static QueueHandle_t soft_timer_queue = NULL;			/*!< Callbacks for the task */
+static portMUX_TYPE soft_timer_mux = portMUX_INITIALIZER_UNLOCKED;
+/*==================[internal functions declaration]=========================*/
+static bool IRAM_ATTR soft_timer_isr(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *user_data);
+/*==================[internal data definition]===============================*/
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+/**
+ * @brief Insert a timer at the head of the slot of its expiration (mux taken)
+ */
+static void IRAM_ATTR WheelInsert(soft_timer_t *timer){
+	soft_timer_t **slot = &soft_timer_wheel[timer->expiry & WHEEL_MASK];
+	timer->prev = NULL;
+	timer->next = *slot;
+	if(*slot != NULL){
+		(*slot)->prev = timer;
+	}
+	*slot = timer;
+	timer->active = true;
+}
+
+/**
+ * @brief Remove a timer from its slot (mux taken)
+ */
+static void IRAM_ATTR WheelRemove(soft_timer_t *timer){
+	if(timer == soft_timer_cursor){
+		soft_timer_cursor = timer->next;
+	}
+	if(timer->prev != NULL){
+		timer->prev->next = timer->next;
+	}else{
+		soft_timer_wheel[timer->expiry & WHEEL_MASK] = timer->next;
+	}
+	if(timer->next != NULL){
+		timer->next->prev = timer->prev;
+	}
+	timer->active = false;
+}
+
+/**
+ * @brief Ticks to wait for us, rounded up (inlined, also used from ISR callbacks)
+ */
+static inline uint32_t UsToTicks(uint32_t us){
+	return (us + soft_timer_tick_us - 1) / soft_timer_tick_us;
+}
+
+/**
+ * @brief Tick ISR: runs the timers of the current slot that expire in this tick
+ * 
+ * The expired timers are collected with the mux taken and their callbacks run 
+ * after releasing it, so interrupts are not masked during the callbacks.
+ */
+static bool IRAM_ATTR soft_timer_isr(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *user_data){
+	(void)timer;
+	(void)edata;
+	(void)user_data;
+	BaseType_t task_woken = pdFALSE;
+	bool yield = false;
+	soft_timer_t *fired = NULL;
+	soft_timer_t **last = &fired;
+	portENTER_CRITICAL_ISR(&soft_timer_mux);
+	uint32_t now = ++soft_timer_ticks;
+	soft_timer_cursor = soft_timer_wheel[now & WHEEL_MASK];
+	while(soft_timer_cursor != NULL){
+		soft_timer_t *t = soft_timer_cursor;
+		soft_timer_cursor = t->next;
+		if(t->expiry != now){
+			continue;				// expires in a later turn of the wheel
+		}
+		WheelRemove(t);
+		if(t->period != 0){
+			// reschedule from the deadline, not from now
+			t->expiry += t->period;
+			WheelInsert(t);
+		}
+		// keep the expiration order
+		t->fired = NULL;
+		*last = t;
+		last = &t->fired;
+	}
+	portEXIT_CRITICAL_ISR(&soft_timer_mux);
+	while(fired != NULL){
+		soft_timer_t *t = fired;
+		fired = t->fired;
+		if(t->mode == SOFT_TIMER_ISR){
+			// callbacks may start or cancel timers
+			yield |= t->func_p(t->param_p);
+		}else if(xQueueSendFromISR(soft_timer_queue, &t, &task_woken) != pdTRUE){
+			soft_timer_lost++;
+		}
+	}
+	return yield || (task_woken == pdTRUE);
+}
+
+/**
+ * @brief Runs the SOFT_TIMER_TASK callbacks
+ */
+static void SoftTimerTask(void *pvParameters){
+	soft_timer_t *t;
+	while(1){
+		if(xQueueReceive(soft_timer_queue, &t, portMAX_DELAY) == pdTRUE){
+			t->func_p(t->param_p);
+		}
+	}
+}
+/*==================[external functions definition]==========================*/
+void SoftTimerInit(uint32_t tick_us){
+	if(soft_timer_hw != NULL){
+		return;
+	}
+	soft_timer_tick_us = (tick_us == 0) ? SOFT_TIMER_TICK_US : tick_us;
+	soft_timer_queue = xQueueCreate(SOFT_TIMER_QUEUE_SIZE, sizeof(soft_timer_t *));
+	xTaskCreate(SoftTimerTask, "soft_timer_task", SOFT_TIMER_STACK, NULL, SOFT_TIMER_PRIORITY, NULL);
+	gptimer_config_t timer_config = {
+		.clk_src = GPTIMER_CLK_SRC_DEFAULT,
+		.direction = GPTIMER_COUNT_UP,
+		.resolution_hz = US_RESOLUTION_HZ,
+	};
+	ESP_ERROR_CHECK(gptimer_new_timer(&timer_config, &soft_timer_hw));
+	gptimer_alarm_config_t alarm_config = {
+		.alarm_count = soft_timer_tick_us,
+		.reload_count = 0,
+		.flags.auto_reload_on_alarm = true,
+	};
+	ESP_ERROR_CHECK(gptimer_set_alarm_action(soft_timer_hw, &alarm_config));
+	gptimer_event_callbacks_t cbs = {
+		.on_alarm = soft_timer_isr,
+	};
+	ESP_ERROR_CHECK(gptimer_register_event_callbacks(soft_timer_hw, &cbs, NULL));
+	ESP_ERROR_CHECK(gptimer_enable(soft_timer_hw));
+	ESP_ERROR_CHECK(gptimer_start(soft_timer_hw));
+}
+
+void SoftTimerSetup(soft_timer_t *timer, void *func_p, void *param_p, soft_timer_mode_t mode){
+	timer->func_p = func_p;
+	timer->param_p = param_p;
+	timer->mode = mode;
+	timer->active = false;
+}
+
+void IRAM_ATTR SoftTimerStart(soft_timer_t *timer, uint32_t delay_us, uint32_t period_us){
+	uint32_t delay = UsToTicks(delay_us);
+	if(delay == 0){
+		delay = 1;
+	}
+	portENTER_CRITICAL_SAFE(&soft_timer_mux);
+	if(timer->active){
+		WheelRemove(timer);
+	}
+	timer->period = UsToTicks(period_us);
+	timer->expiry = soft_timer_ticks + delay;
+	WheelInsert(timer);
+	portEXIT_CRITICAL_SAFE(&soft_timer_mux);
+}
+
+void IRAM_ATTR SoftTimerCancel(soft_timer_t *timer){
+	portENTER_CRITICAL_SAFE(&soft_timer_mux);
+	if(timer->active){
+		WheelRemove(timer);
+	}
+	portEXIT_CRITICAL_SAFE(&soft_timer_mux);
+}
+
+bool SoftTimerActive(soft_timer_t *timer){
+	return timer->active;
+}
+
+uint32_t SoftTimerTicks(void){
+	return soft_timer_ticks;
+}
+
+uint32_t SoftTimerLostCallbacks(void){
+	return soft_timer_lost;
+}
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/*==================[end of file]============================================*/
@@ -14,9 +14,20 @@
 #include "driver/gptimer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "esp_timer.h"
+#include "delay_mcu.h"
+#include <string.h>
 /*==================[macros and definitions]=================================*/
 #define US_RESOLUTION_HZ	1000000	/*!< 1usec */
 #define RESET_COUNT_VALUE	0		/*!< Reset timer count to 0 */
+#define N_TIMERS			3		/*!< TIMER_A, TIMER_B and TIMER_C */
+#define TICK_US				(1000000 / configTICK_RATE_HZ)	/*!< RTOS tick (us) */
+#define YIELD_NOT_REPORTED	(-1)	/*!< Callback without TimerNotifyFromISR(): always yield, as before */
+#if TIMER_INSTRUMENTATION
+#define TIMER_STAMP_ALARM(timer, handle)	TimerStampAlarm(timer, handle)
+#else
+#define TIMER_STAMP_ALARM(timer, handle)
+#endif
 /*==================[internal data declaration]==============================*/
 gptimer_handle_t timer_a = NULL;	/*!< Handle for timer A */	
 gptimer_handle_t timer_b = NULL;	/*!< Handle for timer B */			
@@ -44,27 +55,95 @@ void *timer_c_user_data;	            /*!< User data for timer C */
 gptimer_alarm_config_t alarm_config_a;  /*!< Configuration for alarm A */
 gptimer_alarm_config_t alarm_config_b;	/*!< Configuration for alarm B */
 gptimer_alarm_config_t alarm_config_c;	/*!< Configuration for alarm C */
+static int64_t timer_epoch = 0;			/*!< Epoch of the periodic activities (0: not set) */
+static portMUX_TYPE timer_epoch_mux = portMUX_INITIALIZER_UNLOCKED;
+static volatile BaseType_t timer_yield[N_TIMERS];	/*!< Context switch requested by TimerNotifyFromISR() in the running callback */
+#if TIMER_INSTRUMENTATION
+/**
+ * @brief Instrumentation state of a timer
+ */
+typedef struct {
+	timer_stats_t stats;				/*!< Statistics */
+	int64_t last_isr;					/*!< Time of the last ISR (us) */
+	int64_t last_alarm;					/*!< Time of the last alarm (us) */
+	bool pending;						/*!< Alarm not matched with a task wake up yet */
+} timer_trace_t;
+static timer_trace_t timer_trace[N_TIMERS];
+static portMUX_TYPE timer_trace_mux = portMUX_INITIALIZER_UNLOCKED;
+static void IRAM_ATTR TimerStampAlarm(timer_mcu_t timer, gptimer_handle_t handle);
+#endif
 /*==================[internal functions declaration]=========================*/
 static bool IRAM_ATTR timer_a_isr(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *user_data){
+	TIMER_STAMP_ALARM(TIMER_A, timer);
+	timer_yield[TIMER_A] = YIELD_NOT_REPORTED;
 	timer_a_isr_p(timer_a_user_data);
-	return true;
+	return timer_yield[TIMER_A] != pdFALSE;
 }
 static bool IRAM_ATTR timer_b_isr(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *user_data){
+	TIMER_STAMP_ALARM(TIMER_B, timer);
+	timer_yield[TIMER_B] = YIELD_NOT_REPORTED;
 	timer_b_isr_p(timer_b_user_data);
-	return true;
+	return timer_yield[TIMER_B] != pdFALSE;
 }
 static bool IRAM_ATTR timer_c_isr(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *user_data){
+	TIMER_STAMP_ALARM(TIMER_C, timer);
+	timer_yield[TIMER_C] = YIELD_NOT_REPORTED;
 	timer_c_isr_p(timer_c_user_data);
-	return true;
+	return timer_yield[TIMER_C] != pdFALSE;
 }
 /*==================[internal data definition]===============================*/
 
 /*==================[external data definition]===============================*/
 
 /*==================[internal functions definition]==========================*/
+#if TIMER_INSTRUMENTATION
+static inline void StatsMinMax(uint32_t value, uint32_t *min, uint32_t *max){
+	if(value < *min){
+		*min = value;
+	}
+	if(value > *max){
+		*max = value;
+	}
+}
+
+static void StatsReset(timer_trace_t *trace){
+	memset(trace, 0, sizeof(timer_trace_t));
+	trace->stats.isr_latency_min = UINT32_MAX;
+	trace->stats.wake_latency_min = UINT32_MAX;
+	trace->stats.period_min = UINT32_MAX;
+}
+
+/**
+ * @brief Timestamp an alarm at the beginning of the timer ISR
+ * 
+ * The count is reloaded to 0 on every alarm, so the count read in the ISR is the
+ * time elapsed since the alarm.
+ */
+static void IRAM_ATTR TimerStampAlarm(timer_mcu_t timer, gptimer_handle_t handle){
+	timer_trace_t *trace = &timer_trace[timer];
+	uint64_t latency;
+	int64_t now = esp_timer_get_time();
+	gptimer_get_raw_count(handle, &latency);
+	portENTER_CRITICAL_ISR(&timer_trace_mux);
+	if(trace->stats.alarms > 0){
+		StatsMinMax(now - trace->last_isr, &trace->stats.period_min, &trace->stats.period_max);
+	}
+	StatsMinMax(latency, &trace->stats.isr_latency_min, &trace->stats.isr_latency_max);
+	if(trace->pending){
+		trace->stats.overruns++;
+	}
+	trace->stats.alarms++;
+	trace->last_isr = now;
+	trace->last_alarm = now - latency;
+	portEXIT_CRITICAL_ISR(&timer_trace_mux);
+}
+#endif
 
 /*==================[external functions definition]==========================*/
 void TimerInit(timer_config_t *timer_ini){
+#if TIMER_INSTRUMENTATION
+	StatsReset(&timer_trace[timer_ini->timer]);
+#endif
 	switch(timer_ini->timer){
 	 	case TIMER_A:
 			timer_a_isr_p = timer_ini->func_p;
@@ -188,4 +267,116 @@ void TimerUpdatePeriod(timer_mcu_t timer, uint32_t period){
 	}
 }
 
+int64_t TimerEpoch(void){
+	portENTER_CRITICAL(&timer_epoch_mux);
+	if(timer_epoch == 0){
+		timer_epoch = esp_timer_get_time();
+	}
+	portEXIT_CRITICAL(&timer_epoch_mux);
+	return timer_epoch;
+}
+
+void TimerPeriodicInit(timer_periodic_t *periodic, uint32_t period_us, uint32_t phase_us, timer_overrun_t policy){
+	int64_t now = esp_timer_get_time();
+	periodic->period = period_us;
+	periodic->policy = policy;
+	periodic->overruns = 0;
+	periodic->next = TimerEpoch() + phase_us;
+	if(periodic->next <= now){
+		periodic->next += ((now - periodic->next) / period_us + 1) * period_us;
+	}
+}
+
+uint32_t TimerPeriodicWait(timer_periodic_t *periodic){
+	int64_t now = esp_timer_get_time();
+	int64_t remaining = periodic->next - now;
+	uint32_t missed = 0;
+	if(remaining > 2 * TICK_US){
+		// wake up before the deadline, at the earliest in the tick before it
+		vTaskDelay(remaining / TICK_US - 1);
+		remaining = periodic->next - esp_timer_get_time();
+	}
+	if(remaining <= 0){
+		missed = -remaining / periodic->period;
+	}
+	while(remaining > 0){
+		// DelayUs() takes 16 bits, more than one call with slow RTOS ticks
+		DelayUs((remaining > UINT16_MAX) ? UINT16_MAX : remaining);
+		remaining = periodic->next - esp_timer_get_time();
+	}
+	switch(periodic->policy){
+		case TIMER_OVERRUN_SKIP:
+			periodic->overruns += missed;
+			periodic->next += (int64_t)(missed + 1) * periodic->period;
+		break;
+		case TIMER_OVERRUN_CATCH_UP:
+			// the missed activations are run late, one per call
+			periodic->overruns += (missed > 0);
+			periodic->next += periodic->period;
+		break;
+		case TIMER_OVERRUN_REPORT:
+			periodic->overruns += missed;
+			periodic->next = (missed > 0) ? (now + periodic->period) : (periodic->next + periodic->period);
+		break;
+	}
+	return missed;
+}
+
+void TimerPeriodicUpdate(timer_periodic_t *periodic, uint32_t period_us){
+	periodic->period = period_us;
+}
+
+BaseType_t IRAM_ATTR TimerNotifyFromISR(timer_mcu_t timer, TaskHandle_t task){
+	BaseType_t task_woken = pdFALSE;
+#if TIMER_INSTRUMENTATION
+	portENTER_CRITICAL_ISR(&timer_trace_mux);
+	timer_trace[timer].pending = true;
+	portEXIT_CRITICAL_ISR(&timer_trace_mux);
+#endif
+	vTaskNotifyGiveFromISR(task, &task_woken);
+	// the callback wrapper yields on return if any notified task asked for it
+	if(timer_yield[timer] != pdTRUE){
+		timer_yield[timer] = task_woken;
+	}
+	return task_woken;
+}
+
+void TimerTaskWoken(timer_mcu_t timer){
+#if TIMER_INSTRUMENTATION
+	timer_trace_t *trace = &timer_trace[timer];
+	int64_t now = esp_timer_get_time();
+	portENTER_CRITICAL(&timer_trace_mux);
+	if(trace->pending){
+		uint32_t latency = now - trace->last_alarm;
+		uint8_t bin = 0;
+		while((bin < TIMER_HISTOGRAM_BINS - 1) && (latency >> bin)){
+			bin++;
+		}
+		StatsMinMax(latency, &trace->stats.wake_latency_min, &trace->stats.wake_latency_max);
+		trace->stats.wake_histogram[bin]++;
+		trace->stats.wakes++;
+		trace->pending = false;
+	}
+	portEXIT_CRITICAL(&timer_trace_mux);
+#endif
+}
+
+void TimerGetStats(timer_mcu_t timer, timer_stats_t *stats){
+#if TIMER_INSTRUMENTATION
+	portENTER_CRITICAL(&timer_trace_mux);
+	*stats = timer_trace[timer].stats;
+	portEXIT_CRITICAL(&timer_trace_mux);
+#else
+	memset(stats, 0, sizeof(timer_stats_t));
+#endif
+}
+
+void TimerResetStats(timer_mcu_t timer){
+#if TIMER_INSTRUMENTATION
+	portENTER_CRITICAL(&timer_trace_mux);
+	StatsReset(&timer_trace[timer]);
+	portEXIT_CRITICAL(&timer_trace_mux);
+#endif
+}
+
 /*==================[end of file]============================================*/
@@ -0,0 +1,52 @@
+/**
+ * @file timer_stats_mcu.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief Text report of the timer instrumentation statistics
+ * @version 0.1
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+/*==================[inclusions]=============================================*/
+#include "timer_stats_mcu.h"
+/*==================[macros and definitions]=================================*/
+
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+
+/*==================[external functions definition]==========================*/
+void TimerDumpStats(timer_mcu_t timer, uart_mcu_port_t port){
+	timer_stats_t stats;
+	TimerGetStats(timer, &stats);
+	if(stats.alarms == 0){
+		UartPrintf(port, "timer %c: no alarms\r\n", 'A' + timer);
+		return;
+	}
+	UartPrintf(port, "timer %c: alarms %lu, wakes %lu, overruns %lu\r\n", 'A' + timer,
+		(unsigned long)stats.alarms, (unsigned long)stats.wakes, (unsigned long)stats.overruns);
+	UartPrintf(port, "  isr latency %lu..%lu us, period %lu..%lu us\r\n",
+		(unsigned long)stats.isr_latency_min, (unsigned long)stats.isr_latency_max,
+		(unsigned long)stats.period_min, (unsigned long)stats.period_max);
+	if(stats.wakes > 0){
+		UartPrintf(port, "  wake latency %lu..%lu us\r\n",
+			(unsigned long)stats.wake_latency_min, (unsigned long)stats.wake_latency_max);
+		UartPrintf(port, "  histogram 0us:%lu", (unsigned long)stats.wake_histogram[0]);
+		for(uint8_t i=1; i<TIMER_HISTOGRAM_BINS; i++){
+			UartPrintf(port, (i < TIMER_HISTOGRAM_BINS - 1) ? " <%lu:%lu" : " >=%lu:%lu",
+				(unsigned long)((i < TIMER_HISTOGRAM_BINS - 1) ? (1UL << i) : (1UL << (i - 1))),
+				(unsigned long)stats.wake_histogram[i]);
+		}
+		UartPrintf(port, "\r\n");
+	}
+}
+
+/*==================[end of file]============================================*/
@@ -12,10 +12,18 @@
 /*==================[inclusions]=============================================*/
 #include "uart_mcu.h"
 #include "gpio_mcu.h"
+#include "ring_buffer_mcu.h"
+#include "format_mcu.h"
 #include "driver/uart.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
 #include "esp_log.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 /*==================[macros and definitions]=================================*/
 #define UART_CONN_TX        GPIO_18         /*!<  */
 #define UART_CONN_RX        GPIO_19         /*!<  */
@@ -23,6 +31,8 @@
 #define RX_BUFFER_SIZE      256             /*!<  */
 #define EVENT_QUEUE_SIZE    16              /*!<  */
 #define READ_TIMEOUT        100             /*!<  */
+#define TX_TASK_STACK       2048            /*!< Stack of the asynchronous transmission task */
+#define TX_TASK_PRIORITY    11              /*!< Priority of the asynchronous transmission task */
 /*==================[internal data declaration]==============================*/
 void (*uart_pc_isr_p)(void*);	            /*!<  */
 void (*uart_conn_isr_p)(void*);	            /*!<  */
@@ -30,13 +40,144 @@ void *uart_pc_user_data;	                /*!<  */
 void *uart_conn_user_data;	                /*!<  */
 static QueueHandle_t uart_pc_queue;         /*!<  */
 static QueueHandle_t uart_conn_queue;       /*!<  */
+static uint8_t uart_stream_frame[2][UART_STREAM_MAX_FRAME];	/*!< Frame being sent on each port */
+/**
+ * @brief Asynchronous transmission queued for the TX task
+ */
+typedef struct {
+    const uint8_t *data;                    /*!< Buffer to send (NULL: next bytes of the TX ring) */
+    uint32_t lenght;                        /*!< Number of bytes */
+    void (*func_p)(void*);                  /*!< Callback when sent */
+    void *param_p;                          /*!< Callback parameters */
+} uart_tx_item_t;
+/**
+ * @brief Asynchronous transmission state of a port
+ */
+typedef struct {
+    ring_buffer_t ring;                     /*!< Bytes copied by UartSendAsync() and UartPrintf() */
+    QueueHandle_t queue;                    /*!< Pending transmissions (NULL: not started yet) */
+    SemaphoreHandle_t mutex;                /*!< Serializes the producer tasks */
+    StaticSemaphore_t mutex_storage;        /*!< Mutex storage (no heap used by UartInit()) */
+    uint32_t ring_size;                     /*!< TX ring size (bytes, power of two) */
+} uart_tx_t;
+static uart_tx_t uart_tx[2];                /*!< Asynchronous transmission state of each port */
+/**
+ * @brief Complete line stored in the line ring
+ */
+typedef struct {
+    char *data;                             /*!< First character */
+    uint16_t lenght;                        /*!< Line lenght (without delimiter) */
+    uint16_t size;                          /*!< Bytes used in the line ring (padding + line + delimiter) */
+} uart_line_item_t;
+/**
+ * @brief Line mode state of a port
+ */
+typedef struct {
+    ring_buffer_t ring;                     /*!< Received lines */
+    QueueHandle_t lines;                    /*!< Complete lines not released */
+    QueueHandle_t events;                   /*!< UART driver events */
+    char delimiter;                         /*!< Line delimiter */
+    void (*func_p)(void*);                  /*!< Callback for each complete line */
+    void *param_p;                          /*!< Callback parameters */
+} uart_line_t;
+static uart_line_t uart_line[2];            /*!< Line mode state of each port */
+static uart_rx_stats_t uart_rx_stats[2];    /*!< Receive statistics of each port */
 /*==================[internal functions declaration]=========================*/
 
 /*==================[internal data definition]===============================*/
+/**
+ * @brief CRC16-CCITT lookup table (polynomial 0x1021)
+ */
+static const uint16_t crc16_table[256] = {
+	0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+	0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+	0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6,
+	0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE,
+	0x2462, 0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485,
+	0xA56A, 0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D,
+	0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4,
+	0xB75B, 0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC,
+	0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861, 0x2802, 0x3823,
+	0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B,
+	0x5AF5, 0x4AD4, 0x7AB7, 0x6A96, 0x1A71, 0x0A50, 0x3A33, 0x2A12,
+	0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A,
+	0x6CA6, 0x7C87, 0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41,
+	0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD, 0xAD2A, 0xBD0B, 0x8D68, 0x9D49,
+	0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70,
+	0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A, 0x9F59, 0x8F78,
+	0x9188, 0x81A9, 0xB1CA, 0xA1EB, 0xD10C, 0xC12D, 0xF14E, 0xE16F,
+	0x1080, 0x00A1, 0x30C2, 0x20E3, 0x5004, 0x4025, 0x7046, 0x6067,
+	0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E,
+	0x02B1, 0x1290, 0x22F3, 0x32D2, 0x4235, 0x5214, 0x6277, 0x7256,
+	0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D,
+	0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+	0xA7DB, 0xB7FA, 0x8799, 0x97B8, 0xE75F, 0xF77E, 0xC71D, 0xD73C,
+	0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634,
+	0xD94C, 0xC96D, 0xF90E, 0xE92F, 0x99C8, 0x89E9, 0xB98A, 0xA9AB,
+	0x5844, 0x4865, 0x7806, 0x6827, 0x18C0, 0x08E1, 0x3882, 0x28A3,
+	0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A,
+	0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92,
+	0xFD2E, 0xED0F, 0xDD6C, 0xCD4D, 0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9,
+	0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83, 0x1CE0, 0x0CC1,
+	0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8,
+	0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93, 0x3EB2, 0x0ED1, 0x1EF0,
+};
 
 /*==================[external data definition]===============================*/
 
 /*==================[internal functions definition]==========================*/
+/**
+ * @brief CRC16-CCITT (initial value 0xFFFF)
+ */
+static uint16_t Crc16(const uint8_t *data, uint16_t lenght){
+    uint16_t crc = 0xFFFF;
+    while(lenght--){
+        crc = (crc << 8) ^ crc16_table[(crc >> 8) ^ *data++];
+    }
+    return crc;
+}
+
+/**
+ * @brief Encode samples as zigzag varints of the difference with the previous sample
+ * 
+ * @return uint16_t Payload lenght (bytes)
+ */
+static uint16_t EncodeDelta(const uint16_t *samples, uint16_t lenght, uint8_t *payload){
+    uint8_t *p = payload;
+    int32_t prev = 0;
+    for(uint16_t i=0; i<lenght; i++){
+        int32_t delta = (int32_t)samples[i] - prev;
+        uint32_t zigzag = (delta < 0) ? (((uint32_t)-delta << 1) - 1) : ((uint32_t)delta << 1);
+        while(zigzag >= 0x80){
+            *p++ = (zigzag & 0x7F) | 0x80;
+            zigzag >>= 7;
+        }
+        *p++ = zigzag;
+        prev = samples[i];
+    }
+    return p - payload;
+}
+
+/**
+ * @brief Encode 12 bits samples, two samples in 3 bytes
+ * 
+ * @return uint16_t Payload lenght (bytes)
+ */
+static uint16_t EncodePacked12(const uint16_t *samples, uint16_t lenght, uint8_t *payload){
+    uint8_t *p = payload;
+    uint16_t i;
+    for(i=0; i+1<lenght; i+=2){
+        *p++ = samples[i];
+        *p++ = ((samples[i] >> 8) & 0x0F) | (samples[i+1] << 4);
+        *p++ = samples[i+1] >> 4;
+    }
+    if(i < lenght){
+        *p++ = samples[i];
+        *p++ = (samples[i] >> 8) & 0x0F;
+    }
+    return p - payload;
+}
+
 static void uart_pc_event_task(void *pvParameters){
     uart_event_t event;
     uart_driver_install(UART_NUM_0, RX_BUFFER_SIZE, TX_BUFFER_SIZE, 16, &uart_pc_queue, 0);
@@ -50,8 +191,14 @@ static void uart_pc_event_task(void *pvParameters){
                 case UART_BREAK:
                     break;
                 case UART_BUFFER_FULL:
+                    uart_rx_stats[UART_NUM_0].buffer_full++;
+                    uart_flush_input(UART_NUM_0);
+                    xQueueReset(uart_pc_queue);
                     break;
                 case UART_FIFO_OVF:
+                    uart_rx_stats[UART_NUM_0].fifo_overflows++;
+                    uart_flush_input(UART_NUM_0);
+                    xQueueReset(uart_pc_queue);
                     break;
                 case UART_FRAME_ERR:
                     break;
@@ -83,8 +230,14 @@ static void uart_conn_event_task(void *pvParameters){
                 case UART_BREAK:
                     break;
                 case UART_BUFFER_FULL:
+                    uart_rx_stats[UART_NUM_1].buffer_full++;
+                    uart_flush_input(UART_NUM_1);
+                    xQueueReset(uart_conn_queue);
                     break;
                 case UART_FIFO_OVF:
+                    uart_rx_stats[UART_NUM_1].fifo_overflows++;
+                    uart_flush_input(UART_NUM_1);
+                    xQueueReset(uart_conn_queue);
                     break;
                 case UART_FRAME_ERR:
                     break;
@@ -102,6 +255,242 @@ static void uart_conn_event_task(void *pvParameters){
         }
     }
 }
+/**
+ * @brief Read and discard bytes from the UART driver RX buffer
+ */
+static void UartDiscard(uart_port_t uart_num, uint32_t lenght){
+    uint8_t scratch[32];
+    while(lenght > 0){
+        int n = uart_read_bytes(uart_num, scratch, (lenght > sizeof(scratch)) ? sizeof(scratch) : lenght, 0);
+        if(n <= 0){
+            break;
+        }
+        lenght -= n;
+    }
+}
+
+/**
+ * @brief Move a complete line from the UART driver to the line ring
+ * 
+ * The line is read with a single uart_read_bytes() into contiguous space of the
+ * line ring, if there is no room before the end of the ring the remaining bytes
+ * are skipped as padding. Nothing is published if the read fails.
+ * 
+ * @return true Line stored
+ */
+static bool UartStoreLine(uart_mcu_port_t port, uart_port_t uart_num, uint32_t size){
+    uart_line_t *rx = &uart_line[port];
+    uart_line_item_t item;
+    void *space;
+    uint32_t padding = 0;
+    if(size > UART_LINE_MAX){
+        UartDiscard(uart_num, size);
+        uart_rx_stats[port].long_lines++;
+        return false;
+    }
+    uint32_t contiguous = RingBufferReserve(&rx->ring, &space);
+    if(contiguous < size){
+        padding = contiguous;
+    }
+    if((RingBufferFree(&rx->ring) < padding + size) || (uxQueueSpacesAvailable(rx->lines) == 0)){
+        UartDiscard(uart_num, size);
+        uart_rx_stats[port].dropped_lines++;
+        return false;
+    }
+    if(padding){
+        // the line starts at the beginning of the ring, padding is published with it
+        space = rx->ring.buffer;
+    }
+    int n = uart_read_bytes(uart_num, space, size, 0);
+    if(n <= 0){
+        // nothing was published, the reservation is simply dropped
+        uart_rx_stats[port].read_errors++;
+        return false;
+    }
+    item.data = space;
+    item.size = padding + n;
+    item.lenght = n - 1;                    // delimiter
+    if((item.lenght > 0) && (item.data[item.lenght - 1] == '\r')){
+        item.lenght--;
+    }
+    item.data[item.lenght] = '\0';
+    RingBufferCommit(&rx->ring, item.size);
+    xQueueSend(rx->lines, &item, 0);
+    uart_rx_stats[port].lines++;
+    return true;
+}
+
+/**
+ * @brief Receive complete lines using the UART pattern detection
+ */
+static void uart_line_task(void *pvParameters){
+    uart_mcu_port_t port = (uart_mcu_port_t)pvParameters;
+    uart_line_t *rx = &uart_line[port];
+    uart_port_t uart_num = (port == UART_PC) ? UART_NUM_0 : UART_NUM_1;
+    uart_event_t event;
+    uart_driver_install(uart_num, RX_BUFFER_SIZE, TX_BUFFER_SIZE, EVENT_QUEUE_SIZE, &rx->events, 0);
+    uart_enable_pattern_det_baud_intr(uart_num, rx->delimiter, 1, 9, 0, 0);
+    uart_pattern_queue_reset(uart_num, UART_LINE_QUEUE_SIZE);
+    while(1){
+        if(xQueueReceive(rx->events, &event, portMAX_DELAY)){
+            switch(event.type){
+                case UART_PATTERN_DET:{
+                    int pos = uart_pattern_pop_pos(uart_num);
+                    if(pos < 0){
+                        // pattern queue overflow, line boundaries are lost
+                        uart_rx_stats[port].pattern_overflows++;
+                        uart_flush_input(uart_num);
+                        xQueueReset(rx->events);
+                    }else if(UartStoreLine(port, uart_num, pos + 1) && (rx->func_p != NULL)){
+                        rx->func_p(rx->param_p);
+                    }
+                    break;
+                }
+                case UART_BUFFER_FULL:
+                    uart_rx_stats[port].buffer_full++;
+                    uart_flush_input(uart_num);
+                    xQueueReset(rx->events);
+                    break;
+                case UART_FIFO_OVF:
+                    uart_rx_stats[port].fifo_overflows++;
+                    uart_flush_input(uart_num);
+                    xQueueReset(rx->events);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Create the line ring and receive task of a port
+ * 
+ * @return true Line mode started
+ */
+static bool UartLineInit(serial_config_t *port_config){
+    uart_line_t *rx = &uart_line[port_config->port];
+    uint32_t size = (port_config->line_ring_size == 0) ? UART_LINE_RING_SIZE : port_config->line_ring_size;
+    uint32_t lenght = 1;
+    if(rx->lines != NULL){
+        return true;
+    }
+    while(lenght < size){
+        lenght <<= 1;
+    }
+    uint8_t *storage = malloc(lenght);
+    if(storage == NULL){
+        ESP_LOGE("uart_mcu", "Not enough memory for a %lu bytes line ring", (unsigned long)lenght);
+        return false;
+    }
+    RingBufferInit(&rx->ring, storage, lenght, 1);
+    rx->delimiter = port_config->line_delimiter;
+    rx->func_p = port_config->func_p;
+    rx->param_p = port_config->param_p;
+    rx->lines = xQueueCreate(UART_LINE_QUEUE_SIZE, sizeof(uart_line_item_t));
+    xTaskCreate(uart_line_task, "uart_line_task", 2048, (void *)port_config->port, 12, NULL);
+    return true;
+}
+
+/**
+ * @brief Send the asynchronous transmissions of a port
+ * 
+ * The only task blocking on the UART driver TX buffer.
+ */
+static void uart_tx_task(void *pvParameters){
+    uart_mcu_port_t port = (uart_mcu_port_t)pvParameters;
+    uart_tx_t *tx = &uart_tx[port];
+    uart_port_t uart_num = (port == UART_PC) ? UART_NUM_0 : UART_NUM_1;
+    uart_tx_item_t item;
+    const void *chunk;
+    while(1){
+        if(xQueueReceive(tx->queue, &item, portMAX_DELAY)){
+            if(item.data == NULL){
+                // at most two chunks, the bytes are already in the ring
+                while(item.lenght > 0){
+                    uint32_t n = RingBufferPeek(&tx->ring, &chunk);
+                    if(n > item.lenght){
+                        n = item.lenght;
+                    }
+                    uart_write_bytes(uart_num, chunk, n);
+                    RingBufferConsume(&tx->ring, n);
+                    item.lenght -= n;
+                }
+            }else{
+                uart_write_bytes(uart_num, item.data, item.lenght);
+            }
+            if(item.func_p != NULL){
+                item.func_p(item.param_p);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Prepare the asynchronous transmission of a port
+ * 
+ * Only the mutex is created here (static storage), the TX ring and task are 
+ * created by UartTxStart() on the first asynchronous transmission, so ports 
+ * that only use the blocking functions do not use heap or a task.
+ * 
+ * @param port Port
+ * @param size TX ring size (bytes), rounded up to a power of two
+ */
+static void UartTxInit(uart_mcu_port_t port, uint32_t size){
+    uart_tx_t *tx = &uart_tx[port];
+    if(tx->mutex != NULL){
+        return;
+    }
+    tx->ring_size = 1;
+    while(tx->ring_size < ((size == 0) ? UART_TX_RING_SIZE : size)){
+        tx->ring_size <<= 1;
+    }
+    tx->mutex = xSemaphoreCreateMutexStatic(&tx->mutex_storage);
+}
+
+/**
+ * @brief Create the TX ring and task of a port, if not created yet (the mutex of the port must be taken)
+ * 
+ * @return true Asynchronous transmission available
+ */
+static bool UartTxStart(uart_mcu_port_t port){
+    uart_tx_t *tx = &uart_tx[port];
+    if(tx->queue != NULL){
+        return true;
+    }
+    uint8_t *storage = malloc(tx->ring_size);
+    if(storage == NULL){
+        ESP_LOGE("uart_mcu", "Not enough memory for a %lu bytes TX ring", (unsigned long)tx->ring_size);
+        return false;
+    }
+    RingBufferInit(&tx->ring, storage, tx->ring_size, 1);
+    tx->queue = xQueueCreate(UART_TX_QUEUE_SIZE, sizeof(uart_tx_item_t));
+    if(tx->queue == NULL){
+        free(storage);
+        return false;
+    }
+    if(xTaskCreate(uart_tx_task, "uart_tx_task", TX_TASK_STACK, (void *)port, TX_TASK_PRIORITY, NULL) != pdPASS){
+        ESP_LOGE("uart_mcu", "Not enough memory for the TX task");
+        vQueueDelete(tx->queue);
+        tx->queue = NULL;
+        free(storage);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Queue a transmission (the mutex of the port must be taken)
+ */
+static void UartTxQueue(uart_tx_t *tx, const void *data, uint32_t lenght, void *func_p, void *param_p){
+    uart_tx_item_t item = {
+        .data = data,
+        .lenght = lenght,
+        .func_p = func_p,
+        .param_p = param_p,
+    };
+    xQueueSend(tx->queue, &item, 0);
+}
 /*==================[external functions definition]==========================*/
 
 void UartInit(serial_config_t *port_config){
@@ -117,7 +506,9 @@ void UartInit(serial_config_t *port_config){
         case UART_PC:
             uart_param_config(UART_NUM_0, &uart_config);
             uart_set_pin(UART_NUM_0, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
-            if(port_config->func_p != UART_NO_INT){
+            if(port_config->line_delimiter != 0){
+                UartLineInit(port_config);
+            }else if(port_config->func_p != UART_NO_INT){
                 uart_pc_isr_p = port_config->func_p;
                 uart_pc_queue = port_config->param_p;
                 xTaskCreate(uart_pc_event_task, "uart_pc_event_task", 2048, NULL, 12, 0);
@@ -128,7 +519,9 @@ void UartInit(serial_config_t *port_config){
         case UART_CONNECTOR:
             uart_param_config(UART_NUM_1, &uart_config);
             uart_set_pin(UART_NUM_1, UART_CONN_TX, UART_CONN_RX, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
-            if(port_config->func_p != UART_NO_INT){
+            if(port_config->line_delimiter != 0){
+                UartLineInit(port_config);
+            }else if(port_config->func_p != UART_NO_INT){
                 uart_conn_isr_p = port_config->func_p;
                 uart_conn_queue = port_config->param_p;
                 xTaskCreate(uart_conn_event_task, "uart_conn_event_task", 2048, NULL, 12, NULL);
@@ -137,6 +530,7 @@ void UartInit(serial_config_t *port_config){
             }
             break;
     }
+    UartTxInit(port_config->port, port_config->tx_ring_size);
 }
 
 uint8_t UartReadByte(uart_mcu_port_t port, uint8_t* data){
@@ -187,7 +581,7 @@ void UartSendByte(uart_mcu_port_t port, const char *data){
                 uart_num = UART_NUM_1;
             break;
     }
-    uart_tx_chars(uart_num, data, 1);
+    uart_write_bytes(uart_num, data, 1);
 }
 
 void UartSendString(uart_mcu_port_t port, const char *msg){
@@ -200,13 +594,10 @@ void UartSendString(uart_mcu_port_t port, const char *msg){
                 uart_num = UART_NUM_1;
             break;
     }
-	while(*msg != 0){
-        uart_tx_chars(uart_num, msg, 1);
-		msg++;
-	}
+    uart_write_bytes(uart_num, msg, strlen(msg));
 }
 
-void UartSendBuffer(uart_mcu_port_t port, const char *data, uint8_t nbytes){
+void UartSendBuffer(uart_mcu_port_t port, const char *data, uint16_t nbytes){
     uart_port_t uart_num = UART_NUM_0;
     switch(port){
         case UART_PC:
@@ -216,19 +607,170 @@ void UartSendBuffer(uart_mcu_port_t port, const char *data, uint8_t nbytes){
                 uart_num = UART_NUM_1;
             break;
     }
-    uart_tx_chars(uart_num, data, nbytes);
+    uart_write_bytes(uart_num, data, nbytes);
 }
 
-uint8_t* UartItoa(uint32_t val, uint8_t base){
-	static uint8_t buf[32] = {0};
-	uint32_t i = 30;
-    if(val == 0){
-        return (uint8_t*)"0";
-    }else{
-        for(; val && i ; --i, val /= base){
-            buf[i] = "0123456789abcdef"[val % base];
+bool UartSendAsync(uart_mcu_port_t port, const void *data, uint32_t lenght, void *func_p, void *param_p){
+    uart_tx_t *tx = &uart_tx[port];
+    bool queued = false;
+    if((tx->mutex == NULL) || (lenght == 0)){
+        return false;
+    }
+    xSemaphoreTake(tx->mutex, portMAX_DELAY);
+    if(UartTxStart(port) && (RingBufferFree(&tx->ring) >= lenght) && (uxQueueSpacesAvailable(tx->queue) > 0)){
+        RingBufferWrite(&tx->ring, data, lenght);
+        UartTxQueue(tx, NULL, lenght, func_p, param_p);
+        queued = true;
+    }
+    xSemaphoreGive(tx->mutex);
+    return queued;
+}
+
+bool UartSendBufferAsync(uart_mcu_port_t port, const void *data, uint32_t lenght, void *func_p, void *param_p){
+    uart_tx_t *tx = &uart_tx[port];
+    bool queued = false;
+    if((tx->mutex == NULL) || (lenght == 0)){
+        return false;
+    }
+    xSemaphoreTake(tx->mutex, portMAX_DELAY);
+    if(UartTxStart(port) && (uxQueueSpacesAvailable(tx->queue) > 0)){
+        UartTxQueue(tx, data, lenght, func_p, param_p);
+        queued = true;
+    }
+    xSemaphoreGive(tx->mutex);
+    return queued;
+}
+
+uint16_t UartPrintf(uart_mcu_port_t port, const char *format, ...){
+    uart_tx_t *tx = &uart_tx[port];
+    va_list args;
+    void *space;
+    int lenght = 0;
+    if(tx->mutex == NULL){
+        return 0;
+    }
+    xSemaphoreTake(tx->mutex, portMAX_DELAY);
+    if(UartTxStart(port) && (uxQueueSpacesAvailable(tx->queue) > 0)){
+        uint32_t contiguous = RingBufferReserve(&tx->ring, &space);
+        va_start(args, format);
+        lenght = vsnprintf(space, contiguous, format, args);
+        va_end(args);
+        if((lenght > 0) && ((uint32_t)lenght < contiguous)){
+            RingBufferCommit(&tx->ring, lenght);
+        }else if((lenght > 0) && (lenght < UART_PRINTF_MAX) && ((uint32_t)lenght <= RingBufferFree(&tx->ring))){
+            // the message wraps around the end of the ring
+            char msg[UART_PRINTF_MAX];
+            va_start(args, format);
+            vsnprintf(msg, sizeof(msg), format, args);
+            va_end(args);
+            RingBufferWrite(&tx->ring, msg, lenght);
+        }else{
+            lenght = 0;
+        }
+        if(lenght > 0){
+            UartTxQueue(tx, NULL, lenght, NULL, NULL);
         }
-        return &buf[i+1];
+    }
+    xSemaphoreGive(tx->mutex);
+    return lenght;
+}
+
+uint32_t UartTxFree(uart_mcu_port_t port){
+    if(uart_tx[port].queue == NULL){
+        // not started yet, the whole ring will be free
+        return uart_tx[port].ring_size;
+    }
+    return RingBufferFree(&uart_tx[port].ring);
+}
+
+bool UartReadLine(uart_mcu_port_t port, const char **line, uint16_t *lenght, uint32_t timeout_ms){
+    uart_line_item_t item;
+    if(uart_line[port].lines == NULL){
+        return false;
+    }
+    if(xQueuePeek(uart_line[port].lines, &item, pdMS_TO_TICKS(timeout_ms)) != pdTRUE){
+        return false;
+    }
+    *line = item.data;
+    *lenght = item.lenght;
+    return true;
+}
+
+void UartReleaseLine(uart_mcu_port_t port){
+    uart_line_item_t item;
+    if((uart_line[port].lines != NULL) && xQueueReceive(uart_line[port].lines, &item, 0)){
+        RingBufferConsume(&uart_line[port].ring, item.size);
+    }
+}
+
+void UartRxStats(uart_mcu_port_t port, uart_rx_stats_t *stats){
+    *stats = uart_rx_stats[port];
+}
+
+uint8_t* UartItoa(uint32_t val, uint8_t base){
+	static char buf[FORMAT_BASE_SIZE];
+    FormatUintBase(buf, val, base);
+    return (uint8_t*)buf;
+}
+
+void UartStreamInit(uart_stream_t *stream, uart_mcu_port_t port, uart_stream_format_t format){
+    stream->port = port;
+    stream->format = format;
+    stream->sequence = 0;
+}
+
+uint16_t UartStreamEncode(uart_stream_t *stream, const uint16_t *samples, uint16_t lenght, uint8_t *frame){
+    uint8_t *payload = &frame[UART_STREAM_HEADER];
+    uint16_t payload_lenght = 0;
+    if((lenght == 0) || (lenght > UART_STREAM_MAX_SAMPLES)){
+        return 0;
+    }
+    switch(stream->format){
+        case UART_STREAM_RAW16:
+            for(uint16_t i=0; i<lenght; i++){
+                payload[2*i] = samples[i];
+                payload[2*i+1] = samples[i] >> 8;
+            }
+            payload_lenght = 2 * lenght;
+            break;
+        case UART_STREAM_PACKED12:
+            payload_lenght = EncodePacked12(samples, lenght, payload);
+            break;
+        case UART_STREAM_DELTA:
+            payload_lenght = EncodeDelta(samples, lenght, payload);
+            break;
+    }
+    frame[0] = UART_STREAM_SYNC_0;
+    frame[1] = UART_STREAM_SYNC_1;
+    frame[2] = stream->sequence++;
+    frame[3] = stream->format;
+    frame[4] = lenght;
+    frame[5] = lenght >> 8;
+    frame[6] = payload_lenght;
+    frame[7] = payload_lenght >> 8;
+    uint16_t crc = Crc16(&frame[2], UART_STREAM_HEADER - 2 + payload_lenght);
+    payload[payload_lenght] = crc;
+    payload[payload_lenght + 1] = crc >> 8;
+    return UART_STREAM_HEADER + payload_lenght + 2;
+}
+
+void UartStreamSend(uart_stream_t *stream, const uint16_t *samples, uint32_t lenght){
+    uart_port_t uart_num = UART_NUM_0;
+    uint8_t *frame = uart_stream_frame[stream->port];
+    switch(stream->port){
+        case UART_PC:
+                uart_num = UART_NUM_0;
+            break;
+        case UART_CONNECTOR:
+                uart_num = UART_NUM_1;
+            break;
+    }
+    while(lenght > 0){
+        uint16_t n = (lenght > UART_STREAM_MAX_SAMPLES) ? UART_STREAM_MAX_SAMPLES : lenght;
+        uint16_t frame_lenght = UartStreamEncode(stream, samples, n, frame);
+        uart_write_bytes(uart_num, frame, frame_lenght);
+        samples += n;
+        lenght -= n;
     }
 }
 
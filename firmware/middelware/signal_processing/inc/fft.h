@@ -16,6 +16,10 @@
  * |   Date	    | Description                                    						|
  * |:----------:|:----------------------------------------------------------------------|
  * | 15/03/2024 | Document creation		                         						|
+ * | 16/10/2026 | FFT plans with cached windows and overlapping frames					|
+ * | 16/10/2026 | Real input FFT (FFTMagnitudeReal)										|
+ * | 16/10/2026 | Fixed-point Q15 FFT (FFTMagnitudeQ15)									|
+ * | 16/10/2026 | Window generation available to other modules (FFTWindow)				|
  * 
  **/
 
@@ -24,7 +28,37 @@
 #include <stdbool.h>
 /*==================[macros]=================================================*/
 #define MAX_SIGNAL_LENGHT   2048
+#define FFT_WINDOW_CACHE    4       /*!< Number of different windows (lenght/type) kept in memory */
 /*==================[typedef]================================================*/
+/**
+ * @brief Window functions available for FFT plans
+ */
+typedef enum fft_window {
+    FFT_WINDOW_RECT = 0,            /*!< Rectangular window (no windowing) */
+    FFT_WINDOW_HANN,                /*!< Hann window */
+    FFT_WINDOW_BLACKMAN,            /*!< Blackman window */
+    FFT_WINDOW_BLACKMAN_HARRIS,     /*!< Blackman-Harris window */
+    FFT_WINDOW_BLACKMAN_NUTTALL,    /*!< Blackman-Nuttall window */
+    FFT_WINDOW_NUTTALL,             /*!< Nuttall window */
+    FFT_WINDOW_FLAT_TOP             /*!< Flat-Top window */
+} fft_window_t;
+
+/**
+ * @brief FFT plan: precomputed window and ring buffer for continuous spectra
+ * 
+ * @note Fields are managed by FFTPlanCreate() and should not be modified by the user.
+ */
+typedef struct {
+    uint16_t lenght;        /*!< Frame lenght (power of two, up to MAX_SIGNAL_LENGHT) */
+    uint16_t hop;           /*!< Number of new samples between consecutive spectra */
+    fft_window_t window;    /*!< Window type */
+    const float *wind;      /*!< Cached window values (shared between plans) */
+    float *ring;            /*!< Ring buffer with the last lenght samples */
+    float *work;            /*!< Work buffer (lenght / 2 complex values) */
+    uint16_t write_idx;     /*!< Ring buffer write position */
+    uint16_t count;         /*!< Samples received since last spectrum */
+    bool primed;            /*!< Ring buffer filled at least once */
+} fft_plan_t;
 
 /*==================[external data declaration]==============================*/
 
@@ -37,9 +71,19 @@
  */
 bool FFTInit(void);
 
+/**
+ * @brief Initialize the fixed-point (Q15) FFT calculation module
+ * 
+ * @return true     FFT initialized
+ * @return false    Not possible to initialize FFT
+ */
+bool FFTInitQ15(void);
+
 /**
  * @brief Calculates the Fast Fourier Transform of a given signal
  * 
+ * Runs the real input path (FFTMagnitudeReal()).
+ * 
  * @note  Lenght of signal array must be a power of two (with maximun value = MAX_SIGNAL_LENGHT)
  * 
  * @param signal            Array with signal values (of lenght = signal_lenght)
@@ -48,6 +92,37 @@ bool FFTInit(void);
  */
 void FFTMagnitude(float * signal, float * fft, uint16_t signal_lenght);
 
+/**
+ * @brief Calculates the Fast Fourier Transform of a given real signal
+ * 
+ * The signal is packed as signal_lenght / 2 complex values and transformed with a half 
+ * size FFT, so it takes about half the time and half the work memory of a complex FFT 
+ * with zero imaginary part (same bins).
+ * 
+ * @note  Lenght of signal array must be a power of two (with minimun value = 4 and maximun value = MAX_SIGNAL_LENGHT)
+ * 
+ * @param signal            Array with signal values (of lenght = signal_lenght)
+ * @param fft               Array to store FFT magnitude values (of lenght = signal_lenght / 2)
+ * @param signal_lenght     Lenght of signal arrays
+ */
+void FFTMagnitudeReal(float * signal, float * fft, uint16_t signal_lenght);
+
+/**
+ * @brief Calculates the Fast Fourier Transform of a given integer signal (e.g. ADC samples)
+ * 
+ * Fixed-point version of FFTMagnitude(): the signal is scaled to use the full Q15 range 
+ * (block floating point), windowed with an integer Hann table and transformed with the 
+ * 16 bit FFT kernel. Magnitude is approximated as alpha * max + beta * min (error < 4%).
+ * 
+ * @note  Lenght of signal array must be a power of two (with maximun value = MAX_SIGNAL_LENGHT).
+ * Output uses the same scale as FFTMagnitude() (in input units) and saturates at UINT16_MAX.
+ * 
+ * @param signal            Array with signal values (of lenght = signal_lenght)
+ * @param fft               Array to store FFT magnitude values (of lenght = signal_lenght / 2)
+ * @param signal_lenght     Lenght of signal arrays
+ */
+void FFTMagnitudeQ15(const int16_t * signal, uint16_t * fft, uint16_t signal_lenght);
+
 /**
  * @brief Return the FFT frequency axis vector
  * 
@@ -57,6 +132,90 @@ void FFTMagnitude(float * signal, float * fft, uint16_t signal_lenght);
  */
 void FFTFrequency(float sample_freq, uint16_t signal_lenght, float * f);
 
+/**
+ * @brief Generate the values of a window function
+ * 
+ * @param w                 Array to store window values (of lenght = lenght)
+ * @param lenght            Window lenght
+ * @param type              Window type
+ */
+void FFTWindow(float * w, uint16_t lenght, fft_window_t type);
+
+/**
+ * @brief Create an FFT plan for continuous spectra over overlapping frames
+ * 
+ * The window is computed once and cached, so plans with the same lenght and 
+ * window type share it. A new spectrum is available every hop samples 
+ * (e.g. hop = signal_lenght / 4 for 75% overlap).
+ * 
+ * @note FFTInit() must be called before executing any plan.
+ * 
+ * @param plan              Plan to initialize
+ * @param signal_lenght     Frame lenght (power of two, from 4 up to MAX_SIGNAL_LENGHT)
+ * @param window            Window type
+ * @param hop               Samples between consecutive spectra (1 to signal_lenght)
+ * @return true             Plan created
+ * @return false            Invalid parameters or not enough memory
+ */
+bool FFTPlanCreate(fft_plan_t * plan, uint16_t signal_lenght, fft_window_t window, uint16_t hop);
+
+/**
+ * @brief Release the memory used by an FFT plan
+ * 
+ * @param plan              Plan to delete
+ */
+void FFTPlanDelete(fft_plan_t * plan);
+
+/**
+ * @brief Push new samples into the plan ring buffer
+ * 
+ * Samples are consumed until a new frame is ready, so the caller must execute 
+ * the plan and push the remaining samples:
+ * @code
+ * while(n){
+ *     uint16_t used = FFTPlanPush(&plan, samples, n);
+ *     samples += used;
+ *     n -= used;
+ *     if(FFTPlanReady(&plan)){
+ *         FFTPlanExecute(&plan, fft);
+ *     }
+ * }
+ * @endcode
+ * 
+ * @param plan              FFT plan
+ * @param samples           Array with new signal values
+ * @param n                 Number of samples in array
+ * @return uint16_t         Number of samples consumed
+ */
+uint16_t FFTPlanPush(fft_plan_t * plan, const float * samples, uint16_t n);
+
+/**
+ * @brief Check if a new frame is ready to be transformed
+ * 
+ * @param plan              FFT plan
+ * @return true             A new spectrum can be calculated
+ * @return false            More samples are needed
+ */
+bool FFTPlanReady(const fft_plan_t * plan);
+
+/**
+ * @brief Calculate the FFT magnitude of the last frame stored in the plan
+ * 
+ * @param plan              FFT plan
+ * @param fft               Array to store FFT magnitude values (of lenght = signal_lenght / 2)
+ */
+void FFTPlanExecute(fft_plan_t * plan, float * fft);
+
+/**
+ * @brief Calculate the raw power spectrum |X[k]|^2 of the last frame stored in the plan
+ * 
+ * @note No scaling is applied (see psd.h for normalized power spectral density).
+ * 
+ * @param plan              FFT plan
+ * @param power             Array to store power values (of lenght = signal_lenght / 2)
+ */
+void FFTPlanExecutePower(fft_plan_t * plan, float * power);
+
 /** @} doxygen end group definition */
 /** @} doxygen end group definition */
 /** @} doxygen end group definition */
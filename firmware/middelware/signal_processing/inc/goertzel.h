@@ -0,0 +1,148 @@
+#ifndef GOERTZEL_H_
+#define GOERTZEL_H_
+/** \addtogroup Drivers_Programable Drivers Programable
+ ** @{ */
+/** \addtogroup Middelware Middelware
+ ** @{ */
+/** \addtogroup Goertzel Goertzel and Sliding DFT
+ */
+
+/** \brief Tracking of a few frequency bins without calculating a full FFT
+ * 
+ * Both methods are updated sample by sample with a cost proportional to the number 
+ * of bins, so they can be called from a timer driven task:
+ * - Goertzel bank: returns the bin magnitudes at the end of every block of N samples.
+ * - Sliding DFT: returns the bin magnitudes of the last N samples after every sample.
+ * 
+ * Requested frequencies are rounded to the nearest bin k, whose frequency is 
+ * k * sample_freq / N (same axis as FFTFrequency()). Magnitudes are the amplitude 
+ * of the sinusoid at each bin (2 * |X[k]| / N, |X[0]| / N for DC) without windowing.
+ * 
+ * @author Valentina de la Rosa
+ *
+ * @section changelog
+ *
+ * |   Date	    | Description                                    						|
+ * |:----------:|:----------------------------------------------------------------------|
+ * | 16/10/2026 | Document creation		                         						|
+ * 
+ **/
+
+/*==================[inclusions]=============================================*/
+#include <stdint.h>
+#include <stdbool.h>
+/*==================[macros]=================================================*/
+#define GOERTZEL_MAX_BINS   8       /*!< Maximum number of bins tracked by each bank */
+/*==================[typedef]================================================*/
+/**
+ * @brief Goertzel filter bank
+ * 
+ * @note Fields are managed by GoertzelInit() and should not be modified by the user.
+ */
+typedef struct {
+    uint16_t lenght;                        /*!< Block lenght (N) */
+    uint16_t count;                         /*!< Samples received in current block */
+    uint8_t n_bins;                         /*!< Number of bins */
+    uint16_t bin[GOERTZEL_MAX_BINS];        /*!< Bin index (k) */
+    float coeff[GOERTZEL_MAX_BINS];         /*!< 2 * cos(2 * pi * k / N) */
+    float s1[GOERTZEL_MAX_BINS];            /*!< Filter state s[n - 1] */
+    float s2[GOERTZEL_MAX_BINS];            /*!< Filter state s[n - 2] */
+    float mag[GOERTZEL_MAX_BINS];           /*!< Magnitudes of the last complete block */
+} goertzel_t;
+
+/**
+ * @brief Sliding DFT
+ * 
+ * @note Fields are managed by SlidingDFTInit() and should not be modified by the user.
+ */
+typedef struct {
+    uint16_t lenght;                        /*!< Window lenght (N) */
+    uint16_t idx;                           /*!< Delay line position of the oldest sample */
+    float *delay;                           /*!< Delay line with the last N samples (user provided) */
+    float damp_n;                           /*!< SDFT_DAMPING ^ N */
+    uint8_t n_bins;                         /*!< Number of bins */
+    uint16_t bin[GOERTZEL_MAX_BINS];        /*!< Bin index (k) */
+    float w_re[GOERTZEL_MAX_BINS];          /*!< SDFT_DAMPING * cos(2 * pi * k / N) */
+    float w_im[GOERTZEL_MAX_BINS];          /*!< SDFT_DAMPING * sin(2 * pi * k / N) */
+    float re[GOERTZEL_MAX_BINS];            /*!< Bin value (real part) */
+    float im[GOERTZEL_MAX_BINS];            /*!< Bin value (imaginary part) */
+} sdft_t;
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+/**
+ * @brief Initialize a Goertzel filter bank
+ * 
+ * @param bank              Filter bank to initialize
+ * @param sample_freq       Sample frequency
+ * @param block_lenght      Number of samples per block (N)
+ * @param freqs             Array with the frequencies to track (of lenght = n_bins)
+ * @param n_bins            Number of frequencies (up to GOERTZEL_MAX_BINS)
+ * @return true             Bank initialized
+ * @return false            Invalid parameters
+ */
+bool GoertzelInit(goertzel_t * bank, float sample_freq, uint16_t block_lenght, const float * freqs, uint8_t n_bins);
+
+/**
+ * @brief Process a new sample
+ * 
+ * @param bank              Filter bank
+ * @param sample            New signal value
+ * @return true             A block was completed and new magnitudes are available
+ * @return false            Block not completed yet
+ */
+bool GoertzelUpdate(goertzel_t * bank, float sample);
+
+/**
+ * @brief Get the magnitudes of the last complete block
+ * 
+ * @param bank              Filter bank
+ * @param mag               Array to store magnitudes (of lenght = n_bins)
+ */
+void GoertzelMagnitude(const goertzel_t * bank, float * mag);
+
+/**
+ * @brief Get the frequency of each bin (after rounding to the nearest bin)
+ * 
+ * @param bank              Filter bank
+ * @param sample_freq       Sample frequency
+ * @param f                 Array to store frequencies (of lenght = n_bins)
+ */
+void GoertzelFrequency(const goertzel_t * bank, float sample_freq, float * f);
+
+/**
+ * @brief Initialize a sliding DFT
+ * 
+ * @param sdft              Sliding DFT to initialize
+ * @param sample_freq       Sample frequency
+ * @param lenght            Window lenght (N)
+ * @param freqs             Array with the frequencies to track (of lenght = n_bins)
+ * @param n_bins            Number of frequencies (up to GOERTZEL_MAX_BINS)
+ * @param delay_buffer      Array used to store the last samples (of lenght = lenght)
+ * @return true             Sliding DFT initialized
+ * @return false            Invalid parameters
+ */
+bool SlidingDFTInit(sdft_t * sdft, float sample_freq, uint16_t lenght, const float * freqs, uint8_t n_bins, float * delay_buffer);
+
+/**
+ * @brief Process a new sample
+ * 
+ * @param sdft              Sliding DFT
+ * @param sample            New signal value
+ */
+void SlidingDFTUpdate(sdft_t * sdft, float sample);
+
+/**
+ * @brief Get the magnitudes of the last N samples
+ * 
+ * @param sdft              Sliding DFT
+ * @param mag               Array to store magnitudes (of lenght = n_bins)
+ */
+void SlidingDFTMagnitude(const sdft_t * sdft, float * mag);
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+#endif /* GOERTZEL_H_ */
+
+/*==================[end of file]============================================*/
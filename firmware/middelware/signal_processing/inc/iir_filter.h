@@ -16,13 +16,20 @@
  * |   Date	    | Description                                    						|
  * |:----------:|:----------------------------------------------------------------------|
  * | 15/03/2024 | Document creation		                         						|
+ * | 16/10/2026 | Handle based API (multiple independent filters)						|
+ * | 16/10/2026 | Single pass cascade kernel and band pass (HP + LP) filtering			|
+ * | 16/10/2026 | Per sample filtering (IIRStep)										|
+ * | 16/10/2026 | Zero-phase filtering (IIRFiltFilt)									|
  * 
  **/
 
 /*==================[inclusions]=============================================*/
 #include <stdint.h>
+#include <stdbool.h>
 /*==================[macros]=================================================*/
-
+#define IIR_MAX_ORDER       16      /*!< Maximum order for Butterworth low/hi pass designs */
+#define IIR_MAX_SECTIONS    (IIR_MAX_ORDER / 2)    /*!< Maximum second order sections per filter */
+#define IIR_POOL_SECTIONS   32      /*!< Second order sections available in the internal pool */
 /*==================[typedef]================================================*/
 typedef enum filter_order {
     ORDER_2 = 2,        /*!< 2nd order filter */
@@ -30,6 +37,50 @@ typedef enum filter_order {
     ORDER_6 = 6,        /*!< 6th order filter */
     ORDER_8 = 8         /*!< 8th order filter */
 } filter_order_t;
+
+/**
+ * @brief Filter designs available for IIRCreate()
+ */
+typedef enum iir_type {
+    IIR_LOW_PASS = 0,   /*!< Butterworth low pass (order: 2 to IIR_MAX_ORDER, even) */
+    IIR_HI_PASS,        /*!< Butterworth hi pass (order: 2 to IIR_MAX_ORDER, even) */
+    IIR_BAND_PASS,      /*!< 2nd order band pass, 0dB gain at center frequency (uses q) */
+    IIR_NOTCH,          /*!< 2nd order notch (uses q and gain) */
+    IIR_LOW_SHELF,      /*!< 2nd order low shelving (uses q and gain) */
+    IIR_HI_SHELF        /*!< 2nd order hi shelving (uses q and gain) */
+} iir_type_t;
+
+/**
+ * @brief Filter design parameters
+ */
+typedef struct {
+    iir_type_t type;    /*!< Filter type */
+    float sample_frec;  /*!< Signal's sample frequency */
+    float cut_frec;     /*!< Cut-off (low/hi pass) or center frequency */
+    uint8_t order;      /*!< Filter order (only for low/hi pass) */
+    float q;            /*!< Q factor (band pass, notch and shelving) */
+    float gain;         /*!< Gain in dB (notch stopband, shelving) */
+} iir_design_t;
+
+/**
+ * @brief Second order section (biquad): coefficients and state
+ */
+typedef struct {
+    float coeffs[5];    /*!< b0, b1, b2, a1, a2 (a0 = 1) */
+    float delay[2];     /*!< Section state (transposed direct form II) */
+} iir_sos_t;
+
+/**
+ * @brief IIR filter (cascade of second order sections)
+ * 
+ * @note Each filter keeps its own state, so different filters can be used at the same 
+ * time from different tasks. The same filter must not be used by two tasks at once.
+ */
+typedef struct {
+    iir_sos_t *sos;     /*!< Array of sections */
+    uint8_t n_sos;      /*!< Number of sections */
+    bool pooled;        /*!< Sections taken from the internal pool */
+} iir_filter_t;
 /*==================[external data declaration]==============================*/
 
 /*==================[external functions declaration]=========================*/
@@ -69,6 +120,126 @@ void LowPassFilter(float * input_signal, float * output_signal, int16_t signal_l
  */
 void HiPassFilter(float * input_signal, float * output_signal, int16_t signal_lenght);
 
+/**
+ * @brief Apply the hi pass and the low pass filters to a signal array in a single pass
+ * 
+ * @note Both filters must be initialized (HiPassInit() and LowPassInit()).
+ * 
+ * @param input_signal      Input signal array
+ * @param output_signal     Filtered signal array
+ * @param signal_lenght     Number of samples of both signals
+ */
+void BandPassFilter(float * input_signal, float * output_signal, int16_t signal_lenght);
+
+/**
+ * @brief Number of second order sections needed by a filter design
+ * 
+ * @param design        Filter design
+ * @return uint8_t      Number of sections (0 if design is not valid)
+ */
+uint8_t IIRSections(const iir_design_t * design);
+
+/**
+ * @brief Create a filter from a design
+ * 
+ * @param filter        Filter to create
+ * @param design        Filter design
+ * @param storage       Array of IIRSections(design) sections, or NULL to take them from the internal pool
+ * @return true         Filter created
+ * @return false        Invalid design or pool exhausted
+ */
+bool IIRCreate(iir_filter_t * filter, const iir_design_t * design, iir_sos_t * storage);
+
+/**
+ * @brief Create a filter from second order section coefficients
+ * 
+ * @param filter        Filter to create
+ * @param coeffs        Coefficients of each section (b0, b1, b2, a1, a2)
+ * @param n_sos         Number of sections (1 to IIR_MAX_SECTIONS)
+ * @param storage       Array of n_sos sections, or NULL to take them from the internal pool
+ * @return true         Filter created
+ * @return false        Invalid number of sections or pool exhausted
+ */
+bool IIRCreateFromSOS(iir_filter_t * filter, const float (*coeffs)[5], uint8_t n_sos, iir_sos_t * storage);
+
+/**
+ * @brief Delete a filter (sections taken from the pool are released)
+ * 
+ * @param filter        Filter to delete
+ */
+void IIRDelete(iir_filter_t * filter);
+
+/**
+ * @brief Apply a filter to a signal array
+ * 
+ * Each sample goes through all the sections before the next one is read.
+ * 
+ * @note Input and output can be the same array.
+ * 
+ * @param filter            Filter
+ * @param input_signal      Input signal array
+ * @param output_signal     Filtered signal array
+ * @param signal_lenght     Number of samples of both signals
+ */
+void IIRProcess(iir_filter_t * filter, const float * input_signal, float * output_signal, uint16_t signal_lenght);
+
+/**
+ * @brief Apply two filters in series to a signal array in a single pass (e.g. hi pass + low pass)
+ * 
+ * @note Input and output can be the same array.
+ * 
+ * @param first             Filter applied first
+ * @param second            Filter applied to the output of the first one
+ * @param input_signal      Input signal array
+ * @param output_signal     Filtered signal array
+ * @param signal_lenght     Number of samples of both signals
+ */
+void IIRProcessSeries(iir_filter_t * first, iir_filter_t * second, const float * input_signal, float * output_signal, uint16_t signal_lenght);
+
+/**
+ * @brief Apply a filter forward and backward to a recorded signal (zero-phase filtering)
+ * 
+ * Equivalent to filtfilt: the signal is extended at both ends with an odd reflection 
+ * of 3 * (2 * sections + 1) samples and each pass starts from the steady state for its 
+ * first value, so there is no phase distortion and edge transients are minimized. 
+ * The magnitude response is squared. Works in place, extra memory is a few samples 
+ * on the stack. The filter state used by IIRProcess()/IIRStep() is not modified.
+ * 
+ * @param filter            Filter
+ * @param signal            Signal array (replaced by filtered signal)
+ * @param signal_lenght     Number of samples of signal
+ */
+void IIRFiltFilt(const iir_filter_t * filter, float * signal, uint16_t signal_lenght);
+
+/**
+ * @brief Filter a single sample
+ * 
+ * Intended for timer driven acquisition (one sample per notification). Cost only 
+ * depends on the number of sections. It shares the filter state with IIRProcess(), 
+ * so both functions can be mixed on the same filter.
+ * 
+ * @param filter        Filter
+ * @param x             Input sample
+ * @return float        Filtered sample
+ */
+static inline float IIRStep(iir_filter_t * filter, float x){
+    iir_sos_t *sos = filter->sos;
+    for(uint8_t k=0; k<filter->n_sos; k++){
+        float y = sos[k].coeffs[0] * x + sos[k].delay[0];
+        sos[k].delay[0] = sos[k].coeffs[1] * x - sos[k].coeffs[3] * y + sos[k].delay[1];
+        sos[k].delay[1] = sos[k].coeffs[2] * x - sos[k].coeffs[4] * y;
+        x = y;
+    }
+    return x;
+}
+
+/**
+ * @brief Clear the filter state
+ * 
+ * @param filter        Filter
+ */
+void IIRReset(iir_filter_t * filter);
+
 /** @} doxygen end group definition */
 /** @} doxygen end group definition */
 /** @} doxygen end group definition */
@@ -0,0 +1,133 @@
+#ifndef PSD_H_
+#define PSD_H_
+/** \addtogroup Drivers_Programable Drivers Programable
+ ** @{ */
+/** \addtogroup Middelware Middelware
+ ** @{ */
+/** \addtogroup PSD Power Spectral Density
+ */
+
+/** \brief Averaged power spectral density estimation (Welch method)
+ * 
+ * Samples are pushed in blocks of any size, split into overlapping windowed segments 
+ * and the power spectrum of each segment is averaged, so the full record is never 
+ * stored in memory. Windows and twiddles are shared with the FFT module.
+ * 
+ * @note FFTInit() must be called before using this module.
+ * 
+ * @author Valentina de la Rosa
+ *
+ * @section changelog
+ *
+ * |   Date	    | Description                                    						|
+ * |:----------:|:----------------------------------------------------------------------|
+ * | 16/10/2026 | Document creation		                         						|
+ * 
+ **/
+
+/*==================[inclusions]=============================================*/
+#include <stdint.h>
+#include <stdbool.h>
+#include "fft.h"
+/*==================[macros]=================================================*/
+
+/*==================[typedef]================================================*/
+/**
+ * @brief Averaging methods
+ */
+typedef enum psd_average {
+    PSD_AVERAGE_LINEAR = 0,         /*!< Mean of all segments since last reset */
+    PSD_AVERAGE_EXPONENTIAL         /*!< Exponential moving average (weight of new segment = alpha) */
+} psd_average_t;
+
+/**
+ * @brief Output units
+ */
+typedef enum psd_scale {
+    PSD_SCALE_LINEAR = 0,           /*!< Power spectral density (units^2 / Hz) */
+    PSD_SCALE_DB                    /*!< Power spectral density in dB (10 * log10) */
+} psd_scale_t;
+
+/**
+ * @brief PSD estimator configuration
+ */
+typedef struct {
+    float sample_freq;              /*!< Signal sample frequency (Hz) */
+    uint16_t segment_lenght;        /*!< Segment lenght (power of two, from 4 up to MAX_SIGNAL_LENGHT) */
+    uint16_t overlap;               /*!< Samples shared by consecutive segments (less than segment_lenght) */
+    fft_window_t window;            /*!< Window applied to each segment */
+    psd_average_t average;          /*!< Averaging method */
+    float alpha;                    /*!< Weight of new segments for exponential averaging (0 to 1) */
+} psd_config_t;
+
+/**
+ * @brief PSD estimator
+ * 
+ * @note Fields are managed by PSDInit() and should not be modified by the user.
+ */
+typedef struct {
+    psd_config_t config;            /*!< Configuration */
+    fft_plan_t plan;                /*!< FFT plan used to split and transform segments */
+    float *acc;                     /*!< Accumulated power (segment_lenght / 2) */
+    float *power;                   /*!< Power of last segment (segment_lenght / 2) */
+    float norm;                     /*!< Normalization factor: 1 / (sample_freq * sum(w^2)) */
+    uint32_t segments;              /*!< Segments averaged since last reset */
+} psd_t;
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+/**
+ * @brief Initialize a PSD estimator
+ * 
+ * @param psd               Estimator to initialize
+ * @param config            Estimator configuration
+ * @return true             Estimator initialized
+ * @return false            Invalid parameters or not enough memory
+ */
+bool PSDInit(psd_t * psd, const psd_config_t * config);
+
+/**
+ * @brief Release the memory used by a PSD estimator
+ * 
+ * @param psd               Estimator to release
+ */
+void PSDDeinit(psd_t * psd);
+
+/**
+ * @brief Push new samples into the estimator
+ * 
+ * Every time a segment is completed its power spectrum is added to the average.
+ * 
+ * @param psd               PSD estimator
+ * @param samples           Array with new signal values
+ * @param n                 Number of samples in array
+ * @return uint16_t         Number of segments completed with these samples
+ */
+uint16_t PSDPush(psd_t * psd, const float * samples, uint16_t n);
+
+/**
+ * @brief Get the current PSD estimation
+ * 
+ * One-sided PSD, the frequency axis can be obtained with 
+ * FFTFrequency(sample_freq, segment_lenght, f).
+ * 
+ * @param psd               PSD estimator
+ * @param out               Array to store PSD values (of lenght = segment_lenght / 2)
+ * @param scale             Output units (linear or dB)
+ * @return uint32_t         Number of segments averaged (0 if no estimation available yet)
+ */
+uint32_t PSDGet(const psd_t * psd, float * out, psd_scale_t scale);
+
+/**
+ * @brief Discard averaged segments (samples already pushed are kept)
+ * 
+ * @param psd               PSD estimator
+ */
+void PSDReset(psd_t * psd);
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+#endif /* PSD_H_ */
+
+/*==================[end of file]============================================*/
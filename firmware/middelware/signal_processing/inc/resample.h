@@ -0,0 +1,206 @@
+#ifndef RESAMPLE_H_
+#define RESAMPLE_H_
+/** \addtogroup Drivers_Programable Drivers Programable
+ ** @{ */
+/** \addtogroup Middelware Middelware
+ ** @{ */
+/** \addtogroup Resample Decimation and resampling
+ */
+
+/** \brief Sample rate conversion with windowed-sinc anti-alias filters
+ * 
+ * - Decimator: integer decimation by M (float or Q15), based on the esp-dsp
+ *   decimating FIR filters (dsps_fird_f32 / dsps_fird_s16).
+ * - Resampler: rational conversion by L/M with a polyphase FIR filter, only the
+ *   L / M needed output phases are calculated.
+ * 
+ * Filters are designed at initialization (windowed-sinc, cutoff at the lower of the
+ * input and output Nyquist frequencies, unity DC gain) using the FFT module windows.
+ * Both keep their state between calls, so a continuous signal can be processed in
+ * blocks of any size.
+ * 
+ * @author Valentina de la Rosa
+ * 
+ * @section changelog
+ * 
+ * |   Date	    | Description                                    						|
+ * |:----------:|:----------------------------------------------------------------------|
+ * | 16/10/2026 | Document creation		                         						|
+ * 
+ **/
+
+/*==================[inclusions]=============================================*/
+#include <stdint.h>
+#include <stdbool.h>
+#include "fft.h"
+#include "dsps_fir.h"
+/*==================[macros]=================================================*/
+#define RESAMPLE_MAX_FACTOR     16      /*!< Maximum decimation/interpolation factor */
+/*==================[typedef]================================================*/
+/**
+ * @brief Integer decimator (float)
+ * 
+ * @note Fields are managed by DecimatorInit() and should not be modified by the user.
+ */
+typedef struct {
+    fir_f32_t fir;                              /*!< esp-dsp decimating FIR filter */
+    float *coeffs;                              /*!< Filter coefficients */
+    float *delay;                               /*!< Filter delay line */
+    float pending[RESAMPLE_MAX_FACTOR];         /*!< Input samples not yet decimated */
+    uint8_t n_pending;                          /*!< Number of pending samples */
+} decimator_t;
+
+/**
+ * @brief Integer decimator (Q15)
+ * 
+ * @note Fields are managed by DecimatorInitQ15() and should not be modified by the user.
+ */
+typedef struct {
+    fir_s16_t fir;                              /*!< esp-dsp decimating FIR filter */
+    int16_t *coeffs;                            /*!< Filter coefficients (Q15) */
+    int16_t *delay;                             /*!< Filter delay line */
+    int16_t pending[RESAMPLE_MAX_FACTOR];       /*!< Input samples not yet decimated */
+    uint8_t n_pending;                          /*!< Number of pending samples */
+} decimator_q15_t;
+
+/**
+ * @brief Rational resampler (polyphase)
+ * 
+ * @note Fields are managed by ResamplerInit() and should not be modified by the user.
+ */
+typedef struct {
+    uint8_t up;                 /*!< Interpolation factor (L) */
+    uint8_t down;               /*!< Decimation factor (M) */
+    uint16_t taps;              /*!< Taps per phase */
+    float *coeffs;              /*!< Polyphase coefficients (up phases of taps values, oldest sample first) */
+    float *history;             /*!< Last taps input samples, stored twice (2 * taps) */
+    uint16_t pos;               /*!< History position of the oldest sample */
+    uint8_t phase;              /*!< Phase of the next output sample */
+} resampler_t;
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+/**
+ * @brief Initialize an integer decimator
+ * 
+ * @param dec               Decimator to initialize
+ * @param factor            Decimation factor (2 to RESAMPLE_MAX_FACTOR)
+ * @param taps              Anti-alias filter lenght (more taps, sharper transition band)
+ * @param window            Window applied to the sinc
+ * @return true             Decimator created
+ * @return false            Invalid parameters or not enough memory
+ */
+bool DecimatorInit(decimator_t * dec, uint8_t factor, uint16_t taps, fft_window_t window);
+
+/**
+ * @brief Filter and decimate a block of samples
+ * 
+ * @param dec               Decimator
+ * @param input             Input samples
+ * @param output            Output samples (of lenght >= input_lenght / factor + 1)
+ * @param input_lenght      Number of input samples
+ * @return uint16_t         Number of output samples
+ */
+uint16_t DecimatorProcess(decimator_t * dec, const float * input, float * output, uint16_t input_lenght);
+
+/**
+ * @brief Clear decimator state (delay line and pending samples)
+ * 
+ * @param dec               Decimator
+ */
+void DecimatorReset(decimator_t * dec);
+
+/**
+ * @brief Release the memory used by a decimator
+ * 
+ * @param dec               Decimator
+ */
+void DecimatorDeinit(decimator_t * dec);
+
+/**
+ * @brief Initialize an integer decimator for Q15 signals
+ * 
+ * Coefficients are quantized to Q15. Output is not saturated: leave some headroom
+ * for the filter overshoot on full scale steps.
+ * 
+ * @param dec               Decimator to initialize
+ * @param factor            Decimation factor (2 to RESAMPLE_MAX_FACTOR)
+ * @param taps              Anti-alias filter lenght
+ * @param window            Window applied to the sinc
+ * @return true             Decimator created
+ * @return false            Invalid parameters or not enough memory
+ */
+bool DecimatorInitQ15(decimator_q15_t * dec, uint8_t factor, uint16_t taps, fft_window_t window);
+
+/**
+ * @brief Filter and decimate a block of Q15 samples
+ * 
+ * @param dec               Decimator
+ * @param input             Input samples
+ * @param output            Output samples (of lenght >= input_lenght / factor + 1)
+ * @param input_lenght      Number of input samples
+ * @return uint16_t         Number of output samples
+ */
+uint16_t DecimatorProcessQ15(decimator_q15_t * dec, const int16_t * input, int16_t * output, uint16_t input_lenght);
+
+/**
+ * @brief Clear Q15 decimator state (delay line and pending samples)
+ * 
+ * @param dec               Decimator
+ */
+void DecimatorResetQ15(decimator_q15_t * dec);
+
+/**
+ * @brief Release the memory used by a Q15 decimator
+ * 
+ * @param dec               Decimator
+ */
+void DecimatorDeinitQ15(decimator_q15_t * dec);
+
+/**
+ * @brief Initialize a rational resampler (output rate = input rate * up / down)
+ * 
+ * The prototype filter has up * taps coefficients, each output sample costs taps
+ * multiply-accumulates.
+ * 
+ * @param rs                Resampler to initialize
+ * @param up                Interpolation factor (1 to RESAMPLE_MAX_FACTOR)
+ * @param down              Decimation factor (1 to RESAMPLE_MAX_FACTOR)
+ * @param taps              Taps per phase (at least 2)
+ * @param window            Window applied to the sinc
+ * @return true             Resampler created
+ * @return false            Invalid parameters or not enough memory
+ */
+bool ResamplerInit(resampler_t * rs, uint8_t up, uint8_t down, uint16_t taps, fft_window_t window);
+
+/**
+ * @brief Resample a block of samples
+ * 
+ * @param rs                Resampler
+ * @param input             Input samples
+ * @param output            Output samples (of lenght >= input_lenght * up / down + 1)
+ * @param input_lenght      Number of input samples
+ * @return uint16_t         Number of output samples
+ */
+uint16_t ResamplerProcess(resampler_t * rs, const float * input, float * output, uint16_t input_lenght);
+
+/**
+ * @brief Clear resampler state
+ * 
+ * @param rs                Resampler
+ */
+void ResamplerReset(resampler_t * rs);
+
+/**
+ * @brief Release the memory used by a resampler
+ * 
+ * @param rs                Resampler
+ */
+void ResamplerDeinit(resampler_t * rs);
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+#endif /* RESAMPLE_H_ */
+
+/*==================[end of file]============================================*/
@@ -11,15 +11,40 @@
 
 /*==================[inclusions]=============================================*/
 #include <string.h>
+#include <stdlib.h>
 #include <math.h>
 #include "fft.h"
 #include "esp_dsp.h"
 #include "esp_log.h"
 /*==================[macros and definitions]=================================*/
 #define TAG "FFT Module"
+#define Q15_ONE         32767       /*!< 1.0 in Q15 */
+#define Q15_HEADROOM    14          /*!< Bits used by input signal after block scaling */
+#define MAG_ALPHA       31470       /*!< 0.96043 in Q15 (alpha-max-plus-beta-min) */
+#define MAG_BETA        13036       /*!< 0.39782 in Q15 (alpha-max-plus-beta-min) */
 /*==================[internal data declaration]==============================*/
-static float fft_complex[2 * MAX_SIGNAL_LENGHT];
+/**
+ * @brief Cached window, shared by all the plans with the same lenght and type
+ */
+typedef struct {
+    uint16_t lenght;        /*!< Window lenght (0 if entry is free) */
+    fft_window_t type;      /*!< Window type */
+    uint8_t users;          /*!< Number of plans using this window */
+    float *data;            /*!< Window values */
+} fft_wind_cache_t;
+
+/**
+ * @brief Work buffer: signal_lenght / 2 float complex values, or signal_lenght Q15 complex values
+ */
+static union {
+    float f32[MAX_SIGNAL_LENGHT];
+    int16_t q15[2 * MAX_SIGNAL_LENGHT];
+} fft_work;
 static float wind[MAX_SIGNAL_LENGHT];
+static uint16_t wind_lenght = 0;                        /*!< Lenght of the Hann window stored in wind */
+static fft_wind_cache_t wind_cache[FFT_WINDOW_CACHE];
+static int16_t wind_q15[MAX_SIGNAL_LENGHT / 2];         /*!< First half of the (symmetric) integer Hann window */
+static uint16_t wind_q15_lenght = 0;                    /*!< Lenght of the Hann window stored in wind_q15 */
 /*==================[internal functions declaration]=========================*/
 
 /*==================[internal data definition]===============================*/
@@ -27,6 +52,118 @@ static float wind[MAX_SIGNAL_LENGHT];
 /*==================[external data definition]===============================*/
 
 /*==================[internal functions definition]==========================*/
+static const float * WindowGet(uint16_t lenght, fft_window_t type){
+    fft_wind_cache_t *free_entry = NULL;
+    for(uint8_t i=0; i<FFT_WINDOW_CACHE; i++){
+        if((wind_cache[i].lenght == lenght) && (wind_cache[i].type == type)){
+            wind_cache[i].users++;
+            return wind_cache[i].data;
+        }
+        if((free_entry == NULL) && (wind_cache[i].users == 0)){
+            free_entry = &wind_cache[i];
+        }
+    }
+    if(free_entry == NULL){
+        ESP_LOGE(TAG, "Window cache full");
+        return NULL;
+    }
+    // Reuse an unused entry
+    free(free_entry->data);
+    free_entry->data = malloc(lenght * sizeof(float));
+    if(free_entry->data == NULL){
+        free_entry->lenght = 0;
+        return NULL;
+    }
+    FFTWindow(free_entry->data, lenght, type);
+    free_entry->lenght = lenght;
+    free_entry->type = type;
+    free_entry->users = 1;
+    return free_entry->data;
+}
+
+static void WindowRelease(const float * w){
+    for(uint8_t i=0; i<FFT_WINDOW_CACHE; i++){
+        if((wind_cache[i].data == w) && (wind_cache[i].users > 0)){
+            wind_cache[i].users--;
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Reverse the lowest 'bits' bits of x
+ */
+static uint16_t BitReverse(uint16_t x, uint8_t bits){
+    uint16_t r = 0;
+    for(uint8_t i=0; i<bits; i++){
+        r = (r << 1) | (x & 1);
+        x >>= 1;
+    }
+    return r;
+}
+
+/**
+ * @brief Calculate the spectrum of a windowed real signal packed as signal_lenght / 2 complex values
+ * 
+ * Runs the half size FFT and splits the result into the spectrum of the real signal:
+ * X[k] = E[k] + W^k * O[k], with E[k] = (Z[k] + Z*[M-k]) / 2 and O[k] = (Z[k] - Z*[M-k]) / 2j. 
+ * Twiddles W^k are taken from the (bit reversed) table created by dsps_fft2r_init_fc32().
+ * 
+ * @param power     false: magnitude with FFTMagnitude() scale, true: raw power |X[k]|^2
+ */
+static void RealSpectrum(float * data, float * fft, uint16_t signal_lenght, bool power){
+    uint16_t m = signal_lenght / 2;
+    uint16_t step = dsps_fft_w_table_size / signal_lenght;
+    uint8_t bits = dsp_power_of_two(dsps_fft_w_table_size / 2);
+    float scale = 4.0 / m;      // 2 * |X[k]| / (signal_lenght / 2), as the full size complex FFT
+    // Calculate half size FFT
+    dsps_fft2r_fc32(data, m);
+    dsps_bit_rev_fc32(data, m);
+    // DC (Nyquist bin is not returned)
+    float dc = data[0] + data[1];
+    fft[0] = power ? (dc * dc) : (scale * fabsf(dc) / 4);
+    for(uint16_t k=1; k<=m/2; k++){
+        float zk_re = data[2 * k], zk_im = data[2 * k + 1];
+        float zm_re = data[2 * (m - k)], zm_im = data[2 * (m - k) + 1];
+        float e_re = 0.5 * (zk_re + zm_re);
+        float e_im = 0.5 * (zk_im - zm_im);
+        float o_re = 0.5 * (zk_im + zm_im);
+        float o_im = -0.5 * (zk_re - zm_re);
+        uint16_t w_idx = BitReverse(k * step, bits);
+        float c = dsps_fft_w_table_fc32[2 * w_idx];
+        float s = -dsps_fft_w_table_fc32[2 * w_idx + 1];
+        float t_re = c * o_re - s * o_im;
+        float t_im = c * o_im + s * o_re;
+        float p_k = (e_re + t_re) * (e_re + t_re) + (e_im + t_im) * (e_im + t_im);
+        float p_mk = (e_re - t_re) * (e_re - t_re) + (e_im - t_im) * (e_im - t_im);
+        fft[k] = power ? p_k : (scale * sqrtf(p_k));
+        fft[m - k] = power ? p_mk : (scale * sqrtf(p_mk));
+    }
+}
+
+/**
+ * @brief Magnitude of a Q15 complex value using the alpha-max-plus-beta-min approximation
+ */
+static inline uint32_t MagnitudeQ15(int16_t re, int16_t im){
+    uint32_t a = (re < 0) ? -re : re;
+    uint32_t b = (im < 0) ? -im : im;
+    uint32_t max = (a > b) ? a : b;
+    uint32_t min = (a > b) ? b : a;
+    return (MAG_ALPHA * max + MAG_BETA * min) >> 15;
+}
+
+/**
+ * @brief Unwrap plan ring buffer and apply window, packed as lenght / 2 complex values
+ */
+static void PlanLoadFrame(fft_plan_t * plan){
+    uint16_t mask = plan->lenght - 1;
+    uint16_t idx = plan->write_idx;     // oldest sample
+    for(uint16_t i=0; i<plan->lenght; i++){
+        plan->work[i] = plan->ring[idx] * plan->wind[i];
+        idx = (idx + 1) & mask;
+    }
+    plan->count = 0;
+}
 
 /*==================[external functions definition]==========================*/
 bool FFTInit(void){
@@ -37,26 +174,75 @@ bool FFTInit(void){
     return true;
 }
 
+bool FFTInitQ15(void){
+    esp_err_t ret = dsps_fft2r_init_sc16(NULL, CONFIG_DSP_MAX_FFT_SIZE);
+    if (ret != ESP_OK){
+        return false;
+    }
+    return true;
+}
+
 void FFTMagnitude(float * signal, float * fft, uint16_t signal_lenght){
-    // Generate Hann window
-    dsps_wind_hann_f32(wind, signal_lenght);
-    // Clear fft array
-    memset(fft_complex, 0, 2 * MAX_SIGNAL_LENGHT * sizeof(float));
-    // Multiply input array with window and store as real part
-    dsps_mul_f32(signal, wind, fft_complex, signal_lenght, 1, 1, 2);    
-    // Calculate FFT  
-    dsps_fft2r_fc32(fft_complex, signal_lenght);
-    // Bit reverse
-    dsps_bit_rev_fc32(fft_complex, signal_lenght);
-    // Convert one complex vector to two complex vectors
-    dsps_cplx2reC_fc32(fft_complex, signal_lenght);
-    // Calculate FFT magnitude 
-    for (int j = 0; j < signal_lenght; j++){
-            fft_complex[j] = 2*(sqrt(fft_complex[j*2+0]*fft_complex[j*2+0] + fft_complex[j*2+1]*fft_complex[j*2+1])) / (signal_lenght/2);
-    }
-    fft_complex[0] = fft_complex[0] / 2;
-    // Copy result in fft array
-    memcpy(fft, fft_complex, (signal_lenght / 2) * sizeof(float));
+    FFTMagnitudeReal(signal, fft, signal_lenght);
+}
+
+void FFTMagnitudeReal(float * signal, float * fft, uint16_t signal_lenght){
+    // Generate Hann window (only when signal lenght changes)
+    if(wind_lenght != signal_lenght){
+        dsps_wind_hann_f32(wind, signal_lenght);
+        wind_lenght = signal_lenght;
+    }
+    // Multiply input array with window: even samples as real part, odd samples as imaginary part
+    dsps_mul_f32(signal, wind, fft_work.f32, signal_lenght, 1, 1, 1);
+    // Calculate FFT magnitude
+    RealSpectrum(fft_work.f32, fft, signal_lenght, false);
+}
+
+void FFTMagnitudeQ15(const int16_t * signal, uint16_t * fft, uint16_t signal_lenght){
+    // Generate integer Hann window (only when signal lenght changes)
+    int16_t * data = fft_work.q15;
+    uint16_t half = signal_lenght / 2;
+    if(wind_q15_lenght != signal_lenght){
+        // Float window is generated in the work buffer, so the FFTMagnitude() one is kept
+        dsps_wind_hann_f32(fft_work.f32, signal_lenght);
+        for(uint16_t i=0; i<half; i++){
+            wind_q15[i] = (int16_t)(fft_work.f32[i] * Q15_ONE);
+        }
+        wind_q15_lenght = signal_lenght;
+    }
+    // Block floating point: find the shift that uses all the available bits
+    int32_t max = 0;
+    for(uint16_t i=0; i<signal_lenght; i++){
+        int32_t a = (signal[i] < 0) ? -signal[i] : signal[i];
+        if(a > max){
+            max = a;
+        }
+    }
+    uint8_t shift = 0;
+    while((max != 0) && (max < (1 << (Q15_HEADROOM - 1)))){
+        max <<= 1;
+        shift++;
+    }
+    // Multiply input array with window (second half mirrored) and store as real part
+    for(uint16_t i=0; i<half; i++){
+        data[2 * i] = ((int32_t)signal[i] * wind_q15[i]) >> (15 - shift);
+        data[2 * i + 1] = 0;
+    }
+    for(uint16_t i=half; i<signal_lenght; i++){
+        data[2 * i] = ((int32_t)signal[i] * wind_q15[signal_lenght - 1 - i]) >> (15 - shift);
+        data[2 * i + 1] = 0;
+    }
+    // Calculate FFT (result scaled by 1 / signal_lenght)
+    dsps_fft2r_sc16_ansi(data, signal_lenght);
+    dsps_bit_rev_sc16_ansi(data, signal_lenght);
+    // Calculate FFT magnitude, undo block scaling and apply FFTMagnitude() scale
+    uint32_t round = (shift > 0) ? (1 << (shift - 1)) : 0;
+    for(uint16_t j=0; j<half; j++){
+        uint32_t mag = MagnitudeQ15(data[2 * j], data[2 * j + 1]);
+        mag = (j == 0) ? (2 * mag) : (8 * mag);
+        mag = (mag + round) >> shift;
+        fft[j] = (mag > UINT16_MAX) ? UINT16_MAX : mag;
+    }
 }
 
 void FFTFrequency(float sample_freq, uint16_t signal_lenght, float * f){
@@ -66,4 +252,88 @@ void FFTFrequency(float sample_freq, uint16_t signal_lenght, float * f){
     }
 }
 
+void FFTWindow(float * w, uint16_t lenght, fft_window_t type){
+    switch(type){
+        case FFT_WINDOW_RECT:
+            for(uint16_t i=0; i<lenght; i++){
+                w[i] = 1.0;
+            }
+        break;
+        case FFT_WINDOW_HANN:
+            dsps_wind_hann_f32(w, lenght);
+        break;
+        case FFT_WINDOW_BLACKMAN:
+            dsps_wind_blackman_f32(w, lenght);
+        break;
+        case FFT_WINDOW_BLACKMAN_HARRIS:
+            dsps_wind_blackman_harris_f32(w, lenght);
+        break;
+        case FFT_WINDOW_BLACKMAN_NUTTALL:
+            dsps_wind_blackman_nuttall_f32(w, lenght);
+        break;
+        case FFT_WINDOW_NUTTALL:
+            dsps_wind_nuttall_f32(w, lenght);
+        break;
+        case FFT_WINDOW_FLAT_TOP:
+            dsps_wind_flat_top_f32(w, lenght);
+        break;
+    }
+}
+
+bool FFTPlanCreate(fft_plan_t * plan, uint16_t signal_lenght, fft_window_t window, uint16_t hop){
+    if(!dsp_is_power_of_two(signal_lenght) || (signal_lenght < 4) || (signal_lenght > MAX_SIGNAL_LENGHT) || (hop == 0) || (hop > signal_lenght)){
+        ESP_LOGE(TAG, "Invalid plan parameters");
+        return false;
+    }
+    memset(plan, 0, sizeof(fft_plan_t));
+    plan->lenght = signal_lenght;
+    plan->hop = hop;
+    plan->window = window;
+    plan->wind = WindowGet(signal_lenght, window);
+    plan->ring = calloc(signal_lenght, sizeof(float));
+    plan->work = malloc(signal_lenght * sizeof(float));
+    if((plan->wind == NULL) || (plan->ring == NULL) || (plan->work == NULL)){
+        FFTPlanDelete(plan);
+        return false;
+    }
+    return true;
+}
+
+void FFTPlanDelete(fft_plan_t * plan){
+    if(plan->wind != NULL){
+        WindowRelease(plan->wind);
+    }
+    free(plan->ring);
+    free(plan->work);
+    memset(plan, 0, sizeof(fft_plan_t));
+}
+
+uint16_t FFTPlanPush(fft_plan_t * plan, const float * samples, uint16_t n){
+    uint16_t mask = plan->lenght - 1;
+    uint16_t used = 0;
+    while((used < n) && !FFTPlanReady(plan)){
+        plan->ring[plan->write_idx] = samples[used++];
+        plan->write_idx = (plan->write_idx + 1) & mask;
+        plan->count++;
+        if(plan->write_idx == 0){
+            plan->primed = true;
+        }
+    }
+    return used;
+}
+
+bool FFTPlanReady(const fft_plan_t * plan){
+    return plan->primed && (plan->count >= plan->hop);
+}
+
+void FFTPlanExecute(fft_plan_t * plan, float * fft){
+    PlanLoadFrame(plan);
+    RealSpectrum(plan->work, fft, plan->lenght, false);
+}
+
+void FFTPlanExecutePower(fft_plan_t * plan, float * power){
+    PlanLoadFrame(plan);
+    RealSpectrum(plan->work, power, plan->lenght, true);
+}
+
 /*==================[end of file]============================================*/
\ No newline at end of file
@@ -0,0 +1,137 @@
+/**
+ * @file goertzel.c
+ * @author Valentina de la Rosa (valentina.delarosa@ingenieria.uner.edu.ar)
+ * @brief Goertzel filter bank and sliding DFT
+ * @version 0.1
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+/*==================[inclusions]=============================================*/
+#include <string.h>
+#include <math.h>
+#include "goertzel.h"
+/*==================[macros and definitions]=================================*/
+#define SDFT_DAMPING    0.99999f    /*!< Keeps sliding DFT stable against rounding errors */
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+/**
+ * @brief Round a frequency to the nearest bin index of an N point DFT
+ */
+static uint16_t FrequencyToBin(float freq, float sample_freq, uint16_t lenght){
+    float k = roundf(freq * lenght / sample_freq);
+    if(k < 0){
+        k = 0;
+    }
+    if(k > lenght / 2){
+        k = lenght / 2;
+    }
+    return (uint16_t)k;
+}
+
+/**
+ * @brief Amplitude of a bin from its DFT value
+ * 
+ * DC and Nyquist (k = N / 2) bins have no negative frequency counterpart, so they are not doubled.
+ */
+static float BinAmplitude(float power, uint16_t bin, uint16_t lenght){
+    float mag = sqrtf(power) / lenght;
+    return ((bin == 0) || (2 * bin == lenght)) ? mag : 2 * mag;
+}
+/*==================[external functions definition]==========================*/
+bool GoertzelInit(goertzel_t * bank, float sample_freq, uint16_t block_lenght, const float * freqs, uint8_t n_bins){
+    if((n_bins == 0) || (n_bins > GOERTZEL_MAX_BINS) || (block_lenght == 0)){
+        return false;
+    }
+    memset(bank, 0, sizeof(goertzel_t));
+    bank->lenght = block_lenght;
+    bank->n_bins = n_bins;
+    for(uint8_t i=0; i<n_bins; i++){
+        bank->bin[i] = FrequencyToBin(freqs[i], sample_freq, block_lenght);
+        bank->coeff[i] = 2 * cosf(2 * M_PI * bank->bin[i] / block_lenght);
+    }
+    return true;
+}
+
+bool GoertzelUpdate(goertzel_t * bank, float sample){
+    for(uint8_t i=0; i<bank->n_bins; i++){
+        float s0 = sample + bank->coeff[i] * bank->s1[i] - bank->s2[i];
+        bank->s2[i] = bank->s1[i];
+        bank->s1[i] = s0;
+    }
+    if(++bank->count < bank->lenght){
+        return false;
+    }
+    // End of block: |X[k]|^2 = s1^2 + s2^2 - coeff * s1 * s2
+    for(uint8_t i=0; i<bank->n_bins; i++){
+        float s1 = bank->s1[i], s2 = bank->s2[i];
+        float power = s1 * s1 + s2 * s2 - bank->coeff[i] * s1 * s2;
+        bank->mag[i] = BinAmplitude(fabsf(power), bank->bin[i], bank->lenght);
+        bank->s1[i] = 0;
+        bank->s2[i] = 0;
+    }
+    bank->count = 0;
+    return true;
+}
+
+void GoertzelMagnitude(const goertzel_t * bank, float * mag){
+    memcpy(mag, bank->mag, bank->n_bins * sizeof(float));
+}
+
+void GoertzelFrequency(const goertzel_t * bank, float sample_freq, float * f){
+    float freq_step = sample_freq / (float)bank->lenght;
+    for(uint8_t i=0; i<bank->n_bins; i++){
+        f[i] = bank->bin[i] * freq_step;
+    }
+}
+
+bool SlidingDFTInit(sdft_t * sdft, float sample_freq, uint16_t lenght, const float * freqs, uint8_t n_bins, float * delay_buffer){
+    if((n_bins == 0) || (n_bins > GOERTZEL_MAX_BINS) || (lenght == 0) || (delay_buffer == NULL)){
+        return false;
+    }
+    memset(sdft, 0, sizeof(sdft_t));
+    memset(delay_buffer, 0, lenght * sizeof(float));
+    sdft->lenght = lenght;
+    sdft->delay = delay_buffer;
+    sdft->damp_n = powf(SDFT_DAMPING, lenght);
+    sdft->n_bins = n_bins;
+    for(uint8_t i=0; i<n_bins; i++){
+        sdft->bin[i] = FrequencyToBin(freqs[i], sample_freq, lenght);
+        sdft->w_re[i] = SDFT_DAMPING * cosf(2 * M_PI * sdft->bin[i] / lenght);
+        sdft->w_im[i] = SDFT_DAMPING * sinf(2 * M_PI * sdft->bin[i] / lenght);
+    }
+    return true;
+}
+
+void SlidingDFTUpdate(sdft_t * sdft, float sample){
+    // X[k] = r * e^(j2pik/N) * (X[k] + x[n] - r^N * x[n - N])
+    float delta = sample - sdft->damp_n * sdft->delay[sdft->idx];
+    sdft->delay[sdft->idx] = sample;
+    if(++sdft->idx == sdft->lenght){
+        sdft->idx = 0;
+    }
+    for(uint8_t i=0; i<sdft->n_bins; i++){
+        float re = sdft->re[i] + delta;
+        float im = sdft->im[i];
+        sdft->re[i] = re * sdft->w_re[i] - im * sdft->w_im[i];
+        sdft->im[i] = re * sdft->w_im[i] + im * sdft->w_re[i];
+    }
+}
+
+void SlidingDFTMagnitude(const sdft_t * sdft, float * mag){
+    for(uint8_t i=0; i<sdft->n_bins; i++){
+        float power = sdft->re[i] * sdft->re[i] + sdft->im[i] * sdft->im[i];
+        mag[i] = BinAmplitude(power, sdft->bin[i], sdft->lenght);
+    }
+}
+
+/*==================[end of file]============================================*/
@@ -10,43 +10,21 @@
  */
 
 /*==================[inclusions]=============================================*/
+#include <string.h>
+#include <math.h>
 #include "iir_filter.h"
 #include "esp_dsp.h"
+#include "freertos/FreeRTOS.h"
 /*==================[macros and definitions]=================================*/
-#define N_SOS       5
-#define N_DELAY     2
-// 2nd order Butterworth 
-#define ORDER2_Q    (1 / 1.414)
-// 4th order Butterworth 
-#define ORDER4_Q1   (1 / 0.765)
-#define ORDER4_Q2   (1 / 1.848)
-// 6th order Butterworth 
-#define ORDER6_Q1   (1 / 0.518)
-#define ORDER6_Q2   (1 / 1.414)
-#define ORDER6_Q3   (1 / 1.932)
-// 8th order Butterworth 
-#define ORDER8_Q1   (1 / 0.390)
-#define ORDER8_Q2   (1 / 1.111)
-#define ORDER8_Q3   (1 / 1.663)
-#define ORDER8_Q4   (1 / 1.962)
+#define LEGACY_SECTIONS     (ORDER_8 / 2)   /*!< Sections used by LowPass/HiPass functions */
+#define MAX_PADDING         (3 * (2 * IIR_MAX_SECTIONS + 1))    /*!< Maximum edge padding for zero-phase filtering */
 /*==================[internal data declaration]==============================*/
-static uint8_t lp_order, hp_order;
-float hp2_delay[N_DELAY] = {0, 0};  // delay
-float hp4_delay[N_DELAY] = {0, 0};  // delay
-float hp6_delay[N_DELAY] = {0, 0};  // delay
-float hp8_delay[N_DELAY] = {0, 0};  // delay
-float lp2_delay[N_DELAY] = {0, 0};  // delay
-float lp4_delay[N_DELAY] = {0, 0};  // delay
-float lp6_delay[N_DELAY] = {0, 0};  // delay
-float lp8_delay[N_DELAY] = {0, 0};  // delay
-float lp2_sos_coeff[N_SOS]; 
-float lp4_sos_coeff[N_SOS]; 
-float lp6_sos_coeff[N_SOS]; 
-float lp8_sos_coeff[N_SOS]; 
-float hp2_sos_coeff[N_SOS]; 
-float hp4_sos_coeff[N_SOS]; 
-float hp6_sos_coeff[N_SOS]; 
-float hp8_sos_coeff[N_SOS]; 
+static iir_filter_t lp_filter, hp_filter;
+static iir_sos_t lp_sos[LEGACY_SECTIONS];
+static iir_sos_t hp_sos[LEGACY_SECTIONS];
+static iir_sos_t sos_pool[IIR_POOL_SECTIONS];
+static bool sos_pool_used[IIR_POOL_SECTIONS];
+static portMUX_TYPE sos_pool_mux = portMUX_INITIALIZER_UNLOCKED;
 /*==================[internal functions declaration]=========================*/
 
 /*==================[internal data definition]===============================*/
@@ -54,103 +32,265 @@ float hp8_sos_coeff[N_SOS];
 /*==================[external data definition]===============================*/
 
 /*==================[internal functions definition]==========================*/
+/**
+ * @brief Take n consecutive sections from the pool
+ */
+static iir_sos_t * PoolAlloc(uint8_t n){
+    iir_sos_t *sos = NULL;
+    taskENTER_CRITICAL(&sos_pool_mux);
+    for(uint8_t first=0; (first + n <= IIR_POOL_SECTIONS) && (sos == NULL); first++){
+        uint8_t i;
+        for(i=0; (i<n) && !sos_pool_used[first + i]; i++);
+        if(i == n){
+            memset(&sos_pool_used[first], true, n);
+            sos = &sos_pool[first];
+        }
+    }
+    taskEXIT_CRITICAL(&sos_pool_mux);
+    return sos;
+}
+
+static void PoolFree(iir_sos_t * sos, uint8_t n){
+    taskENTER_CRITICAL(&sos_pool_mux);
+    memset(&sos_pool_used[sos - sos_pool], false, n);
+    taskEXIT_CRITICAL(&sos_pool_mux);
+}
+
+static bool AssignStorage(iir_filter_t * filter, uint8_t n_sos, iir_sos_t * storage){
+    filter->n_sos = n_sos;
+    filter->pooled = (storage == NULL);
+    filter->sos = NULL;
+    if((n_sos > 0) && (n_sos <= IIR_MAX_SECTIONS)){
+        // cascade_t (single pass kernel) holds at most IIR_MAX_SECTIONS sections
+        filter->sos = filter->pooled ? PoolAlloc(n_sos) : storage;
+    }
+    if(filter->sos == NULL){
+        filter->n_sos = 0;
+        return false;
+    }
+    memset(filter->sos, 0, n_sos * sizeof(iir_sos_t));
+    return true;
+}
+/**
+ * @brief Local copy of a cascade, so coefficients and state do not alias the signal arrays
+ */
+typedef struct {
+    float c[IIR_MAX_SECTIONS][5];
+    float d[IIR_MAX_SECTIONS][2];
+    uint8_t n;
+} cascade_t;
+
+static inline void CascadeLoad(cascade_t * cas, const iir_filter_t * filter){
+    cas->n = filter->n_sos;
+    for(uint8_t k=0; k<cas->n; k++){
+        memcpy(cas->c[k], filter->sos[k].coeffs, sizeof(cas->c[k]));
+        memcpy(cas->d[k], filter->sos[k].delay, sizeof(cas->d[k]));
+    }
+}
+
+static inline void CascadeStore(const cascade_t * cas, iir_filter_t * filter){
+    for(uint8_t k=0; k<cas->n; k++){
+        memcpy(filter->sos[k].delay, cas->d[k], sizeof(cas->d[k]));
+    }
+}
 
+/**
+ * @brief Push one sample through all the sections of a cascade (transposed direct form II)
+ * 
+ * The sample stays in a register from the first to the last section, instead of 
+ * walking the whole signal array once per section.
+ */
+static inline float CascadeStep(cascade_t * cas, float x){
+    for(uint8_t k=0; k<cas->n; k++){
+        const float *c = cas->c[k];
+        float *d = cas->d[k];
+        float y = c[0] * x + d[0];
+        d[0] = c[1] * x - c[3] * y + d[1];
+        d[1] = c[2] * x - c[4] * y;
+        x = y;
+    }
+    return x;
+}
+/**
+ * @brief Set the cascade state to the steady state response to a constant input x0
+ * 
+ * For each section (transposed direct form II) with DC input u and output y = H(1) * u:
+ * d0 = y - b0 * u, d1 = b2 * u - a2 * y.
+ */
+static void CascadeSteadyState(cascade_t * cas, float x0){
+    float u = x0;
+    for(uint8_t k=0; k<cas->n; k++){
+        const float *c = cas->c[k];
+        float y = u * (c[0] + c[1] + c[2]) / (1 + c[3] + c[4]);
+        cas->d[k][0] = y - c[0] * u;
+        cas->d[k][1] = c[2] * u - c[4] * y;
+        u = y;
+    }
+}
 /*==================[external functions definition]==========================*/
+uint8_t IIRSections(const iir_design_t * design){
+    switch(design->type){
+        case IIR_LOW_PASS:
+        case IIR_HI_PASS:
+            if((design->order < 2) || (design->order > IIR_MAX_ORDER) || (design->order % 2)){
+                return 0;
+            }
+            return design->order / 2;
+        case IIR_BAND_PASS:
+        case IIR_NOTCH:
+        case IIR_LOW_SHELF:
+        case IIR_HI_SHELF:
+            return 1;
+    }
+    return 0;
+}
 
-void LowPassInit(float sample_frec, float cut_frec, filter_order_t order){
-    float f = cut_frec / sample_frec;
-    lp_order = order;
-    switch(lp_order){
-        case ORDER_2:
-            dsps_biquad_gen_lpf_f32(lp2_sos_coeff, f, ORDER2_Q);
-        break;
-        case ORDER_4:
-            dsps_biquad_gen_lpf_f32(lp2_sos_coeff, f, ORDER4_Q1);
-            dsps_biquad_gen_lpf_f32(lp4_sos_coeff, f, ORDER4_Q2);
-        break;
-        case ORDER_6:
-            dsps_biquad_gen_lpf_f32(lp2_sos_coeff, f, ORDER6_Q1);
-            dsps_biquad_gen_lpf_f32(lp4_sos_coeff, f, ORDER6_Q2);
-            dsps_biquad_gen_lpf_f32(lp6_sos_coeff, f, ORDER6_Q3);
-        break;
-        case ORDER_8:
-            dsps_biquad_gen_lpf_f32(lp2_sos_coeff, f, ORDER8_Q1);
-            dsps_biquad_gen_lpf_f32(lp4_sos_coeff, f, ORDER8_Q2);
-            dsps_biquad_gen_lpf_f32(lp6_sos_coeff, f, ORDER8_Q3);
-            dsps_biquad_gen_lpf_f32(lp8_sos_coeff, f, ORDER8_Q4);
-        break;
+bool IIRCreate(iir_filter_t * filter, const iir_design_t * design, iir_sos_t * storage){
+    uint8_t n_sos = IIRSections(design);
+    float f = design->cut_frec / design->sample_frec;
+    if(!AssignStorage(filter, n_sos, storage)){
+        return false;
+    }
+    for(uint8_t k=0; k<n_sos; k++){
+        // Butterworth pole pairs: Q = 1 / (2 * sin((2k + 1) * pi / (2 * order)))
+        float q = 1.0 / (2 * sin((2 * k + 1) * M_PI / (2 * n_sos * 2)));
+        float *coeffs = filter->sos[k].coeffs;
+        switch(design->type){
+            case IIR_LOW_PASS:
+                dsps_biquad_gen_lpf_f32(coeffs, f, q);
+            break;
+            case IIR_HI_PASS:
+                dsps_biquad_gen_hpf_f32(coeffs, f, q);
+            break;
+            case IIR_BAND_PASS:
+                dsps_biquad_gen_bpf0db_f32(coeffs, f, design->q);
+            break;
+            case IIR_NOTCH:
+                dsps_biquad_gen_notch_f32(coeffs, f, design->gain, design->q);
+            break;
+            case IIR_LOW_SHELF:
+                dsps_biquad_gen_lowShelf_f32(coeffs, f, design->gain, design->q);
+            break;
+            case IIR_HI_SHELF:
+                dsps_biquad_gen_highShelf_f32(coeffs, f, design->gain, design->q);
+            break;
+        }
     }
+    return true;
 }
 
-void HiPassInit(float sample_frec, float cut_frec, filter_order_t order){
-    float f = cut_frec / sample_frec;
-    hp_order = order;
-    switch(hp_order){
-        case ORDER_2:
-            dsps_biquad_gen_hpf_f32(hp2_sos_coeff, f, ORDER2_Q);
-        break;
-        case ORDER_4:
-            dsps_biquad_gen_hpf_f32(hp2_sos_coeff, f, ORDER4_Q1);
-            dsps_biquad_gen_hpf_f32(hp4_sos_coeff, f, ORDER4_Q2);
-        break;
-        case ORDER_6:
-            dsps_biquad_gen_hpf_f32(hp2_sos_coeff, f, ORDER6_Q1);
-            dsps_biquad_gen_hpf_f32(hp4_sos_coeff, f, ORDER6_Q2);
-            dsps_biquad_gen_hpf_f32(hp6_sos_coeff, f, ORDER6_Q3);
-        break;
-        case ORDER_8:
-            dsps_biquad_gen_hpf_f32(hp2_sos_coeff, f, ORDER8_Q1);
-            dsps_biquad_gen_hpf_f32(hp4_sos_coeff, f, ORDER8_Q2);
-            dsps_biquad_gen_hpf_f32(hp6_sos_coeff, f, ORDER8_Q3);
-            dsps_biquad_gen_hpf_f32(hp8_sos_coeff, f, ORDER8_Q4);
-        break;
+bool IIRCreateFromSOS(iir_filter_t * filter, const float (*coeffs)[5], uint8_t n_sos, iir_sos_t * storage){
+    if(!AssignStorage(filter, n_sos, storage)){
+        return false;
+    }
+    for(uint8_t k=0; k<n_sos; k++){
+        memcpy(filter->sos[k].coeffs, coeffs[k], sizeof(filter->sos[k].coeffs));
     }
+    return true;
 }
 
-void LowPassFilter(float * input_signal, float * output_signal, int16_t signal_lenght){
-    switch(lp_order){
-        case ORDER_2:
-            dsps_biquad_f32(input_signal, output_signal, signal_lenght, lp2_sos_coeff, lp2_delay);
-        break;
-        case ORDER_4:
-            dsps_biquad_f32(input_signal, output_signal, signal_lenght, lp2_sos_coeff, lp2_delay);
-            dsps_biquad_f32(output_signal, output_signal, signal_lenght, lp4_sos_coeff, lp4_delay);
-        break;
-        case ORDER_6:
-            dsps_biquad_f32(input_signal, output_signal, signal_lenght, lp2_sos_coeff, lp2_delay);
-            dsps_biquad_f32(output_signal, output_signal, signal_lenght, lp4_sos_coeff, lp4_delay);
-            dsps_biquad_f32(output_signal, output_signal, signal_lenght, lp6_sos_coeff, lp6_delay);
-        break;
-        case ORDER_8:
-            dsps_biquad_f32(input_signal, output_signal, signal_lenght, lp2_sos_coeff, lp2_delay);
-            dsps_biquad_f32(output_signal, output_signal, signal_lenght, lp4_sos_coeff, lp4_delay);
-            dsps_biquad_f32(output_signal, output_signal, signal_lenght, lp6_sos_coeff, lp6_delay);
-            dsps_biquad_f32(output_signal, output_signal, signal_lenght, lp8_sos_coeff, lp8_delay);
-        break;
+void IIRDelete(iir_filter_t * filter){
+    if(filter->pooled && (filter->sos != NULL)){
+        PoolFree(filter->sos, filter->n_sos);
+    }
+    memset(filter, 0, sizeof(iir_filter_t));
+}
+
+void IIRProcess(iir_filter_t * filter, const float * input_signal, float * output_signal, uint16_t signal_lenght){
+    cascade_t cas;
+    CascadeLoad(&cas, filter);
+    for(uint16_t i=0; i<signal_lenght; i++){
+        output_signal[i] = CascadeStep(&cas, input_signal[i]);
+    }
+    CascadeStore(&cas, filter);
+}
+
+void IIRProcessSeries(iir_filter_t * first, iir_filter_t * second, const float * input_signal, float * output_signal, uint16_t signal_lenght){
+    cascade_t cas_1, cas_2;
+    CascadeLoad(&cas_1, first);
+    CascadeLoad(&cas_2, second);
+    for(uint16_t i=0; i<signal_lenght; i++){
+        output_signal[i] = CascadeStep(&cas_2, CascadeStep(&cas_1, input_signal[i]));
+    }
+    CascadeStore(&cas_1, first);
+    CascadeStore(&cas_2, second);
+}
+
+void IIRFiltFilt(const iir_filter_t * filter, float * signal, uint16_t signal_lenght){
+    cascade_t cas;
+    float end[MAX_PADDING + 1];     // original samples at the end of the signal
+    float tail[MAX_PADDING];        // forward output of the end padding
+    uint16_t pad = 3 * (2 * filter->n_sos + 1);
+    if(signal_lenght < 2){
+        return;
+    }
+    if(pad > MAX_PADDING){
+        pad = MAX_PADDING;
+    }
+    if(pad >= signal_lenght){
+        pad = signal_lenght - 1;
+    }
+    CascadeLoad(&cas, filter);
+    // Forward pass over odd extension: 2 * x[0] - x[pad..1], x[0..N-1], 2 * x[N-1] - x[N-2..N-1-pad]
+    float x0 = signal[0];
+    float xn = signal[signal_lenght - 1];
+    memcpy(end, &signal[signal_lenght - 1 - pad], (pad + 1) * sizeof(float));
+    CascadeSteadyState(&cas, 2 * x0 - signal[pad]);
+    for(uint16_t i=pad; i>0; i--){
+        CascadeStep(&cas, 2 * x0 - signal[i]);
+    }
+    for(uint16_t i=0; i<signal_lenght; i++){
+        signal[i] = CascadeStep(&cas, signal[i]);
+    }
+    for(uint16_t i=0; i<pad; i++){
+        tail[i] = CascadeStep(&cas, 2 * xn - end[pad - 1 - i]);
+    }
+    // Backward pass (starting from the end of the padding, whose output is discarded)
+    CascadeSteadyState(&cas, tail[pad - 1]);
+    for(uint16_t i=pad; i>0; i--){
+        CascadeStep(&cas, tail[i - 1]);
+    }
+    for(uint16_t i=signal_lenght; i>0; i--){
+        signal[i - 1] = CascadeStep(&cas, signal[i - 1]);
     }
 }
 
+void IIRReset(iir_filter_t * filter){
+    for(uint8_t k=0; k<filter->n_sos; k++){
+        memset(filter->sos[k].delay, 0, sizeof(filter->sos[k].delay));
+    }
+}
+
+void LowPassInit(float sample_frec, float cut_frec, filter_order_t order){
+    iir_design_t design = {
+        .type = IIR_LOW_PASS,
+        .sample_frec = sample_frec,
+        .cut_frec = cut_frec,
+        .order = order,
+    };
+    IIRCreate(&lp_filter, &design, lp_sos);
+}
+
+void HiPassInit(float sample_frec, float cut_frec, filter_order_t order){
+    iir_design_t design = {
+        .type = IIR_HI_PASS,
+        .sample_frec = sample_frec,
+        .cut_frec = cut_frec,
+        .order = order,
+    };
+    IIRCreate(&hp_filter, &design, hp_sos);
+}
+
+void LowPassFilter(float * input_signal, float * output_signal, int16_t signal_lenght){
+    IIRProcess(&lp_filter, input_signal, output_signal, signal_lenght);
+}
+
 void HiPassFilter(float * input_signal, float * output_signal, int16_t signal_lenght){
-    switch(hp_order){
-        case ORDER_2:
-            dsps_biquad_f32(input_signal, output_signal, signal_lenght, hp2_sos_coeff, hp2_delay);
-        break;
-        case ORDER_4:
-            dsps_biquad_f32(input_signal, output_signal, signal_lenght, hp2_sos_coeff, hp2_delay);
-            dsps_biquad_f32(output_signal, output_signal, signal_lenght, hp4_sos_coeff, hp4_delay);
-        break;
-        case ORDER_6:
-            dsps_biquad_f32(input_signal, output_signal, signal_lenght, hp2_sos_coeff, hp2_delay);
-            dsps_biquad_f32(output_signal, output_signal, signal_lenght, hp4_sos_coeff, hp4_delay);
-            dsps_biquad_f32(output_signal, output_signal, signal_lenght, hp6_sos_coeff, hp6_delay);
-        break;
-        case ORDER_8:
-            dsps_biquad_f32(input_signal, output_signal, signal_lenght, hp2_sos_coeff, hp2_delay);
-            dsps_biquad_f32(output_signal, output_signal, signal_lenght, hp4_sos_coeff, hp4_delay);
-            dsps_biquad_f32(output_signal, output_signal, signal_lenght, hp6_sos_coeff, hp6_delay);
-            dsps_biquad_f32(output_signal, output_signal, signal_lenght, hp8_sos_coeff, hp8_delay);
-        break;
-    }
-}
-
-/*==================[end of file]============================================*/
\ No newline at end of file
+    IIRProcess(&hp_filter, input_signal, output_signal, signal_lenght);
+}
+
+void BandPassFilter(float * input_signal, float * output_signal, int16_t signal_lenght){
+    IIRProcessSeries(&hp_filter, &lp_filter, input_signal, output_signal, signal_lenght);
+}
+
+/*==================[end of file]============================================*/
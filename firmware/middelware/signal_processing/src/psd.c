@@ -0,0 +1,116 @@
+/**
+ * @file psd.c
+ * @author Valentina de la Rosa (valentina.delarosa@ingenieria.uner.edu.ar)
+ * @brief Averaged power spectral density (Welch method)
+ * @version 0.1
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+/*==================[inclusions]=============================================*/
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include "psd.h"
+#include "esp_log.h"
+/*==================[macros and definitions]=================================*/
+#define TAG "PSD Module"
+#define MIN_POWER   1e-20       /*!< Minimum power to avoid log10(0) */
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+static void Accumulate(psd_t * psd){
+    uint16_t bins = psd->config.segment_lenght / 2;
+    if(psd->segments == 0){
+        memcpy(psd->acc, psd->power, bins * sizeof(float));
+    }else if(psd->config.average == PSD_AVERAGE_LINEAR){
+        for(uint16_t k=0; k<bins; k++){
+            psd->acc[k] += psd->power[k];
+        }
+    }else{
+        float alpha = psd->config.alpha;
+        for(uint16_t k=0; k<bins; k++){
+            psd->acc[k] += alpha * (psd->power[k] - psd->acc[k]);
+        }
+    }
+    psd->segments++;
+}
+/*==================[external functions definition]==========================*/
+bool PSDInit(psd_t * psd, const psd_config_t * config){
+    memset(psd, 0, sizeof(psd_t));
+    if((config->overlap >= config->segment_lenght) || (config->sample_freq <= 0) ||
+       ((config->average == PSD_AVERAGE_EXPONENTIAL) && ((config->alpha <= 0) || (config->alpha > 1)))){
+        ESP_LOGE(TAG, "Invalid PSD parameters");
+        return false;
+    }
+    psd->config = *config;
+    if(!FFTPlanCreate(&psd->plan, config->segment_lenght, config->window, config->segment_lenght - config->overlap)){
+        return false;
+    }
+    psd->acc = malloc((config->segment_lenght / 2) * sizeof(float));
+    psd->power = malloc((config->segment_lenght / 2) * sizeof(float));
+    if((psd->acc == NULL) || (psd->power == NULL)){
+        PSDDeinit(psd);
+        return false;
+    }
+    // Window power, computed once from the cached window
+    float wind_power = 0;
+    for(uint16_t i=0; i<config->segment_lenght; i++){
+        wind_power += psd->plan.wind[i] * psd->plan.wind[i];
+    }
+    psd->norm = 1.0 / (config->sample_freq * wind_power);
+    return true;
+}
+
+void PSDDeinit(psd_t * psd){
+    FFTPlanDelete(&psd->plan);
+    free(psd->acc);
+    free(psd->power);
+    memset(psd, 0, sizeof(psd_t));
+}
+
+uint16_t PSDPush(psd_t * psd, const float * samples, uint16_t n){
+    uint16_t completed = 0;
+    while(n){
+        uint16_t used = FFTPlanPush(&psd->plan, samples, n);
+        samples += used;
+        n -= used;
+        if(FFTPlanReady(&psd->plan)){
+            FFTPlanExecutePower(&psd->plan, psd->power);
+            Accumulate(psd);
+            completed++;
+        }
+    }
+    return completed;
+}
+
+uint32_t PSDGet(const psd_t * psd, float * out, psd_scale_t scale){
+    uint16_t bins = psd->config.segment_lenght / 2;
+    if(psd->segments == 0){
+        return 0;
+    }
+    float norm = psd->norm;
+    if(psd->config.average == PSD_AVERAGE_LINEAR){
+        norm /= psd->segments;
+    }
+    for(uint16_t k=0; k<bins; k++){
+        // One-sided spectrum: all bins except DC hold the power of negative frequencies
+        float p = psd->acc[k] * norm * ((k == 0) ? 1 : 2);
+        out[k] = (scale == PSD_SCALE_DB) ? 10 * log10f(p + MIN_POWER) : p;
+    }
+    return psd->segments;
+}
+
+void PSDReset(psd_t * psd){
+    psd->segments = 0;
+}
+
+/*==================[end of file]============================================*/
@@ -0,0 +1,251 @@
+/**
+ * @file resample.c
+ * @author Valentina de la Rosa (valentina.delarosa@ingenieria.uner.edu.ar)
+ * @brief Decimation and rational resampling with windowed-sinc filters
+ * @version 0.1
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+/*==================[inclusions]=============================================*/
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include "resample.h"
+#include "esp_dsp.h"
+#include "esp_log.h"
+/*==================[macros and definitions]=================================*/
+#define TAG "Resample Module"
+#define MIN_TAPS    2           /*!< Minimum filter lenght */
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+/**
+ * @brief Design a windowed-sinc low pass filter
+ * 
+ * @param h             Array to store coefficients (of lenght = lenght)
+ * @param lenght        Number of coefficients
+ * @param cutoff        Cutoff frequency relative to sample frequency (0 to 0.5)
+ * @param gain          DC gain
+ * @param window        Window type
+ */
+static void DesignLowPass(float * h, uint16_t lenght, float cutoff, float gain, fft_window_t window){
+    float center = (lenght - 1) / 2.0;
+    float sum = 0;
+    FFTWindow(h, lenght, window);
+    for(uint16_t i=0; i<lenght; i++){
+        float x = i - center;
+        if(x == 0){
+            h[i] *= 2 * cutoff;
+        }else{
+            h[i] *= sinf(2 * M_PI * cutoff * x) / (M_PI * x);
+        }
+        sum += h[i];
+    }
+    for(uint16_t i=0; i<lenght; i++){
+        h[i] *= gain / sum;
+    }
+}
+
+static uint8_t GreatestCommonDivisor(uint8_t a, uint8_t b){
+    while(b != 0){
+        uint8_t r = a % b;
+        a = b;
+        b = r;
+    }
+    return a;
+}
+/*==================[external functions definition]==========================*/
+bool DecimatorInit(decimator_t * dec, uint8_t factor, uint16_t taps, fft_window_t window){
+    memset(dec, 0, sizeof(decimator_t));
+    if((factor < 2) || (factor > RESAMPLE_MAX_FACTOR) || (taps < MIN_TAPS)){
+        ESP_LOGE(TAG, "Invalid decimator parameters");
+        return false;
+    }
+    dec->coeffs = malloc(taps * sizeof(float));
+    dec->delay = malloc(taps * sizeof(float));
+    if((dec->coeffs == NULL) || (dec->delay == NULL)){
+        DecimatorDeinit(dec);
+        return false;
+    }
+    DesignLowPass(dec->coeffs, taps, 0.5 / factor, 1, window);
+    if(dsps_fird_init_f32(&dec->fir, dec->coeffs, dec->delay, taps, factor) != ESP_OK){
+        DecimatorDeinit(dec);
+        return false;
+    }
+    return true;
+}
+
+uint16_t DecimatorProcess(decimator_t * dec, const float * input, float * output, uint16_t input_lenght){
+    uint8_t factor = dec->fir.decim;
+    uint16_t used = 0;
+    uint16_t out = 0;
+    // Complete the block left from the previous call
+    if(dec->n_pending > 0){
+        used = factor - dec->n_pending;
+        if(input_lenght < used){
+            memcpy(&dec->pending[dec->n_pending], input, input_lenght * sizeof(float));
+            dec->n_pending += input_lenght;
+            return 0;
+        }
+        memcpy(&dec->pending[dec->n_pending], input, used * sizeof(float));
+        out = dsps_fird_f32(&dec->fir, dec->pending, output, 1);
+        dec->n_pending = 0;
+    }
+    uint16_t blocks = (input_lenght - used) / factor;
+    out += dsps_fird_f32(&dec->fir, &input[used], &output[out], blocks);
+    used += blocks * factor;
+    dec->n_pending = input_lenght - used;
+    memcpy(dec->pending, &input[used], dec->n_pending * sizeof(float));
+    return out;
+}
+
+void DecimatorReset(decimator_t * dec){
+    memset(dec->fir.delay, 0, dec->fir.N * sizeof(float));
+    dec->fir.pos = 0;
+    dec->n_pending = 0;
+}
+
+void DecimatorDeinit(decimator_t * dec){
+    free(dec->coeffs);
+    free(dec->delay);
+    memset(dec, 0, sizeof(decimator_t));
+}
+
+bool DecimatorInitQ15(decimator_q15_t * dec, uint8_t factor, uint16_t taps, fft_window_t window){
+    memset(dec, 0, sizeof(decimator_q15_t));
+    if((factor < 2) || (factor > RESAMPLE_MAX_FACTOR) || (taps < MIN_TAPS) || (taps > INT16_MAX)){
+        ESP_LOGE(TAG, "Invalid decimator parameters");
+        return false;
+    }
+    float *h = malloc(taps * sizeof(float));
+    dec->coeffs = malloc(taps * sizeof(int16_t));
+    dec->delay = malloc(taps * sizeof(int16_t));
+    if((h == NULL) || (dec->coeffs == NULL) || (dec->delay == NULL)){
+        free(h);
+        DecimatorDeinitQ15(dec);
+        return false;
+    }
+    DesignLowPass(h, taps, 0.5 / factor, 1, window);
+    for(uint16_t i=0; i<taps; i++){
+        float q = roundf(h[i] * 32768);
+        dec->coeffs[i] = (q > INT16_MAX) ? INT16_MAX : ((q < INT16_MIN) ? INT16_MIN : q);
+    }
+    free(h);
+    if(dsps_fird_init_s16(&dec->fir, dec->coeffs, dec->delay, taps, factor, 0, 0) != ESP_OK){
+        DecimatorDeinitQ15(dec);
+        return false;
+    }
+    return true;
+}
+
+uint16_t DecimatorProcessQ15(decimator_q15_t * dec, const int16_t * input, int16_t * output, uint16_t input_lenght){
+    uint8_t factor = dec->fir.decim;
+    uint16_t used = 0;
+    uint16_t out = 0;
+    // Complete the block left from the previous call
+    if(dec->n_pending > 0){
+        used = factor - dec->n_pending;
+        if(input_lenght < used){
+            memcpy(&dec->pending[dec->n_pending], input, input_lenght * sizeof(int16_t));
+            dec->n_pending += input_lenght;
+            return 0;
+        }
+        memcpy(&dec->pending[dec->n_pending], input, used * sizeof(int16_t));
+        out = dsps_fird_s16(&dec->fir, dec->pending, output, 1);
+        dec->n_pending = 0;
+    }
+    uint16_t blocks = (input_lenght - used) / factor;
+    out += dsps_fird_s16(&dec->fir, &input[used], &output[out], blocks);
+    used += blocks * factor;
+    dec->n_pending = input_lenght - used;
+    memcpy(dec->pending, &input[used], dec->n_pending * sizeof(int16_t));
+    return out;
+}
+
+void DecimatorResetQ15(decimator_q15_t * dec){
+    memset(dec->fir.delay, 0, dec->fir.coeffs_len * sizeof(int16_t));
+    dec->fir.pos = 0;
+    dec->fir.d_pos = 0;
+    dec->n_pending = 0;
+}
+
+void DecimatorDeinitQ15(decimator_q15_t * dec){
+    if(dec->coeffs != NULL){
+        dsps_fird_s16_aexx_free(&dec->fir);
+    }
+    free(dec->coeffs);
+    free(dec->delay);
+    memset(dec, 0, sizeof(decimator_q15_t));
+}
+
+bool ResamplerInit(resampler_t * rs, uint8_t up, uint8_t down, uint16_t taps, fft_window_t window){
+    memset(rs, 0, sizeof(resampler_t));
+    if((up == 0) || (up > RESAMPLE_MAX_FACTOR) || (down == 0) || (down > RESAMPLE_MAX_FACTOR) || (taps < MIN_TAPS) || (taps > UINT16_MAX / up)){
+        ESP_LOGE(TAG, "Invalid resampler parameters");
+        return false;
+    }
+    uint8_t gcd = GreatestCommonDivisor(up, down);
+    rs->up = up / gcd;
+    rs->down = down / gcd;
+    rs->taps = taps;
+    uint16_t lenght = rs->up * taps;
+    float *h = malloc(lenght * sizeof(float));
+    rs->coeffs = malloc(lenght * sizeof(float));
+    rs->history = calloc(2 * taps, sizeof(float));
+    if((h == NULL) || (rs->coeffs == NULL) || (rs->history == NULL)){
+        free(h);
+        ResamplerDeinit(rs);
+        return false;
+    }
+    // Prototype filter at up * input rate, gain up to compensate the inserted zeros
+    DesignLowPass(h, lenght, 0.5 / ((rs->up > rs->down) ? rs->up : rs->down), rs->up, window);
+    // Phase p uses h[p + k * up], stored in reverse to match the history order (oldest first)
+    for(uint8_t p=0; p<rs->up; p++){
+        for(uint16_t j=0; j<taps; j++){
+            rs->coeffs[p * taps + j] = h[p + (taps - 1 - j) * rs->up];
+        }
+    }
+    free(h);
+    return true;
+}
+
+uint16_t ResamplerProcess(resampler_t * rs, const float * input, float * output, uint16_t input_lenght){
+    uint16_t out = 0;
+    for(uint16_t i=0; i<input_lenght; i++){
+        // Each sample is stored twice, so the last taps samples are always contiguous
+        rs->history[rs->pos] = input[i];
+        rs->history[rs->pos + rs->taps] = input[i];
+        if(++rs->pos == rs->taps){
+            rs->pos = 0;
+        }
+        while(rs->phase < rs->up){
+            dsps_dotprod_f32(&rs->coeffs[rs->phase * rs->taps], &rs->history[rs->pos], &output[out++], rs->taps);
+            rs->phase += rs->down;
+        }
+        rs->phase -= rs->up;
+    }
+    return out;
+}
+
+void ResamplerReset(resampler_t * rs){
+    memset(rs->history, 0, 2 * rs->taps * sizeof(float));
+    rs->pos = 0;
+    rs->phase = 0;
+}
+
+void ResamplerDeinit(resampler_t * rs){
+    free(rs->coeffs);
+    free(rs->history);
+    memset(rs, 0, sizeof(resampler_t));
+}
+
+/*==================[end of file]============================================*/
@@ -9,6 +9,7 @@
  * |   Date	    | Description                                    |
  * |:----------:|:-----------------------------------------------|
  * | 12/09/2023 | Document creation		                         |
+ * | 16/10/2026 | Notificación con TimerNotifyFromISR()          |
  *
  * @author Albano Peñalva (albano.penalva@uner.edu.ar)
  *
@@ -33,14 +34,14 @@ TaskHandle_t led2_task_handle = NULL;
  * @brief Función invocada en la interrupción del timer A
  */
 void FuncTimerA(void* param){
-    vTaskNotifyGiveFromISR(led1_task_handle, pdFALSE);    /* Envía una notificación a la tarea asociada al LED_1 */
+    TimerNotifyFromISR(TIMER_A, led1_task_handle);    /* Envía una notificación a la tarea asociada al LED_1 */
 }
 
 /**
  * @brief Función invocada en la interrupción del timer B
  */
 void FuncTimerB(void* param){
-    vTaskNotifyGiveFromISR(led2_task_handle, pdFALSE);    /* Envía una notificación a la tarea asociada al LED_2 */
+    TimerNotifyFromISR(TIMER_B, led2_task_handle);    /* Envía una notificación a la tarea asociada al LED_2 */
 }
 
 /**
@@ -49,6 +50,7 @@ void FuncTimerB(void* param){
 static void Led1Task(void *pvParameter){
     while(true){
         ulTaskNotifyTake(pdTRUE, portMAX_DELAY);    /* La tarea espera en este punto hasta recibir una notificación */
+        TimerTaskWoken(TIMER_A);                     /* Registra la latencia del despertar (TIMER_INSTRUMENTATION) */
         printf("LED_1 Toggle\n");
         LedToggle(LED_1);
     }
@@ -60,6 +62,7 @@ static void Led1Task(void *pvParameter){
 static void Led2Task(void *pvParameter){
     while(true){
         ulTaskNotifyTake(pdTRUE, portMAX_DELAY);    /* La tarea espera en este punto hasta recibir una notificación */
+        TimerTaskWoken(TIMER_B);                     /* Registra la latencia del despertar (TIMER_INSTRUMENTATION) */
         printf("LED_2 Toggle\n");
         LedToggle(LED_2);
     }
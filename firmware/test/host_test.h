@@ -0,0 +1,42 @@
+/**
+ * @file host_test.h
+ * @brief Minimal checks and timing for the host tests
+ */
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+
+static int host_test_failures = 0;
+
+/** @brief Check a condition, the test continues and fails at the end */
+#define CHECK(cond) do {														\
+		if(!(cond)){															\
+			fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);	\
+			host_test_failures++;												\
+		}																		\
+	} while(0)
+
+/** @brief Check that two values are within tol */
+#define CHECK_NEAR(a, b, tol) do {												\
+		double a_ = (a), b_ = (b);												\
+		if(!((a_ - b_ <= (tol)) && (b_ - a_ <= (tol)))){						\
+			fprintf(stderr, "%s:%d: check failed: %s = %g, %s = %g (tol %g)\n",	\
+				__FILE__, __LINE__, #a, a_, #b, b_, (double)(tol));				\
+			host_test_failures++;												\
+		}																		\
+	} while(0)
+
+/** @brief Result of the test (return it from main) */
+#define TEST_RESULT()	(host_test_failures ? (fprintf(stderr, "%d checks failed\n", host_test_failures), 1) : 0)
+
+/** @brief Monotonic time (ns), for the benchmarks */
+static inline uint64_t HostTimeNs(void){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+#endif /* HOST_TEST_H */
@@ -0,0 +1,23 @@
+/* Host stand-in for driver/sdm.h */
+#ifndef HOST_SDM_H
+#define HOST_SDM_H
+#include <stdint.h>
+#include "esp_attr.h"
+#include "esp_err.h"
+
+typedef struct host_sdm *sdm_channel_handle_t;
+
+typedef enum {
+	SDM_CLK_SRC_DEFAULT,
+} sdm_clock_source_t;
+
+typedef struct {
+	int gpio_num;
+	sdm_clock_source_t clk_src;
+	uint32_t sample_rate_hz;
+} sdm_config_t;
+
+esp_err_t sdm_new_channel(const sdm_config_t *config, sdm_channel_handle_t *ret_chan);
+esp_err_t sdm_channel_enable(sdm_channel_handle_t chan);
+esp_err_t sdm_channel_set_pulse_density(sdm_channel_handle_t chan, int8_t density);
+#endif
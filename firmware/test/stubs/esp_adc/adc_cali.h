@@ -0,0 +1,9 @@
+/* Host stand-in for esp_adc/adc_cali.h */
+#ifndef HOST_ADC_CALI_H
+#define HOST_ADC_CALI_H
+#include "hal/adc_types.h"
+
+typedef struct host_adc_cali *adc_cali_handle_t;
+
+esp_err_t adc_cali_raw_to_voltage(adc_cali_handle_t handle, int raw, int *voltage);
+#endif
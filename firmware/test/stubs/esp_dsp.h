@@ -0,0 +1,19 @@
+/**
+ * @file esp_dsp.h
+ * @brief Host replacement of esp_dsp.h: the C modules used by the middelware
+ *
+ * The esp-dsp umbrella header also pulls the C++ matrix classes, which can not
+ * be included from C sources on the host.
+ */
+#ifndef HOST_ESP_DSP_H
+#define HOST_ESP_DSP_H
+#include "dsp_common.h"
+#include "dsp_types.h"
+#include "dsps_dotprod.h"
+#include "dsps_math.h"
+#include "dsps_fir.h"
+#include "dsps_biquad.h"
+#include "dsps_biquad_gen.h"
+#include "dsps_wind.h"
+#include "dsps_fft2r.h"
+#endif
@@ -0,0 +1,6 @@
+/* Host stand-in for esp_idf_version.h */
+#ifndef HOST_ESP_IDF_VERSION_H
+#define HOST_ESP_IDF_VERSION_H
+#define ESP_IDF_VERSION_VAL(major, minor, patch)	(((major) << 16) | ((minor) << 8) | (patch))
+#define ESP_IDF_VERSION		ESP_IDF_VERSION_VAL(5, 1, 0)
+#endif
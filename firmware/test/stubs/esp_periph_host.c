@@ -0,0 +1,367 @@
+/**
+ * @file esp_periph_host.c
+ * @brief Host implementation of the ESP-IDF peripheral drivers used by the firmware
+ *
+ * gptimer, continuous and oneshot ADC, ADC calibration, SDM, UART and esp_timer. The
+ * peripherals are driven by the tests through host_periph.h.
+ */
+
+/*==================[inclusions]=============================================*/
+#include "host_periph.h"
+#include "esp_timer.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+/*==================[macros and definitions]=================================*/
+#define NOMINAL_FULL_SCALE_MV	3300
+#define NOMINAL_MAX_CODE		4095
+
+struct host_adc_oneshot {
+	adc_oneshot_chan_cfg_t config[SOC_ADC_MAX_CHANNEL_NUM];
+};
+
+struct host_adc_cali {
+	adc_channel_t chan;
+};
+/*==================[internal data declaration]==============================*/
+static struct host_gptimer *gptimers[HOST_GPTIMER_MAX];
+static uint8_t gptimer_count = 0;
+static struct host_adc_continuous *adc_cont = NULL;
+static int adc_oneshot_raw[SOC_ADC_MAX_CHANNEL_NUM];
+static struct host_sdm *sdm = NULL;
+static void (*sdm_sink)(int8_t density) = NULL;
+static _Atomic int64_t time_us = 0;
+static uint8_t uart_tx[UART_NUM_MAX][HOST_UART_TX_MAX];
+static uint32_t uart_tx_lenght[UART_NUM_MAX];
+/*==================[internal functions definition]==========================*/
+static int NominalCurve(adc_channel_t chan, int raw){
+	return (raw * NOMINAL_FULL_SCALE_MV) / NOMINAL_MAX_CODE;
+}
+
+static int (*cali_curve)(adc_channel_t chan, int raw) = NominalCurve;
+static uint32_t cali_schemes = 0;
+/*==================[external functions definition]==========================*/
+
+/* gptimer */
+esp_err_t gptimer_new_timer(const gptimer_config_t *config, gptimer_handle_t *ret_timer){
+	if(gptimer_count == HOST_GPTIMER_MAX){
+		return ESP_ERR_NOT_FOUND;
+	}
+	struct host_gptimer *timer = calloc(1, sizeof(struct host_gptimer));
+	timer->config = *config;
+	gptimers[gptimer_count++] = timer;
+	*ret_timer = timer;
+	return ESP_OK;
+}
+
+esp_err_t gptimer_del_timer(gptimer_handle_t timer){
+	for(uint8_t i=0; i<gptimer_count; i++){
+		if(gptimers[i] == timer){
+			gptimers[i] = NULL;
+		}
+	}
+	free(timer);
+	return ESP_OK;
+}
+
+esp_err_t gptimer_set_raw_count(gptimer_handle_t timer, uint64_t value){
+	timer->count = value;
+	return ESP_OK;
+}
+
+esp_err_t gptimer_get_raw_count(gptimer_handle_t timer, uint64_t *value){
+	*value = timer->count;
+	return ESP_OK;
+}
+
+esp_err_t gptimer_register_event_callbacks(gptimer_handle_t timer, const gptimer_event_callbacks_t *cbs, void *user_data){
+	if(timer->enabled){
+		return ESP_ERR_INVALID_STATE;
+	}
+	timer->cbs = *cbs;
+	timer->user_data = user_data;
+	return ESP_OK;
+}
+
+esp_err_t gptimer_set_alarm_action(gptimer_handle_t timer, const gptimer_alarm_config_t *config){
+	timer->alarm = *config;
+	return ESP_OK;
+}
+
+esp_err_t gptimer_enable(gptimer_handle_t timer){
+	if(timer->enabled){
+		return ESP_ERR_INVALID_STATE;
+	}
+	timer->enabled = true;
+	return ESP_OK;
+}
+
+esp_err_t gptimer_disable(gptimer_handle_t timer){
+	if(!timer->enabled || timer->running){
+		return ESP_ERR_INVALID_STATE;
+	}
+	timer->enabled = false;
+	return ESP_OK;
+}
+
+esp_err_t gptimer_start(gptimer_handle_t timer){
+	if(!timer->enabled || timer->running){
+		return ESP_ERR_INVALID_STATE;
+	}
+	timer->running = true;
+	return ESP_OK;
+}
+
+esp_err_t gptimer_stop(gptimer_handle_t timer){
+	if(!timer->enabled || !timer->running){
+		return ESP_ERR_INVALID_STATE;
+	}
+	timer->running = false;
+	return ESP_OK;
+}
+
+gptimer_handle_t HostGptimer(uint8_t index){
+	return (index < gptimer_count) ? gptimers[index] : NULL;
+}
+
+bool HostGptimerAlarm(gptimer_handle_t timer){
+	bool yield = false;
+	if(!timer->running){
+		return false;
+	}
+	timer->count = timer->alarm.alarm_count;
+	gptimer_alarm_event_data_t edata = {
+		.count_value = timer->count,
+		.alarm_value = timer->alarm.alarm_count,
+	};
+	if(timer->alarm.flags.auto_reload_on_alarm){
+		timer->count = timer->alarm.reload_count;
+	}
+	if(timer->cbs.on_alarm != NULL){
+		yield = timer->cbs.on_alarm(timer, &edata, timer->user_data);
+	}
+	return yield;
+}
+
+/* Continuous ADC */
+esp_err_t adc_continuous_new_handle(const adc_continuous_handle_cfg_t *hdl_config, adc_continuous_handle_t *ret_handle){
+	if(adc_cont != NULL){
+		return ESP_ERR_INVALID_STATE;		// only one handle, as in ESP-IDF
+	}
+	adc_cont = calloc(1, sizeof(struct host_adc_continuous));
+	adc_cont->handle_config = *hdl_config;
+	*ret_handle = adc_cont;
+	return ESP_OK;
+}
+
+esp_err_t adc_continuous_config(adc_continuous_handle_t handle, const adc_continuous_config_t *config){
+	if(handle->running || (config->pattern_num == 0) || (config->pattern_num > SOC_ADC_MAX_CHANNEL_NUM) ||
+	   (config->sample_freq_hz < SOC_ADC_SAMPLE_FREQ_THRES_LOW) || (config->sample_freq_hz > SOC_ADC_SAMPLE_FREQ_THRES_HIGH)){
+		return ESP_ERR_INVALID_ARG;
+	}
+	handle->config = *config;
+	memcpy(handle->pattern, config->adc_pattern, config->pattern_num * sizeof(adc_digi_pattern_config_t));
+	handle->config.adc_pattern = handle->pattern;
+	return ESP_OK;
+}
+
+esp_err_t adc_continuous_register_event_callbacks(adc_continuous_handle_t handle, const adc_continuous_evt_cbs_t *cbs, void *user_data){
+	handle->cbs = *cbs;
+	handle->user_data = user_data;
+	return ESP_OK;
+}
+
+esp_err_t adc_continuous_start(adc_continuous_handle_t handle){
+	if(handle->running || (handle->config.pattern_num == 0)){
+		return ESP_ERR_INVALID_STATE;
+	}
+	handle->running = true;
+	return ESP_OK;
+}
+
+esp_err_t adc_continuous_stop(adc_continuous_handle_t handle){
+	if(!handle->running){
+		return ESP_ERR_INVALID_STATE;
+	}
+	handle->running = false;
+	return ESP_OK;
+}
+
+esp_err_t adc_continuous_deinit(adc_continuous_handle_t handle){
+	if(handle->running){
+		return ESP_ERR_INVALID_STATE;
+	}
+	if(handle == adc_cont){
+		adc_cont = NULL;
+	}
+	free(handle);
+	return ESP_OK;
+}
+
+adc_continuous_handle_t HostAdcContinuous(void){
+	return adc_cont;
+}
+
+bool HostAdcContinuousFrame(const adc_digi_output_data_t *data, uint32_t n){
+	if((adc_cont == NULL) || !adc_cont->running || (adc_cont->cbs.on_conv_done == NULL)){
+		return false;
+	}
+	adc_continuous_evt_data_t edata = {
+		.conv_frame_buffer = (uint8_t *)data,
+		.size = n * SOC_ADC_DIGI_RESULT_BYTES,
+	};
+	return adc_cont->cbs.on_conv_done(adc_cont, &edata, adc_cont->user_data);
+}
+
+/* Oneshot ADC */
+esp_err_t adc_oneshot_new_unit(const adc_oneshot_unit_init_cfg_t *init_config, adc_oneshot_unit_handle_t *ret_unit){
+	*ret_unit = calloc(1, sizeof(struct host_adc_oneshot));
+	return ESP_OK;
+}
+
+esp_err_t adc_oneshot_config_channel(adc_oneshot_unit_handle_t handle, adc_channel_t channel, const adc_oneshot_chan_cfg_t *config){
+	if(channel >= SOC_ADC_MAX_CHANNEL_NUM){
+		return ESP_ERR_INVALID_ARG;
+	}
+	handle->config[channel] = *config;
+	return ESP_OK;
+}
+
+esp_err_t adc_oneshot_read(adc_oneshot_unit_handle_t handle, adc_channel_t chan, int *out_raw){
+	if(chan >= SOC_ADC_MAX_CHANNEL_NUM){
+		return ESP_ERR_INVALID_ARG;
+	}
+	*out_raw = adc_oneshot_raw[chan];
+	return ESP_OK;
+}
+
+void HostAdcOneshotSet(adc_channel_t chan, int raw){
+	adc_oneshot_raw[chan] = raw;
+}
+
+/* ADC calibration */
+esp_err_t adc_cali_create_scheme_curve_fitting(const adc_cali_curve_fitting_config_t *config, adc_cali_handle_t *ret_handle){
+	if(cali_curve == NULL){
+		return ESP_ERR_NOT_SUPPORTED;		// eFuse not burnt
+	}
+	*ret_handle = calloc(1, sizeof(struct host_adc_cali));
+	(*ret_handle)->chan = config->chan;
+	cali_schemes++;
+	return ESP_OK;
+}
+
+esp_err_t adc_cali_raw_to_voltage(adc_cali_handle_t handle, int raw, int *voltage){
+	if((handle == NULL) || (cali_curve == NULL)){
+		return ESP_ERR_INVALID_ARG;
+	}
+	*voltage = cali_curve(handle->chan, raw);
+	return ESP_OK;
+}
+
+void HostAdcCaliCurve(int (*curve)(adc_channel_t chan, int raw)){
+	cali_curve = curve;
+}
+
+uint32_t HostAdcCaliSchemes(void){
+	return cali_schemes;
+}
+
+/* SDM */
+esp_err_t sdm_new_channel(const sdm_config_t *config, sdm_channel_handle_t *ret_chan){
+	sdm = calloc(1, sizeof(struct host_sdm));
+	sdm->config = *config;
+	*ret_chan = sdm;
+	return ESP_OK;
+}
+
+esp_err_t sdm_channel_enable(sdm_channel_handle_t chan){
+	chan->enabled = true;
+	return ESP_OK;
+}
+
+esp_err_t sdm_channel_set_pulse_density(sdm_channel_handle_t chan, int8_t density){
+	if(chan == NULL){
+		return ESP_ERR_INVALID_ARG;
+	}
+	chan->density = density;
+	if(sdm_sink != NULL){
+		sdm_sink(density);
+	}
+	return ESP_OK;
+}
+
+void HostSdmSink(void (*sink)(int8_t density)){
+	sdm_sink = sink;
+}
+
+sdm_channel_handle_t HostSdm(void){
+	return sdm;
+}
+
+/* esp_timer */
+int64_t esp_timer_get_time(void){
+	return atomic_load(&time_us);
+}
+
+void HostTimeAdvanceUs(int64_t us){
+	atomic_fetch_add(&time_us, us);
+}
+
+/* UART: transmitted bytes are captured, nothing is received */
+esp_err_t uart_driver_install(uart_port_t uart_num, int rx_buffer_size, int tx_buffer_size, int queue_size, QueueHandle_t *uart_queue, int intr_alloc_flags){
+	if(uart_queue != NULL){
+		*uart_queue = xQueueCreate(queue_size, sizeof(uart_event_t));
+	}
+	return ESP_OK;
+}
+
+esp_err_t uart_param_config(uart_port_t uart_num, const uart_config_t *uart_config){
+	return ESP_OK;
+}
+
+esp_err_t uart_set_pin(uart_port_t uart_num, int tx_io_num, int rx_io_num, int rts_io_num, int cts_io_num){
+	return ESP_OK;
+}
+
+esp_err_t uart_flush_input(uart_port_t uart_num){
+	return ESP_OK;
+}
+
+int uart_read_bytes(uart_port_t uart_num, void *buf, uint32_t length, TickType_t ticks_to_wait){
+	return 0;
+}
+
+int uart_write_bytes(uart_port_t uart_num, const void *src, size_t size){
+	taskENTER_CRITICAL(NULL);
+	uint32_t n = HOST_UART_TX_MAX - uart_tx_lenght[uart_num];
+	if(n > size){
+		n = size;
+	}
+	memcpy(&uart_tx[uart_num][uart_tx_lenght[uart_num]], src, n);
+	uart_tx_lenght[uart_num] += n;
+	taskEXIT_CRITICAL(NULL);
+	return size;
+}
+
+esp_err_t uart_enable_pattern_det_baud_intr(uart_port_t uart_num, char pattern_chr, uint8_t chr_num, int chr_tout, int post_idle, int pre_idle){
+	return ESP_OK;
+}
+
+int uart_pattern_pop_pos(uart_port_t uart_num){
+	return -1;
+}
+
+esp_err_t uart_pattern_queue_reset(uart_port_t uart_num, int queue_length){
+	return ESP_OK;
+}
+
+const uint8_t * HostUartTx(uart_port_t uart_num, uint32_t *lenght){
+	*lenght = uart_tx_lenght[uart_num];
+	return uart_tx[uart_num];
+}
+
+void HostUartTxClear(uart_port_t uart_num){
+	uart_tx_lenght[uart_num] = 0;
+}
+
+/*==================[end of file]============================================*/
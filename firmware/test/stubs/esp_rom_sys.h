@@ -0,0 +1,6 @@
+/* Host stand-in for esp_rom_sys.h (esp_rom_delay_us() is provided by the test) */
+#ifndef HOST_ESP_ROM_SYS_H
+#define HOST_ESP_ROM_SYS_H
+#include <stdint.h>
+void esp_rom_delay_us(uint32_t us);
+#endif
@@ -0,0 +1,7 @@
+/* Host stand-in for esp_timer.h (virtual time, see host_periph.h) */
+#ifndef HOST_ESP_TIMER_H
+#define HOST_ESP_TIMER_H
+#include <stdint.h>
+
+int64_t esp_timer_get_time(void);
+#endif
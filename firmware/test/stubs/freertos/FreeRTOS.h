@@ -0,0 +1,86 @@
+/**
+ * @file FreeRTOS.h
+ * @brief Host (Linux) stand-in for the FreeRTOS API used by the drivers and middelware
+ *
+ * Tasks are pthreads, notifications and queues use a mutex and a condition
+ * variable, and critical sections take one global recursive mutex. Only the
+ * calls used by this repository are provided.
+ */
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_attr.h"		/* IRAM_ATTR, included by the port layer in ESP-IDF */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef int32_t BaseType_t;
+typedef uint32_t UBaseType_t;
+typedef uint32_t TickType_t;
+typedef struct host_task *TaskHandle_t;
+typedef struct host_queue *QueueHandle_t;
+typedef struct host_queue *SemaphoreHandle_t;
+typedef struct { uint8_t dummy; } StaticSemaphore_t;
+typedef int portMUX_TYPE;
+
+#define pdTRUE					((BaseType_t)1)
+#define pdFALSE					((BaseType_t)0)
+#define pdPASS					pdTRUE
+#define pdFAIL					pdFALSE
+#define portMAX_DELAY			((TickType_t)0xFFFFFFFF)
+#define configTICK_RATE_HZ		1000
+#define configMAX_PRIORITIES	25
+#define portTICK_PERIOD_MS		(1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms)		((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000))
+#define portMUX_INITIALIZER_UNLOCKED	0
+
+void HostEnterCritical(void);
+void HostExitCritical(void);
+#define portENTER_CRITICAL(mux)			((void)(mux), HostEnterCritical())
+#define portEXIT_CRITICAL(mux)			((void)(mux), HostExitCritical())
+#define portENTER_CRITICAL_ISR(mux)		portENTER_CRITICAL(mux)
+#define portEXIT_CRITICAL_ISR(mux)		portEXIT_CRITICAL(mux)
+#define portENTER_CRITICAL_SAFE(mux)	portENTER_CRITICAL(mux)
+#define portEXIT_CRITICAL_SAFE(mux)		portEXIT_CRITICAL(mux)
+#define taskENTER_CRITICAL(mux)			portENTER_CRITICAL(mux)
+#define taskEXIT_CRITICAL(mux)			portEXIT_CRITICAL(mux)
+
+/* Tasks */
+BaseType_t xTaskCreate(void (*func)(void *), const char *name, uint32_t stack, void *param, UBaseType_t priority, TaskHandle_t *handle);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+TickType_t xTaskGetTickCount(void);
+void vTaskDelay(TickType_t ticks);
+void taskYIELD(void);
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *task_woken);
+void xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t timeout);
+
+/* Queues */
+QueueHandle_t xQueueCreate(UBaseType_t lenght, UBaseType_t item_size);
+void vQueueDelete(QueueHandle_t queue);
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t timeout);
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void *item, BaseType_t *task_woken);
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t timeout);
+BaseType_t xQueuePeek(QueueHandle_t queue, void *item, TickType_t timeout);
+BaseType_t xQueueReset(QueueHandle_t queue);
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+
+/* Semaphores (mutexes, binary and counting) */
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t *storage);
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t *storage);
+SemaphoreHandle_t xSemaphoreCreateCountingStatic(UBaseType_t max, UBaseType_t initial, StaticSemaphore_t *storage);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t timeout);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem);
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t *task_woken);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_FREERTOS_H */
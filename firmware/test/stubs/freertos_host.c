@@ -0,0 +1,305 @@
+/**
+ * @file freertos_host.c
+ * @brief Host (Linux) implementation of the FreeRTOS calls used by the firmware
+ */
+
+/*==================[inclusions]=============================================*/
+#include "freertos/FreeRTOS.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+/*==================[macros and definitions]=================================*/
+struct host_task {
+	pthread_t thread;
+	void (*func)(void *);
+	void *param;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	uint32_t notifications;
+	bool waiting;					/* blocked in ulTaskNotifyTake() */
+};
+
+struct host_queue {
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	uint8_t *items;
+	uint32_t item_size;
+	uint32_t lenght;
+	uint32_t head;
+	uint32_t count;
+};
+/*==================[internal data declaration]==============================*/
+static pthread_mutex_t critical_lock;
+static pthread_once_t critical_once = PTHREAD_ONCE_INIT;
+static __thread struct host_task *current_task = NULL;
+/*==================[internal functions definition]==========================*/
+static void CriticalInit(void){
+	pthread_mutexattr_t attr;
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(&critical_lock, &attr);
+}
+
+static struct host_task * TaskNew(void){
+	struct host_task *task = calloc(1, sizeof(struct host_task));
+	pthread_mutex_init(&task->lock, NULL);
+	pthread_cond_init(&task->cond, NULL);
+	return task;
+}
+
+static void * TaskEntry(void *arg){
+	current_task = arg;
+	current_task->func(current_task->param);
+	return NULL;
+}
+
+/**
+ * @brief Absolute time of a timeout in ticks (1 tick = 1 ms), NULL for portMAX_DELAY
+ */
+static struct timespec * Deadline(struct timespec *ts, TickType_t timeout){
+	if(timeout == portMAX_DELAY){
+		return NULL;
+	}
+	clock_gettime(CLOCK_REALTIME, ts);
+	uint64_t ns = ts->tv_nsec + (uint64_t)timeout * (1000000000ULL / configTICK_RATE_HZ);
+	ts->tv_sec += ns / 1000000000ULL;
+	ts->tv_nsec = ns % 1000000000ULL;
+	return ts;
+}
+
+/**
+ * @brief Wait on a condition variable until the deadline (true: signalled, false: timeout)
+ */
+static bool Wait(pthread_cond_t *cond, pthread_mutex_t *lock, const struct timespec *deadline){
+	if(deadline == NULL){
+		pthread_cond_wait(cond, lock);
+		return true;
+	}
+	return pthread_cond_timedwait(cond, lock, deadline) != ETIMEDOUT;
+}
+/*==================[external functions definition]==========================*/
+void HostEnterCritical(void){
+	pthread_once(&critical_once, CriticalInit);
+	pthread_mutex_lock(&critical_lock);
+}
+
+void HostExitCritical(void){
+	pthread_mutex_unlock(&critical_lock);
+}
+
+BaseType_t xTaskCreate(void (*func)(void *), const char *name, uint32_t stack, void *param, UBaseType_t priority, TaskHandle_t *handle){
+	struct host_task *task = TaskNew();
+	task->func = func;
+	task->param = param;
+	if(pthread_create(&task->thread, NULL, TaskEntry, task) != 0){
+		free(task);
+		return pdFAIL;
+	}
+	pthread_detach(task->thread);
+	if(handle != NULL){
+		*handle = task;
+	}
+	return pdPASS;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void){
+	if(current_task == NULL){
+		// main thread, or a thread not created with xTaskCreate()
+		current_task = TaskNew();
+		current_task->thread = pthread_self();
+	}
+	return current_task;
+}
+
+TickType_t xTaskGetTickCount(void){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (TickType_t)(ts.tv_sec * configTICK_RATE_HZ + ts.tv_nsec / (1000000000L / configTICK_RATE_HZ));
+}
+
+void vTaskDelay(TickType_t ticks){
+	struct timespec ts = {
+		.tv_sec = ticks / configTICK_RATE_HZ,
+		.tv_nsec = (ticks % configTICK_RATE_HZ) * (1000000000L / configTICK_RATE_HZ),
+	};
+	nanosleep(&ts, NULL);
+}
+
+void taskYIELD(void){
+	sched_yield();
+}
+
+void xTaskNotifyGive(TaskHandle_t task){
+	pthread_mutex_lock(&task->lock);
+	task->notifications++;
+	pthread_cond_signal(&task->cond);
+	pthread_mutex_unlock(&task->lock);
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *task_woken){
+	// there are no priorities: a task blocked on the notification asks for a yield
+	pthread_mutex_lock(&task->lock);
+	bool waiting = task->waiting;
+	task->notifications++;
+	pthread_cond_signal(&task->cond);
+	pthread_mutex_unlock(&task->lock);
+	if(waiting && (task_woken != NULL)){
+		*task_woken = pdTRUE;
+	}
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t timeout){
+	struct host_task *task = xTaskGetCurrentTaskHandle();
+	struct timespec ts;
+	const struct timespec *deadline = Deadline(&ts, timeout);
+	uint32_t value;
+	pthread_mutex_lock(&task->lock);
+	task->waiting = true;
+	while((task->notifications == 0) && (timeout != 0) && Wait(&task->cond, &task->lock, deadline));
+	task->waiting = false;
+	value = task->notifications;
+	if(value > 0){
+		task->notifications = clear ? 0 : value - 1;
+	}
+	pthread_mutex_unlock(&task->lock);
+	return value;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t lenght, UBaseType_t item_size){
+	struct host_queue *queue = calloc(1, sizeof(struct host_queue));
+	pthread_mutex_init(&queue->lock, NULL);
+	pthread_cond_init(&queue->cond, NULL);
+	queue->items = calloc(lenght, item_size ? item_size : 1);
+	queue->item_size = item_size;
+	queue->lenght = lenght;
+	return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue){
+	free(queue->items);
+	free(queue);
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t timeout){
+	struct timespec ts;
+	const struct timespec *deadline = Deadline(&ts, timeout);
+	BaseType_t sent = pdFALSE;
+	pthread_mutex_lock(&queue->lock);
+	while((queue->count == queue->lenght) && (timeout != 0) && Wait(&queue->cond, &queue->lock, deadline));
+	if(queue->count < queue->lenght){
+		if(queue->item_size > 0){
+			memcpy(&queue->items[((queue->head + queue->count) % queue->lenght) * queue->item_size], item, queue->item_size);
+		}
+		queue->count++;
+		pthread_cond_broadcast(&queue->cond);
+		sent = pdTRUE;
+	}
+	pthread_mutex_unlock(&queue->lock);
+	return sent;
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void *item, BaseType_t *task_woken){
+	BaseType_t sent = xQueueSend(queue, item, 0);
+	if(sent && (task_woken != NULL)){
+		*task_woken = pdTRUE;
+	}
+	return sent;
+}
+
+static BaseType_t QueueGet(QueueHandle_t queue, void *item, TickType_t timeout, bool remove){
+	struct timespec ts;
+	const struct timespec *deadline = Deadline(&ts, timeout);
+	BaseType_t received = pdFALSE;
+	pthread_mutex_lock(&queue->lock);
+	while((queue->count == 0) && (timeout != 0) && Wait(&queue->cond, &queue->lock, deadline));
+	if(queue->count > 0){
+		if((item != NULL) && (queue->item_size > 0)){
+			memcpy(item, &queue->items[queue->head * queue->item_size], queue->item_size);
+		}
+		if(remove){
+			queue->head = (queue->head + 1) % queue->lenght;
+			queue->count--;
+			pthread_cond_broadcast(&queue->cond);
+		}
+		received = pdTRUE;
+	}
+	pthread_mutex_unlock(&queue->lock);
+	return received;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t timeout){
+	return QueueGet(queue, item, timeout, true);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t queue, void *item, TickType_t timeout){
+	return QueueGet(queue, item, timeout, false);
+}
+
+BaseType_t xQueueReset(QueueHandle_t queue){
+	pthread_mutex_lock(&queue->lock);
+	queue->head = 0;
+	queue->count = 0;
+	pthread_cond_broadcast(&queue->cond);
+	pthread_mutex_unlock(&queue->lock);
+	return pdPASS;
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue){
+	pthread_mutex_lock(&queue->lock);
+	UBaseType_t n = queue->lenght - queue->count;
+	pthread_mutex_unlock(&queue->lock);
+	return n;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue){
+	pthread_mutex_lock(&queue->lock);
+	UBaseType_t n = queue->count;
+	pthread_mutex_unlock(&queue->lock);
+	return n;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void){
+	// a mutex is a queue of one item that starts full
+	SemaphoreHandle_t sem = xQueueCreate(1, 0);
+	sem->count = 1;
+	return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t *storage){
+	(void)storage;
+	return xSemaphoreCreateMutex();
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t *storage){
+	(void)storage;
+	// a binary semaphore is a queue of one item that starts empty
+	return xQueueCreate(1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCountingStatic(UBaseType_t max, UBaseType_t initial, StaticSemaphore_t *storage){
+	(void)storage;
+	SemaphoreHandle_t sem = xQueueCreate(max, 0);
+	sem->count = initial;
+	return sem;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t timeout){
+	return xQueueReceive(sem, NULL, timeout);
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem){
+	return xQueueSend(sem, NULL, 0);
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t *task_woken){
+	return xQueueSendFromISR(sem, NULL, task_woken);
+}
+
+uint32_t esp_cpu_get_cycle_count(void){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint32_t)(ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+}
@@ -0,0 +1,118 @@
+/**
+ * @file host_periph.h
+ * @brief Test side of the ESP-IDF peripheral stand-ins (esp_periph_host.c)
+ *
+ * There is no hardware behind the drivers: the tests fire the timer alarms,
+ * deliver the ADC DMA frames, set the ADC readings and calibration curve, read
+ * what was written to the SDM (DAC) and move the virtual esp_timer clock.
+ */
+#ifndef HOST_PERIPH_H
+#define HOST_PERIPH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "driver/gptimer.h"
+#include "driver/sdm.h"
+#include "esp_adc/adc_continuous.h"
+#include "esp_adc/adc_oneshot.h"
+#include "esp_adc/adc_cali_scheme.h"
+#include "driver/uart.h"
+
+#define HOST_GPTIMER_MAX	8		/* timers that can be created */
+#define HOST_UART_TX_MAX	65536	/* bytes captured on each UART */
+
+struct host_gptimer {
+	gptimer_config_t config;
+	gptimer_event_callbacks_t cbs;
+	void *user_data;
+	gptimer_alarm_config_t alarm;
+	uint64_t count;
+	bool enabled;
+	bool running;
+};
+
+struct host_adc_continuous {
+	adc_continuous_handle_cfg_t handle_config;
+	adc_continuous_config_t config;
+	adc_digi_pattern_config_t pattern[SOC_ADC_MAX_CHANNEL_NUM];
+	adc_continuous_evt_cbs_t cbs;
+	void *user_data;
+	bool running;
+};
+
+struct host_sdm {
+	sdm_config_t config;
+	bool enabled;
+	int8_t density;
+};
+
+/**
+ * @brief Timer created in the index-th call to gptimer_new_timer() (NULL if there is none)
+ */
+gptimer_handle_t HostGptimer(uint8_t index);
+
+/**
+ * @brief Alarm event: the count reaches the alarm, the callback runs and the count is reloaded
+ *
+ * @return true The callback returned true (a task has to be scheduled)
+ * @return false Timer stopped, no callback or the callback returned false
+ */
+bool HostGptimerAlarm(gptimer_handle_t timer);
+
+/**
+ * @brief Last continuous ADC handle created (NULL after adc_continuous_deinit())
+ */
+adc_continuous_handle_t HostAdcContinuous(void);
+
+/**
+ * @brief Deliver a DMA frame to the on_conv_done callback (only while started)
+ *
+ * @return true The callback returned true
+ */
+bool HostAdcContinuousFrame(const adc_digi_output_data_t *data, uint32_t n);
+
+/**
+ * @brief Value returned by adc_oneshot_read() for a channel
+ */
+void HostAdcOneshotSet(adc_channel_t chan, int raw);
+
+/**
+ * @brief Curve used by adc_cali_raw_to_voltage() (NULL: curve fitting not available)
+ *
+ * The default curve is the nominal one, raw * 3300 / 4095.
+ */
+void HostAdcCaliCurve(int (*curve)(adc_channel_t chan, int raw));
+
+/**
+ * @brief Number of calibration schemes created with adc_cali_create_scheme_curve_fitting()
+ */
+uint32_t HostAdcCaliSchemes(void);
+
+/**
+ * @brief Function called with every density written to the SDM channel (NULL to remove)
+ */
+void HostSdmSink(void (*sink)(int8_t density));
+
+/**
+ * @brief Last SDM channel created
+ */
+sdm_channel_handle_t HostSdm(void);
+
+/**
+ * @brief Move the virtual clock returned by esp_timer_get_time()
+ */
+void HostTimeAdvanceUs(int64_t us);
+
+/**
+ * @brief Bytes written to a UART since the last HostUartTxClear() (up to HOST_UART_TX_MAX)
+ *
+ * @param lenght Number of bytes captured
+ */
+const uint8_t * HostUartTx(uart_port_t uart_num, uint32_t *lenght);
+
+/**
+ * @brief Discard the bytes captured on a UART
+ */
+void HostUartTxClear(uart_port_t uart_num);
+
+#endif /* HOST_PERIPH_H */
@@ -0,0 +1,7 @@
+/* Host build configuration (ANSI esp-dsp kernels) */
+#ifndef HOST_SDKCONFIG_H
+#define HOST_SDKCONFIG_H
+#define CONFIG_DSP_MAX_FFT_SIZE		4096
+#define CONFIG_DSP_OPTIMIZED		0
+#define CONFIG_DSP_ANSI				1
+#endif
@@ -0,0 +1,9 @@
+/* Host stand-in for soc/soc_caps.h (ESP32-C6 values used by the drivers) */
+#ifndef HOST_SOC_CAPS_H
+#define HOST_SOC_CAPS_H
+#define SOC_ADC_MAX_CHANNEL_NUM			7
+#define SOC_ADC_DIGI_MAX_BITWIDTH		12
+#define SOC_ADC_DIGI_RESULT_BYTES		4
+#define SOC_ADC_SAMPLE_FREQ_THRES_HIGH	83333
+#define SOC_ADC_SAMPLE_FREQ_THRES_LOW	611
+#endif
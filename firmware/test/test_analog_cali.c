@@ -0,0 +1,121 @@
+/**
+ * @file test_analog_cali.c
+ * @brief Bulk raw to mV conversion: calibration tables against the calibration curve
+ */
+#include <math.h>
+#include "host_test.h"
+#include "host_periph.h"
+#include "analog_io_mcu.h"
+
+#define CODES		4096
+
+static uint16_t raw[CODES];
+static uint16_t mv[CODES];
+static float mv_float[CODES];
+
+/**
+ * @brief Curve fitting calibration of a typical chip at 12dB: gain, offset and curvature differ per channel
+ */
+static double Curve(int chan, double code){
+	return 8 + 3 * chan + code * (0.78 + 0.004 * chan) + 2.2e-5 * code * code - 3.5e-9 * code * code * code;
+}
+
+static int CurveInt(adc_channel_t chan, int code){
+	return lround(Curve(chan, code));
+}
+
+int main(void){
+	HostAdcCaliCurve(CurveInt);
+	for(int i=0; i<CODES; i++){
+		raw[i] = i;
+	}
+
+	/* single mode channel: every 12 bit code */
+	analog_input_config_t single = {.input = CH0, .mode = ADC_SINGLE};
+	AnalogInputInit(&single);
+	AnalogInputRawToMv(CH0, raw, mv, CODES);
+	AnalogInputRawToMvFloat(CH0, raw, mv_float, CODES);
+	double err = 0, err_float = 0;
+	for(int i=0; i<CODES; i++){
+		err = fmax(err, fabs(mv[i] - Curve(CH0, i)));
+		err_float = fmax(err_float, fabs(mv_float[i] - Curve(CH0, i)));
+	}
+	printf("CH0 max error: %.3f mV (uint16_t), %.3f mV (float)\n", err, err_float);
+	CHECK(err <= 1.0);
+	CHECK(err_float <= 1.0);
+	/* codes above full scale are clamped */
+	uint16_t over = 0xFFFF, over_mv;
+	AnalogInputRawToMv(CH0, &over, &over_mv, 1);
+	CHECK(labs(over_mv - lround(Curve(CH0, CODES - 1))) <= 1);
+
+	/* in place */
+	for(int i=0; i<CODES; i++){
+		mv[i] = i;
+	}
+	AnalogInputRawToMv(CH0, mv, mv, CODES);
+	for(int i=0; i<CODES; i++){
+		CHECK(fabs(mv[i] - Curve(CH0, i)) <= 1.0);
+	}
+
+	/* continuous mode with oversampling: 14 bit codes of the same curve */
+	analog_input_config_t cont = {.input = CH1, .mode = ADC_CONTINUOUS, .sample_frec = 1000, .oversampling = 2};
+	AnalogInputInit(&cont);
+	static uint16_t raw14[4 * CODES], mv14[4 * CODES];
+	for(int i=0; i<4 * CODES; i++){
+		raw14[i] = i;
+	}
+	AnalogInputRawToMv(CH1, raw14, mv14, 4 * CODES);
+	err = 0;
+	for(int i=0; i<4 * CODES; i++){
+		err = fmax(err, fabs(mv14[i] - Curve(CH1, i / 4.0)));
+	}
+	printf("CH1 (14 bits) max error: %.3f mV\n", err);
+	/* table and output rounding (0.5 mV each) plus the curvature between table points */
+	CHECK(err <= 1.1);
+
+	/* single mode on the same channel reuses its calibration: no new scheme, 12 bit codes again */
+	uint32_t schemes = HostAdcCaliSchemes();
+	single.input = CH1;
+	AnalogInputInit(&single);
+	CHECK(HostAdcCaliSchemes() == schemes);
+	AnalogInputRawToMv(CH1, raw, mv, CODES);
+	for(int i=0; i<CODES; i++){
+		CHECK(fabs(mv[i] - Curve(CH1, i)) <= 1.1);
+	}
+
+	/* without calibration (eFuse not burnt) the nominal conversion is used, in every mode */
+	static uint16_t buffer[512];
+	HostAdcCaliCurve(NULL);
+	single.input = CH3;
+	AnalogInputInit(&single);
+	AnalogInputRawToMv(CH3, raw, mv, CODES);
+	for(int i=0; i<CODES; i++){
+		CHECK(fabs(mv[i] - i * 3300.0 / 4095) <= 1.0);
+	}
+	analog_scan_config_t scan = {
+		.channels = {CH2},
+		.n_channels = 1,
+		.sample_frec = 1000,
+		.buffers = {buffer},
+		.buffer_lenght = 512,
+	};
+	CHECK(AnalogScanInit(&scan));
+	AnalogInputRawToMv(CH2, raw, mv, CODES);
+	for(int i=0; i<CODES; i++){
+		CHECK(fabs(mv[i] - i * 3300.0 / 4095) <= 1.0);
+	}
+
+	/* throughput */
+	uint64_t t0 = HostTimeNs();
+	for(int r=0; r<1000; r++){
+		AnalogInputRawToMv(CH0, raw, mv, CODES);
+	}
+	uint64_t t1 = HostTimeNs();
+	for(int r=0; r<1000; r++){
+		AnalogInputRawToMvFloat(CH0, raw, mv_float, CODES);
+	}
+	uint64_t t2 = HostTimeNs();
+	printf("ns per sample: AnalogInputRawToMv %.2f, AnalogInputRawToMvFloat %.2f\n",
+		(double)(t1 - t0) / 1000 / CODES, (double)(t2 - t1) / 1000 / CODES);
+	return TEST_RESULT();
+}
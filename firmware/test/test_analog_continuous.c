@@ -0,0 +1,306 @@
+/**
+ * @file test_analog_continuous.c
+ * @brief Continuous ADC mode and scan groups fed by simulated DMA frames
+ */
+#include <string.h>
+#include "host_test.h"
+#include "host_periph.h"
+#include "esp_timer.h"
+#include "analog_io_mcu.h"
+
+#define DMA_MAX		1024
+
+static adc_digi_output_data_t dma[DMA_MAX];
+static volatile int frames_done = 0;
+
+static void FrameDone(void *param){
+	(*(volatile int *)param)++;
+}
+
+static adc_digi_output_data_t Result(uint8_t channel, uint16_t value){
+	adc_digi_output_data_t r = {.val = 0};
+	r.type2.channel = channel;
+	r.type2.data = value;
+	return r;
+}
+
+/**
+ * @brief Deliver n samples of one channel, value k = first + k (12 bits)
+ */
+static void FeedRamp(uint8_t channel, uint16_t first, uint32_t n, uint32_t chunk){
+	for(uint32_t i=0; i<n; i+=chunk){
+		uint32_t len = (n - i < chunk) ? n - i : chunk;
+		for(uint32_t j=0; j<len; j++){
+			dma[j] = Result(channel, (first + i + j) & 0xFFF);
+		}
+		HostAdcContinuousFrame(dma, len);
+	}
+}
+
+static void TestSingleChannel(void){
+	uint16_t values[ADC_FRAME_SAMPLES];
+	analog_input_config_t config = {
+		.input = CH1,
+		.mode = ADC_CONTINUOUS,
+		.func_p = FrameDone,
+		.param_p = (void *)&frames_done,
+		.sample_frec = 20000,
+	};
+	AnalogInputInit(&config);
+	adc_continuous_handle_t adc = HostAdcContinuous();
+	CHECK(adc != NULL);
+	CHECK(config.sample_frec == 20000);
+	CHECK(adc->config.sample_freq_hz == 20000);
+	CHECK(adc->config.pattern_num == 1);
+	CHECK(adc->pattern[0].channel == CH1);
+	CHECK(adc->handle_config.conv_frame_size == ADC_FRAME_SAMPLES * SOC_ADC_DIGI_RESULT_BYTES);
+
+	/* nothing before start */
+	FeedRamp(CH1, 0, ADC_FRAME_SAMPLES, ADC_FRAME_SAMPLES);
+	CHECK(frames_done == 0);
+	CHECK(AnalogInputReadContinuous(CH1, values) == 0);
+
+	AnalogStartContinuous(CH1);
+	CHECK(adc->running);
+	/* one DMA frame: one callback, one frame read once */
+	FeedRamp(CH1, 0, ADC_FRAME_SAMPLES, ADC_FRAME_SAMPLES);
+	CHECK(frames_done == 1);
+	CHECK(AnalogInputReadContinuous(CH2, values) == 0);
+	CHECK(AnalogInputReadContinuous(CH1, values) == ADC_FRAME_SAMPLES);
+	for(int i=0; i<ADC_FRAME_SAMPLES; i++){
+		CHECK(values[i] == i);
+	}
+	CHECK(AnalogInputReadContinuous(CH1, values) == 0);
+
+	/* DMA frames shorter than a frame: callback only when a frame is complete */
+	FeedRamp(CH1, 1000, ADC_FRAME_SAMPLES, 100);
+	CHECK(frames_done == 2);
+	CHECK(AnalogInputReadContinuous(CH1, values) == ADC_FRAME_SAMPLES);
+	CHECK(values[0] == 1000 && values[ADC_FRAME_SAMPLES - 1] == 1000 + ADC_FRAME_SAMPLES - 1);
+
+	/* two frames without reading: the last complete one is returned */
+	FeedRamp(CH1, 2000, 2 * ADC_FRAME_SAMPLES, 64);
+	CHECK(frames_done == 4);
+	CHECK(AnalogInputReadContinuous(CH1, values) == ADC_FRAME_SAMPLES);
+	CHECK(values[0] == 2000 + ADC_FRAME_SAMPLES);
+
+	/* restart discards the partial frame */
+	FeedRamp(CH1, 0, ADC_FRAME_SAMPLES / 2, ADC_FRAME_SAMPLES);
+	AnalogStopContinuous(CH1);
+	CHECK(!adc->running);
+	AnalogStartContinuous(CH1);
+	FeedRamp(CH1, 3000, ADC_FRAME_SAMPLES, ADC_FRAME_SAMPLES);
+	CHECK(AnalogInputReadContinuous(CH1, values) == ADC_FRAME_SAMPLES);
+	CHECK(values[0] == 3000);
+	AnalogStopContinuous(CH1);
+}
+
+/* Frames delivered in the middle of the driver copy to preempt_dst, as an ISR preempting the task */
+static void *preempt_dst = NULL;
+static uint32_t preempt_samples = 0;
+static uint16_t preempt_value = 0;
+
+void *__real_memcpy(void *dst, const void *src, size_t n);
+
+/**
+ * @brief memcpy() of the test (linked with --wrap=memcpy): copies half, lets the "ISR" run, copies the rest
+ */
+void *__wrap_memcpy(void *dst, const void *src, size_t n){
+	if((dst != preempt_dst) || (n < 2)){
+		return __real_memcpy(dst, src, n);
+	}
+	preempt_dst = NULL;
+	size_t half = n / 2;
+	__real_memcpy(dst, src, half);
+	uint16_t value = preempt_value;
+	for(uint32_t i=0; i<preempt_samples; i++){
+		dma[i % DMA_MAX] = Result(CH1, value);
+		if((i % DMA_MAX == DMA_MAX - 1) || (i == preempt_samples - 1)){
+			HostAdcContinuousFrame(dma, i % DMA_MAX + 1);
+		}
+		if(i % ADC_FRAME_SAMPLES == ADC_FRAME_SAMPLES - 1){
+			value++;
+		}
+	}
+	__real_memcpy((uint8_t *)dst + half, (const uint8_t *)src + half, n - half);
+	return dst;
+}
+
+/**
+ * @brief Frames completed while the task copies the last one: the copy is never a mix of two frames
+ */
+static void TestPreemptedRead(void){
+	uint16_t values[ADC_FRAME_SAMPLES];
+	analog_input_config_t config = {
+		.input = CH1,
+		.mode = ADC_CONTINUOUS,
+		.sample_frec = 20000,
+	};
+	AnalogInputInit(&config);
+	AnalogStartContinuous(CH1);
+	/* frame 1 complete, frame 2 and 3/4 of frame 3 arrive during its copy, overwriting it */
+	for(int i=0; i<ADC_FRAME_SAMPLES; i++){
+		dma[i] = Result(CH1, 1);
+	}
+	HostAdcContinuousFrame(dma, ADC_FRAME_SAMPLES);
+	preempt_dst = values;
+	preempt_value = 2;
+	preempt_samples = ADC_FRAME_SAMPLES + 3 * ADC_FRAME_SAMPLES / 4;
+	CHECK(AnalogInputReadContinuous(CH1, values) == ADC_FRAME_SAMPLES);
+	CHECK(preempt_dst == NULL);
+	/* frame 2 is returned, and it was the last complete one */
+	int torn = 0;
+	for(int i=0; i<ADC_FRAME_SAMPLES; i++){
+		torn += (values[i] != 2);
+	}
+	CHECK(torn == 0);
+	CHECK(AnalogInputReadContinuous(CH1, values) == 0);
+	/* no preemption: frame 3 completed normally */
+	for(int i=0; i<ADC_FRAME_SAMPLES / 4; i++){
+		dma[i] = Result(CH1, 3);
+	}
+	HostAdcContinuousFrame(dma, ADC_FRAME_SAMPLES / 4);
+	CHECK(AnalogInputReadContinuous(CH1, values) == ADC_FRAME_SAMPLES);
+	CHECK(values[0] == 3 && values[ADC_FRAME_SAMPLES - 1] == 3);
+	AnalogStopContinuous(CH1);
+}
+
+static void TestOversampling(void){
+	uint16_t values[ADC_FRAME_SAMPLES];
+	analog_input_config_t config = {
+		.input = CH0,
+		.mode = ADC_CONTINUOUS,
+		.sample_frec = 1000,
+		.oversampling = 2,
+	};
+	AnalogInputInit(&config);
+	adc_continuous_handle_t adc = HostAdcContinuous();
+	CHECK(config.sample_frec == 1000);
+	CHECK(adc->config.sample_freq_hz == 16000);
+	AnalogStartContinuous(CH0);
+	/* 16 conversions per sample: a dithered value between two codes gives 2 extra bits */
+	uint32_t n = 0;
+	for(int s=0; s<ADC_FRAME_SAMPLES; s++){
+		for(int j=0; j<16; j++){
+			dma[n++] = Result(CH0, 1000 + ((j % 4) == 0));	/* mean 1000.25 */
+			if(n == DMA_MAX){
+				HostAdcContinuousFrame(dma, n);
+				n = 0;
+			}
+		}
+	}
+	HostAdcContinuousFrame(dma, n);
+	CHECK(AnalogInputReadContinuous(CH0, values) == ADC_FRAME_SAMPLES);
+	for(int i=0; i<ADC_FRAME_SAMPLES; i++){
+		CHECK(values[i] == 4001);	/* 1000.25 * 4, 14 bits */
+	}
+	AnalogStopContinuous(CH0);
+
+	/* 10 kHz * 4^4 exceeds the ADC limit: the real output frequency is reported */
+	config.sample_frec = 10000;
+	config.oversampling = 4;
+	AnalogInputInit(&config);
+	CHECK(adc->config.sample_freq_hz == SOC_ADC_SAMPLE_FREQ_THRES_HIGH);
+	CHECK(config.sample_frec == SOC_ADC_SAMPLE_FREQ_THRES_HIGH / 256);
+	/* and oversampling above the maximum is limited to 4^4 */
+	config.sample_frec = 100;
+	config.oversampling = 7;
+	AnalogInputInit(&config);
+	CHECK(adc->config.sample_freq_hz == 100 * 256);
+	CHECK(config.sample_frec == 100);
+}
+
+static void TestScan(void){
+	static uint16_t buf0[512], buf2[512], buf3[512];
+	uint16_t values[512];
+	int scan_frames = 0;
+	analog_scan_config_t config = {
+		.channels = {CH0, CH2, CH3},
+		.n_channels = 3,
+		.sample_frec = 5000,
+		.buffers = {buf0, buf2, buf3},
+		.buffer_lenght = 512,
+		.func_p = FrameDone,
+		.param_p = &scan_frames,
+	};
+	/* invalid groups */
+	analog_scan_config_t bad = config;
+	bad.buffer_lenght = 500;
+	CHECK(!AnalogScanInit(&bad));
+	bad = config;
+	bad.channels[1] = CH0;
+	CHECK(!AnalogScanInit(&bad));
+	bad = config;
+	bad.n_channels = ADC_SCAN_MAX_CHANNELS + 1;
+	CHECK(!AnalogScanInit(&bad));
+
+	CHECK(AnalogScanInit(&config));
+	adc_continuous_handle_t adc = HostAdcContinuous();
+	CHECK(config.sample_frec == 5000);
+	CHECK(adc->config.sample_freq_hz == 15000);
+	CHECK(adc->config.pattern_num == 3);
+	CHECK(adc->pattern[0].channel == CH0 && adc->pattern[1].channel == CH2 && adc->pattern[2].channel == CH3);
+	/* frames hold whole conversion patterns */
+	CHECK(adc->handle_config.conv_frame_size == (ADC_FRAME_SAMPLES / 3) * 3 * SOC_ADC_DIGI_RESULT_BYTES);
+	/* single channel API is not available while scanning */
+	CHECK(AnalogInputReadContinuous(CH0, values) == 0);
+
+	AnalogScanStart();
+	/* interleaved frames, value = channel * 1000 + sample index; channel 5 is not in the group */
+	uint32_t per_channel = 0;
+	for(int f=0; f<4; f++){
+		uint32_t n = 0;
+		for(int k=0; k<85; k++){
+			dma[n++] = Result(CH0, 0 * 1000 + per_channel);
+			dma[n++] = Result(CH2, 2 * 1000 + per_channel);
+			if(k == 40){
+				dma[n++] = Result(5, 4095);
+			}
+			dma[n++] = Result(CH3, 3 * 1000 + per_channel);
+			per_channel++;
+		}
+		HostTimeAdvanceUs(17000);
+		HostAdcContinuousFrame(dma, n);
+	}
+	CHECK(scan_frames == 4);
+	CHECK(AnalogScanAvailable(CH0) == 340);
+	CHECK(AnalogScanAvailable(CH1) == 0);
+	CHECK(AnalogScanAvailable(CH3) == 340);
+	int64_t time_us;
+	uint32_t count;
+	AnalogScanTimestamp(&time_us, &count);
+	CHECK(time_us == esp_timer_get_time());
+	CHECK(count == 340);
+
+	CHECK(AnalogScanRead(CH2, values, 100) == 100);
+	CHECK(values[0] == 2000 && values[99] == 2099);
+	CHECK(AnalogScanRead(CH2, values, 512) == 240);
+	CHECK(values[0] == 2100 && values[239] == 2339);
+	CHECK(AnalogScanRead(CH0, values, 512) == 340);
+	CHECK(values[339] == 339);
+
+	/* CH3 was not read: its ring buffer fills and whole frames are dropped for all channels */
+	uint32_t dropped = AnalogScanOverruns();
+	for(int f=0; f<3; f++){
+		uint32_t n = 0;
+		for(int k=0; k<85; k++){
+			dma[n++] = Result(CH0, 1);
+			dma[n++] = Result(CH2, 2);
+			dma[n++] = Result(CH3, 3);
+		}
+		HostAdcContinuousFrame(dma, n);
+	}
+	CHECK(AnalogScanOverruns() == dropped + 1);
+	CHECK(AnalogScanAvailable(CH0) == AnalogScanAvailable(CH2));
+	CHECK(AnalogScanAvailable(CH3) == 340 + 2 * 85);
+	AnalogScanStop();
+	CHECK(!adc->running);
+}
+
+int main(void){
+	TestSingleChannel();
+	TestPreemptedRead();
+	TestOversampling();
+	TestScan();
+	return TEST_RESULT();
+}
@@ -0,0 +1,167 @@
+/**
+ * @file test_analog_wave.c
+ * @brief Waveform player: densities written to a simulated SDM on every timer alarm
+ */
+#include <math.h>
+#include <string.h>
+#include "host_test.h"
+#include "host_periph.h"
+#include "analog_io_mcu.h"
+
+#define ECG_LEN		231
+#define LOG_MAX		4096
+#define BLOCK_LEN	50
+
+static uint8_t ecg[ECG_LEN];
+static int8_t sdm_log[LOG_MAX];
+static int n_log = 0;
+
+static void SdmSink(int8_t density){
+	if(n_log < LOG_MAX){
+		sdm_log[n_log++] = density;
+	}
+}
+
+static void Count(void *param){
+	(*(int *)param)++;
+}
+
+/* Streaming: the callback refills the buffer that just finished and queues it again */
+static uint8_t blocks[2][BLOCK_LEN];
+static int next_block = 1;
+static int block_value = 0;
+
+static void FillBlock(uint8_t *block){
+	for(int i=0; i<BLOCK_LEN; i++){
+		block[i] = block_value++ & 0xFF;
+	}
+}
+
+static void Refill(void *param){
+	int *refills = param;
+	next_block = !next_block;
+	FillBlock(blocks[next_block]);
+	CHECK(AnalogOutputWaveQueue(blocks[next_block], BLOCK_LEN));
+	(*refills)++;
+}
+
+int main(void){
+	for(int i=0; i<ECG_LEN; i++){
+		ecg[i] = 128 + 100 * sinf(2 * M_PI * i / ECG_LEN) * expf(-fabsf(i - ECG_LEN / 2.0f) / 40);
+	}
+	analog_wave_config_t config = {
+		.samples = ecg,
+		.lenght = ECG_LEN,
+		.sample_frec = 2000,
+		.loop = true,
+	};
+	/* the DAC must be initialized first */
+	CHECK(!AnalogOutputWaveStart(&config));
+	AnalogOutputInit();
+	HostSdmSink(SdmSink);
+
+	/* static value */
+	AnalogOutputWrite(200);
+	CHECK(HostSdm()->density == 200 - 128);
+	n_log = 0;
+
+	/* invalid configurations */
+	analog_wave_config_t bad = config;
+	bad.lenght = 0;
+	CHECK(!AnalogOutputWaveStart(&bad));
+	bad = config;
+	bad.sample_frec = 0;
+	CHECK(!AnalogOutputWaveStart(&bad));
+	bad = config;
+	bad.sample_frec = 6000000;
+	CHECK(!AnalogOutputWaveStart(&bad));
+	CHECK(!AnalogOutputWaveQueue(ecg, ECG_LEN));
+
+	/* loop: the table repeats, one callback per turn, alarm period from the sample rate */
+	int turns = 0;
+	config.func_p = Count;
+	config.param_p = &turns;
+	CHECK(AnalogOutputWaveStart(&config));
+	gptimer_handle_t timer = HostGptimer(0);
+	CHECK(timer != NULL && timer->running);
+	CHECK(timer->config.resolution_hz == 10000000);
+	CHECK(timer->alarm.alarm_count == 5000);
+	CHECK(timer->alarm.flags.auto_reload_on_alarm);
+	for(int i=0; i<3 * ECG_LEN; i++){
+		HostGptimerAlarm(timer);
+	}
+	CHECK(n_log == 3 * ECG_LEN);
+	for(int i=0; i<n_log; i++){
+		CHECK(sdm_log[i] == (int8_t)(ecg[i % ECG_LEN] - 128));
+	}
+	CHECK(turns == 3);
+	CHECK(AnalogOutputWaveRunning());
+
+	/* stop: the output keeps the last value */
+	HostGptimerAlarm(timer);
+	AnalogOutputWaveStop();
+	CHECK(!AnalogOutputWaveRunning());
+	CHECK(!timer->running);
+	CHECK(HostSdm()->density == (int8_t)(ecg[0] - 128));
+
+	/* one-shot at 44.1 kHz: played once, then the timer stops */
+	n_log = 0;
+	turns = 0;
+	config.loop = false;
+	config.sample_frec = 44100;
+	CHECK(AnalogOutputWaveStart(&config));
+	CHECK(timer->alarm.alarm_count == 227);
+	CHECK(timer->count == 0);
+	for(int i=0; i<2 * ECG_LEN; i++){
+		HostGptimerAlarm(timer);
+	}
+	CHECK(n_log == ECG_LEN);
+	CHECK(sdm_log[ECG_LEN - 1] == (int8_t)(ecg[ECG_LEN - 1] - 128));
+	CHECK(turns == 1);
+	CHECK(!AnalogOutputWaveRunning());
+	CHECK(!timer->running);
+
+	/* queued buffer replaces the current one without gaps, even in one-shot mode */
+	static const uint8_t second[3] = {1, 2, 3};
+	n_log = 0;
+	CHECK(AnalogOutputWaveStart(&config));
+	CHECK(AnalogOutputWaveQueue(second, 3));
+	CHECK(!AnalogOutputWaveQueue(second, 3));
+	for(int i=0; i<ECG_LEN + 10; i++){
+		HostGptimerAlarm(timer);
+	}
+	CHECK(n_log == ECG_LEN + 3);
+	CHECK(sdm_log[ECG_LEN - 1] == (int8_t)(ecg[ECG_LEN - 1] - 128));
+	CHECK(sdm_log[ECG_LEN] == 1 - 128 && sdm_log[ECG_LEN + 2] == 3 - 128);
+	CHECK(!AnalogOutputWaveRunning());
+
+	/* double buffered stream refilled from the callback: a continuous ramp */
+	int refills = 0;
+	n_log = 0;
+	block_value = 0;
+	next_block = 0;
+	FillBlock(blocks[0]);
+	analog_wave_config_t stream = {
+		.samples = blocks[0],
+		.lenght = BLOCK_LEN,
+		.sample_frec = 8000,
+		.loop = false,
+		.func_p = Refill,
+		.param_p = &refills,
+	};
+	CHECK(AnalogOutputWaveStart(&stream));
+	FillBlock(blocks[1]);
+	next_block = 1;
+	CHECK(AnalogOutputWaveQueue(blocks[1], BLOCK_LEN));
+	for(int i=0; i<20 * BLOCK_LEN; i++){
+		HostGptimerAlarm(timer);
+	}
+	CHECK(n_log == 20 * BLOCK_LEN);
+	CHECK(refills == 20);
+	for(int i=0; i<n_log; i++){
+		CHECK(sdm_log[i] == (int8_t)((i & 0xFF) - 128));
+	}
+	CHECK(AnalogOutputWaveRunning());
+	AnalogOutputWaveStop();
+	return TEST_RESULT();
+}
@@ -0,0 +1,124 @@
+/**
+ * @file test_delay.c
+ * @brief Shared delay timer: more tasks than wait slots start at the same time, every delay
+ * lasts at least what was asked and no task busy-waits
+ */
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <time.h>
+#include "host_test.h"
+#include "host_periph.h"
+#include "delay_mcu.h"
+
+#define WORKERS		(3 * DELAY_SLOTS)
+#define ROUNDS		20
+#define STEP_US		5		/* timer count added on each step of the simulated hardware */
+
+static pthread_barrier_t start;
+static atomic_bool done = false;
+static atomic_uint spins = 0;			/* esp_rom_delay_us() calls */
+static atomic_uint waiting = 0;
+static atomic_uint max_waiting = 0;
+
+typedef struct {
+	unsigned int seed;
+	int64_t min_margin;			/* shortest elapsed minus asked time (us) */
+} worker_t;
+
+static worker_t workers[WORKERS];
+
+void esp_rom_delay_us(uint32_t us){
+	(void)us;
+	atomic_fetch_add(&spins, 1);
+}
+
+static uint64_t Count(void){
+	uint64_t count;
+	HostEnterCritical();
+	gptimer_get_raw_count(HostGptimer(0), &count);
+	HostExitCritical();
+	return count;
+}
+
+/**
+ * @brief Timer hardware: the count runs and the alarm interrupts when the count reaches it
+ */
+static void * Hardware(void *arg){
+	(void)arg;
+	struct timespec pause = {.tv_nsec = 1000};
+	while(!atomic_load(&done)){
+		HostEnterCritical();
+		gptimer_handle_t timer = HostGptimer(0);
+		if((timer != NULL) && timer->running){
+			uint64_t from = timer->count;
+			timer->count += STEP_US;
+			if((timer->alarm.alarm_count > from) && (timer->alarm.alarm_count <= timer->count)){
+				HostGptimerAlarm(timer);
+			}
+		}
+		HostExitCritical();
+		nanosleep(&pause, NULL);
+	}
+	return NULL;
+}
+
+static void * Worker(void *arg){
+	worker_t *worker = arg;
+	worker->min_margin = INT64_MAX;
+	pthread_barrier_wait(&start);
+	for(int r=0; r<ROUNDS; r++){
+		bool ms = (rand_r(&worker->seed) % 4) == 0;
+		uint32_t us = ms ? 1000 : 60 + rand_r(&worker->seed) % 1500;
+		unsigned int now = atomic_fetch_add(&waiting, 1) + 1;
+		unsigned int max = atomic_load(&max_waiting);
+		while((now > max) && !atomic_compare_exchange_weak(&max_waiting, &max, now));
+		// the first delay of each task may find the timer not created yet
+		uint64_t from = (r > 0) ? Count() : 0;
+		if(ms){
+			DelayMs(1);
+		}else{
+			DelayUs(us);
+		}
+		int64_t margin = (int64_t)(Count() - from) - us;
+		atomic_fetch_sub(&waiting, 1);
+		if(margin < worker->min_margin){
+			worker->min_margin = margin;
+		}
+	}
+	return NULL;
+}
+
+int main(void){
+	pthread_t hw, threads[WORKERS];
+	pthread_barrier_init(&start, NULL, WORKERS);
+	pthread_create(&hw, NULL, Hardware, NULL);
+	for(int i=0; i<WORKERS; i++){
+		workers[i].seed = i + 1;
+		pthread_create(&threads[i], NULL, Worker, &workers[i]);
+	}
+	for(int i=0; i<WORKERS; i++){
+		pthread_join(threads[i], NULL);
+	}
+	// one timer for every delay
+	CHECK(HostGptimer(0) != NULL);
+	CHECK(HostGptimer(1) == NULL);
+	int64_t min_margin = INT64_MAX;
+	for(int i=0; i<WORKERS; i++){
+		if(workers[i].min_margin < min_margin){
+			min_margin = workers[i].min_margin;
+		}
+	}
+	printf("%d tasks (%u delaying at once, %d slots): shortest delay %lld us over the time asked\n",
+		WORKERS, atomic_load(&max_waiting), DELAY_SLOTS, (long long)min_margin);
+	CHECK(atomic_load(&max_waiting) > DELAY_SLOTS);
+	CHECK(min_margin >= 0);
+	// neither the tasks waiting for the timer creation nor for a slot busy-wait
+	CHECK(atomic_load(&spins) == 0);
+	// short delays do
+	DelayUs(20);
+	CHECK(atomic_load(&spins) == 1);
+	atomic_store(&done, true);
+	pthread_join(hw, NULL);
+	return TEST_RESULT();
+}
@@ -0,0 +1,114 @@
+/**
+ * @file test_fft_plan.c
+ * @brief FFT plans: same spectrum as FFTMagnitude(), overlapping frames and window cache
+ *
+ * Also benchmarks one frame of the original FFTMagnitude() (window generated and
+ * whole buffer cleared on every call) against FFTPlanExecute().
+ */
+#include <math.h>
+#include <string.h>
+#include "host_test.h"
+#include "fft.h"
+#include "esp_dsp.h"
+
+#define N			1024
+#define FS			1000.0f
+#define BENCH_RUNS	200
+
+static float signal[4 * N];
+static float ref[N / 2];
+static float out[N / 2];
+
+/**
+ * @brief FFTMagnitude() before FFT plans, kept as benchmark reference
+ */
+static void FFTMagnitudeOriginal(float * sig, float * fft, uint16_t signal_lenght){
+	static float fft_complex[2 * MAX_SIGNAL_LENGHT];
+	static float wind[MAX_SIGNAL_LENGHT];
+	dsps_wind_hann_f32(wind, signal_lenght);
+	memset(fft_complex, 0, 2 * MAX_SIGNAL_LENGHT * sizeof(float));
+	dsps_mul_f32(sig, wind, fft_complex, signal_lenght, 1, 1, 2);
+	dsps_fft2r_fc32(fft_complex, signal_lenght);
+	dsps_bit_rev_fc32(fft_complex, signal_lenght);
+	dsps_cplx2reC_fc32(fft_complex, signal_lenght);
+	for(int j=0; j<signal_lenght; j++){
+		fft_complex[j] = 2 * (sqrt(fft_complex[j*2+0] * fft_complex[j*2+0] + fft_complex[j*2+1] * fft_complex[j*2+1])) / (signal_lenght / 2);
+	}
+	fft_complex[0] = fft_complex[0] / 2;
+	memcpy(fft, fft_complex, (signal_lenght / 2) * sizeof(float));
+}
+
+static float MaxError(const float *a, const float *b, uint16_t n){
+	float err = 0;
+	for(uint16_t i=0; i<n; i++){
+		if(fabsf(a[i] - b[i]) > err){
+			err = fabsf(a[i] - b[i]);
+		}
+	}
+	return err;
+}
+
+int main(void){
+	fft_plan_t plan, other;
+	CHECK(FFTInit());
+	for(uint16_t i=0; i<4 * N; i++){
+		signal[i] = 1.5f + sinf(2 * M_PI * 50 * i / FS) + 0.25f * cosf(2 * M_PI * 210 * i / FS);
+	}
+
+	// invalid parameters
+	CHECK(!FFTPlanCreate(&plan, 1000, FFT_WINDOW_HANN, N / 4));
+	CHECK(!FFTPlanCreate(&plan, N, FFT_WINDOW_HANN, 0));
+	CHECK(!FFTPlanCreate(&plan, N, FFT_WINDOW_HANN, N + 1));
+
+	// hop = N / 4: one spectrum every N / 4 samples once the ring is full
+	CHECK(FFTPlanCreate(&plan, N, FFT_WINDOW_HANN, N / 4));
+	uint16_t spectra = 0;
+	const float *p = signal;
+	uint16_t n = 4 * N;
+	while(n){
+		uint16_t used = FFTPlanPush(&plan, p, n);
+		p += used;
+		n -= used;
+		if(FFTPlanReady(&plan)){
+			FFTPlanExecute(&plan, out);
+			spectra++;
+			// last N samples pushed so far, same result as the whole frame path
+			FFTMagnitude((float *)p - N, ref, N);
+			CHECK(MaxError(out, ref, N / 2) < 1e-3f);
+		}
+	}
+	CHECK(spectra == 13);		// first at N, then every N / 4 up to 4 * N
+	// strongest component (without DC) at 50 Hz, the 210 Hz one four times smaller
+	uint16_t peak = 4;
+	for(uint16_t k=4; k<N / 2; k++){
+		if(out[k] > out[peak]){
+			peak = k;
+		}
+	}
+	CHECK_NEAR(peak * FS / N, 50, FS / N);
+	CHECK_NEAR(out[(int)(210 * N / FS + 0.5f)] / out[peak], 0.25f, 0.05f);
+
+	// plans with the same lenght and window share the cached window
+	CHECK(FFTPlanCreate(&other, N, FFT_WINDOW_HANN, N));
+	CHECK(other.wind == plan.wind);
+	FFTPlanDelete(&other);
+	CHECK(FFTPlanCreate(&other, N, FFT_WINDOW_BLACKMAN, N));
+	CHECK(other.wind != plan.wind);
+	FFTPlanDelete(&other);
+
+	// benchmark: one frame
+	uint64_t t0 = HostTimeNs();
+	for(int r=0; r<BENCH_RUNS; r++){
+		FFTMagnitudeOriginal(signal, ref, N);
+	}
+	uint64_t t1 = HostTimeNs();
+	for(int r=0; r<BENCH_RUNS; r++){
+		plan.count = plan.hop;
+		FFTPlanExecute(&plan, out);
+	}
+	uint64_t t2 = HostTimeNs();
+	printf("N = %d, ns per frame: FFTMagnitude (original) %llu, FFTPlanExecute %llu\n", N,
+		(unsigned long long)((t1 - t0) / BENCH_RUNS), (unsigned long long)((t2 - t1) / BENCH_RUNS));
+	FFTPlanDelete(&plan);
+	return TEST_RESULT();
+}
@@ -0,0 +1,66 @@
+/**
+ * @file test_fft_q15.c
+ * @brief FFTMagnitudeQ15() accuracy against FFTMagnitude() on 12 bit ADC-like data, and throughput
+ *
+ * On the host the float kernel is faster (hardware FPU), the time is printed
+ * to follow the relative cost of the integer path.
+ */
+#include <math.h>
+#include <stdlib.h>
+#include "host_test.h"
+#include "fft.h"
+
+#define N			1024
+#define BENCH_RUNS	200
+
+static int16_t raw[N];
+static float signal[N];
+static float ref[N / 2];
+static uint16_t out[N / 2];
+
+/**
+ * @brief Compare one signal: every bin within the alpha-max-plus-beta-min error (4%),
+ * the 16 bit FFT rounding (0.2% of the largest bin) and the output rounding
+ */
+static void Compare(float amplitude, float offset){
+	for(uint16_t i=0; i<N; i++){
+		float v = offset + amplitude * (sinf(2 * M_PI * 0.05f * i) + 0.2f * sinf(2 * M_PI * 0.21f * i))
+			+ 2.0f * ((float)rand() / RAND_MAX - 0.5f);
+		raw[i] = (int16_t)lrintf(fminf(fmaxf(v, 0), 4095));
+		signal[i] = raw[i];
+	}
+	FFTMagnitude(signal, ref, N);
+	FFTMagnitudeQ15(raw, out, N);
+	float worst = 0, peak = 0;
+	for(uint16_t k=0; k<N / 2; k++){
+		peak = fmaxf(peak, ref[k]);
+		worst = fmaxf(worst, fabsf(out[k] - ref[k]) - 0.04f * ref[k]);
+	}
+	printf("amplitude %6.1f: worst error beyond 4%% of the bin %.3f (largest bin %.1f)\n", amplitude, worst, peak);
+	CHECK(worst < 0.002f * peak + 1);
+}
+
+int main(void){
+	CHECK(FFTInit());
+	CHECK(FFTInitQ15());
+	srand(3);
+	Compare(1500, 2048);		// full scale
+	Compare(100, 2048);			// small signal: block floating point keeps the resolution
+	Compare(10, 400);
+
+	uint64_t t0 = HostTimeNs();
+	for(int r=0; r<BENCH_RUNS; r++){
+		for(uint16_t i=0; i<N; i++){
+			signal[i] = raw[i];
+		}
+		FFTMagnitude(signal, ref, N);
+	}
+	uint64_t t1 = HostTimeNs();
+	for(int r=0; r<BENCH_RUNS; r++){
+		FFTMagnitudeQ15(raw, out, N);
+	}
+	uint64_t t2 = HostTimeNs();
+	printf("N = %d, ns per frame: FFTMagnitude (with int to float) %llu, FFTMagnitudeQ15 %llu\n", N,
+		(unsigned long long)((t1 - t0) / BENCH_RUNS), (unsigned long long)((t2 - t1) / BENCH_RUNS));
+	return TEST_RESULT();
+}
@@ -0,0 +1,78 @@
+/**
+ * @file test_fft_real.c
+ * @brief FFTMagnitudeReal() gives the same bins as the complex FFT with zero imaginary part
+ * (FFTMagnitude() before the real path), in about half the time
+ */
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "host_test.h"
+#include "fft.h"
+#include "esp_dsp.h"
+
+#define BENCH_RUNS	200
+
+static float signal[MAX_SIGNAL_LENGHT];
+static float ref[MAX_SIGNAL_LENGHT / 2];
+static float out[MAX_SIGNAL_LENGHT / 2];
+
+/**
+ * @brief FFTMagnitude() before the real path: N point complex FFT, kept as reference
+ */
+static void FFTMagnitudeComplex(float * sig, float * fft, uint16_t signal_lenght){
+	static float fft_complex[2 * MAX_SIGNAL_LENGHT];
+	static float wind[MAX_SIGNAL_LENGHT];
+	static uint16_t wind_lenght = 0;
+	if(wind_lenght != signal_lenght){
+		dsps_wind_hann_f32(wind, signal_lenght);
+		wind_lenght = signal_lenght;
+	}
+	memset(fft_complex, 0, 2 * signal_lenght * sizeof(float));
+	dsps_mul_f32(sig, wind, fft_complex, signal_lenght, 1, 1, 2);
+	dsps_fft2r_fc32(fft_complex, signal_lenght);
+	dsps_bit_rev_fc32(fft_complex, signal_lenght);
+	dsps_cplx2reC_fc32(fft_complex, signal_lenght);
+	for(int j=0; j<signal_lenght / 2; j++){
+		fft[j] = 2 * (sqrt(fft_complex[j*2+0] * fft_complex[j*2+0] + fft_complex[j*2+1] * fft_complex[j*2+1])) / (signal_lenght / 2);
+	}
+	fft[0] = fft[0] / 2;
+}
+
+int main(void){
+	CHECK(FFTInit());
+	srand(1);
+	for(uint16_t n=4; n<=MAX_SIGNAL_LENGHT; n*=2){
+		for(uint16_t i=0; i<n; i++){
+			signal[i] = 0.8f * sinf(2 * M_PI * 0.13f * i) + 0.3f * cosf(2 * M_PI * 0.37f * i) + 0.5f
+				+ 0.01f * ((float)rand() / RAND_MAX - 0.5f);
+		}
+		FFTMagnitudeComplex(signal, ref, n);
+		FFTMagnitudeReal(signal, out, n);
+		float err = 0, peak = 0;
+		for(uint16_t k=0; k<n / 2; k++){
+			err = fmaxf(err, fabsf(out[k] - ref[k]));
+			peak = fmaxf(peak, ref[k]);
+		}
+		if(err > 1e-4f * peak + 1e-6f){
+			fprintf(stderr, "N = %u: max error %g (peak %g)\n", n, err, peak);
+		}
+		CHECK(err <= 1e-4f * peak + 1e-6f);
+		// FFTMagnitude() runs the same path
+		FFTMagnitude(signal, ref, n);
+		CHECK(memcmp(ref, out, n / 2 * sizeof(float)) == 0);
+	}
+
+	// benchmark: largest frame
+	uint64_t t0 = HostTimeNs();
+	for(int r=0; r<BENCH_RUNS; r++){
+		FFTMagnitudeComplex(signal, ref, MAX_SIGNAL_LENGHT);
+	}
+	uint64_t t1 = HostTimeNs();
+	for(int r=0; r<BENCH_RUNS; r++){
+		FFTMagnitudeReal(signal, out, MAX_SIGNAL_LENGHT);
+	}
+	uint64_t t2 = HostTimeNs();
+	printf("N = %d, ns per frame: complex FFT %llu, FFTMagnitudeReal %llu\n", MAX_SIGNAL_LENGHT,
+		(unsigned long long)((t1 - t0) / BENCH_RUNS), (unsigned long long)((t2 - t1) / BENCH_RUNS));
+	return TEST_RESULT();
+}
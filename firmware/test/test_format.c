@@ -0,0 +1,330 @@
+/**
+ * @file test_format.c
+ * @brief Number formatting against snprintf, from several threads, and against the
+ * UartItoa() + UartSendString() pattern it replaces
+ */
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include "host_test.h"
+#include "host_periph.h"
+#include "format_mcu.h"
+#include "uart_mcu.h"
+
+#define RANDOM_VALUES	1000000
+#define BLOCK_LEN		512
+#define BENCH_RUNS		200
+
+static uint16_t block[BLOCK_LEN];
+static char csv[FORMAT_CSV_FLOAT_SIZE(BLOCK_LEN) + 1];
+static char ref[FORMAT_CSV_FLOAT_SIZE(BLOCK_LEN) + 1];
+
+/**
+ * @brief Report the first mismatch of a group of comparisons
+ */
+static bool Same(bool *ok, const char *what, const char *out, uint8_t n, const char *expected){
+	if(*ok && ((strcmp(out, expected) != 0) || (n != strlen(expected)))){
+		fprintf(stderr, "%s: \"%s\" (%d), expected \"%s\"\n", what, out, n, expected);
+		*ok = false;
+	}
+	return *ok;
+}
+
+/**
+ * @brief Base 10 edge cases: every power of ten, one less and the limits
+ */
+static void TestIntegers(void){
+	char buf[FORMAT_INT_SIZE], expected[32];
+	bool ok = true;
+	uint8_t n;
+	for(uint64_t p=1; p<=10000000000ULL; p*=10){
+		for(int64_t d=-1; d<=1; d++){
+			uint32_t val = (p + d > UINT32_MAX) ? UINT32_MAX : p + d;
+			n = FormatUint(buf, val);
+			snprintf(expected, sizeof(expected), "%u", val);
+			Same(&ok, "FormatUint", buf, n, expected);
+			n = FormatInt(buf, -(int32_t)(val & INT32_MAX));
+			snprintf(expected, sizeof(expected), "%d", -(int32_t)(val & INT32_MAX));
+			Same(&ok, "FormatInt", buf, n, expected);
+		}
+	}
+	n = FormatInt(buf, INT32_MIN);
+	Same(&ok, "FormatInt", buf, n, "-2147483648");
+	n = FormatInt(buf, INT32_MAX);
+	Same(&ok, "FormatInt", buf, n, "2147483647");
+
+	unsigned int seed = 1;
+	for(int i=0; i<RANDOM_VALUES; i++){
+		/* uniform number of digits */
+		uint32_t val = ((uint32_t)rand_r(&seed) << 1 ^ rand_r(&seed)) >> (rand_r(&seed) % 32);
+		n = FormatUint(buf, val);
+		snprintf(expected, sizeof(expected), "%u", val);
+		Same(&ok, "FormatUint", buf, n, expected);
+		n = FormatInt(buf, (int32_t)val);
+		snprintf(expected, sizeof(expected), "%d", (int32_t)val);
+		Same(&ok, "FormatInt", buf, n, expected);
+	}
+	CHECK(ok);
+}
+
+static void TestBases(void){
+	char buf[FORMAT_BASE_SIZE], expected[40];
+	bool ok = true;
+	unsigned int seed = 2;
+	uint8_t n;
+	for(int i=0; i<RANDOM_VALUES / 10; i++){
+		uint32_t val = ((uint32_t)rand_r(&seed) << 1 ^ rand_r(&seed)) >> (rand_r(&seed) % 32);
+		n = FormatUintBase(buf, val, 16);
+		snprintf(expected, sizeof(expected), "%x", val);
+		Same(&ok, "FormatUintBase 16", buf, n, expected);
+		n = FormatUintBase(buf, val, 8);
+		snprintf(expected, sizeof(expected), "%o", val);
+		Same(&ok, "FormatUintBase 8", buf, n, expected);
+		/* the rest read back, without leading zeros */
+		for(uint8_t base=2; base<=16; base++){
+			n = FormatUintBase(buf, val, base);
+			if(ok && ((strtoul(buf, NULL, base) != val) || (n != strlen(buf)) || ((n > 1) && (buf[0] == '0')))){
+				fprintf(stderr, "FormatUintBase %d: \"%s\" for %u\n", base, buf, val);
+				ok = false;
+			}
+		}
+	}
+	n = FormatUintBase(buf, UINT32_MAX, 2);
+	CHECK(n == 32);
+	n = FormatUintBase(buf, 0, 2);
+	Same(&ok, "FormatUintBase 2", buf, n, "0");
+	CHECK(ok);
+	CHECK(FormatUintBase(buf, 10, 1) == 0 && buf[0] == '\0');
+	CHECK(FormatUintBase(buf, 10, 17) == 0 && buf[0] == '\0');
+	/* UartItoa() keeps its interface */
+	CHECK(strcmp((char *)UartItoa(0, 10), "0") == 0);
+	CHECK(strcmp((char *)UartItoa(48879, 16), "beef") == 0);
+}
+
+static void TestFixed(void){
+	char buf[FORMAT_FLOAT_SIZE], expected[40];
+	bool ok = true;
+	unsigned int seed = 3;
+	uint8_t n;
+	for(int i=0; i<RANDOM_VALUES; i++){
+		int32_t val = ((uint32_t)rand_r(&seed) << 1 ^ rand_r(&seed)) >> (rand_r(&seed) % 32);
+		uint8_t decimals = rand_r(&seed) % 10;
+		n = FormatFixed(buf, val, decimals);
+		/* exact: val / 10^decimals is printed with the digits of the nearest double */
+		snprintf(expected, sizeof(expected), "%.*f", decimals, val / pow(10, decimals));
+		Same(&ok, "FormatFixed", buf, n, expected);
+	}
+	n = FormatFixed(buf, -12345, 2);
+	Same(&ok, "FormatFixed", buf, n, "-123.45");
+	n = FormatFixed(buf, -5, 3);
+	Same(&ok, "FormatFixed", buf, n, "-0.005");
+	n = FormatFixed(buf, INT32_MIN, 9);
+	Same(&ok, "FormatFixed", buf, n, "-2.147483648");
+	n = FormatFixed(buf, 7, 12);
+	Same(&ok, "FormatFixed", buf, n, "0.000000007");
+	CHECK(ok);
+}
+
+/**
+ * @brief snprintf rounds exact ties to even, FormatFloat() away from zero; and never writes "-0"
+ */
+static void FloatReference(char *expected, size_t size, float val, uint8_t decimals){
+	double scaled = fabs((double)val) * pow(10, decimals);
+	if(scaled - floor(scaled) == 0.5){
+		snprintf(expected, size, "%.*f", decimals, copysign(floor(scaled) + 1, val) / pow(10, decimals));
+	}else{
+		snprintf(expected, size, "%.*f", decimals, (double)val);
+	}
+	if(expected[0] == '-' && strspn(&expected[1], "0.") == strlen(&expected[1])){
+		memmove(expected, &expected[1], strlen(expected));
+	}
+}
+
+static void TestFloat(void){
+	char buf[FORMAT_FLOAT_SIZE], expected[64];
+	bool ok = true;
+	unsigned int seed = 4;
+	uint8_t n;
+	for(int i=0; i<RANDOM_VALUES; i++){
+		/* every magnitude up to 2^32, and values with few binary digits (ties) */
+		float val = ldexpf((float)rand_r(&seed) / RAND_MAX, rand_r(&seed) % 52 - 20);
+		if(i % 4 == 0){
+			val = (rand_r(&seed) % 100000) / 64.0f;
+		}
+		if(rand_r(&seed) % 2){
+			val = -val;
+		}
+		uint8_t decimals = rand_r(&seed) % (FORMAT_FLOAT_MAX_DEC + 1);
+		n = FormatFloat(buf, val, decimals);
+		FloatReference(expected, sizeof(expected), val, decimals);
+		Same(&ok, "FormatFloat", buf, n, expected);
+	}
+	n = FormatFloat(buf, 0.125f, 2);
+	Same(&ok, "FormatFloat", buf, n, "0.13");
+	n = FormatFloat(buf, -0.001f, 2);
+	Same(&ok, "FormatFloat", buf, n, "0.00");
+	n = FormatFloat(buf, 2.5f, 9);
+	Same(&ok, "FormatFloat", buf, n, "2.500000");
+	n = FormatFloat(buf, 9.9999999f, 0);
+	Same(&ok, "FormatFloat", buf, n, "10");
+	n = FormatFloat(buf, NAN, 2);
+	Same(&ok, "FormatFloat", buf, n, "nan");
+	n = FormatFloat(buf, -1e10f, 2);
+	Same(&ok, "FormatFloat", buf, n, "-ovf");
+	/* largest number that is not "ovf" fills the buffer */
+	n = FormatFloat(buf, -nextafterf(4294967295.0f, 0), FORMAT_FLOAT_MAX_DEC);
+	Same(&ok, "FormatFloat", buf, n, "-4294967040.000000");
+	CHECK(n == FORMAT_FLOAT_SIZE - 1);
+	CHECK(ok);
+}
+
+static void TestCsv(void){
+	float samples[7] = {1.5f, -2.25f, 0, 100, -0.004f, 3.14159f, 65535};
+	/* 1 and 5 digit samples */
+	for(int i=0; i<BLOCK_LEN; i++){
+		block[i] = (i % 7 == 0) ? 9 : 65535 - i;
+	}
+	for(uint8_t columns=1; columns<=4; columns++){
+		uint32_t lenght = BLOCK_LEN - columns;	/* last row incomplete for columns 3 and 4 */
+		char *r = ref;
+		for(uint32_t i=0; i<lenght; i++){
+			r += sprintf(r, "%u%c", block[i], ((i % columns == columns - 1) || (i == lenght - 1)) ? '\n' : ',');
+		}
+		memset(csv, 0x55, sizeof(csv));
+		uint32_t n = FormatCsvUint16(csv, block, lenght, columns);
+		CHECK(n == r - ref);
+		CHECK(strcmp(csv, ref) == 0);
+	}
+	/* full scale samples fill the buffer exactly */
+	for(int i=0; i<BLOCK_LEN; i++){
+		block[i] = 65535;
+	}
+	memset(csv, 0x55, sizeof(csv));
+	CHECK(FormatCsvUint16(csv, block, BLOCK_LEN, 2) == FORMAT_CSV_UINT16_SIZE(BLOCK_LEN) - 1);
+	CHECK(csv[FORMAT_CSV_UINT16_SIZE(BLOCK_LEN)] == 0x55);
+	CHECK(FormatCsvUint16(csv, block, 0, 2) == 0 && csv[0] == '\0');
+
+	uint32_t n = FormatCsvFloat(csv, samples, 7, 3, 2);
+	CHECK(n == strlen(csv));
+	CHECK(strcmp(csv, "1.50,-2.25,0.00\n100.00,0.00,3.14\n65535.00\n") == 0);
+}
+
+/**
+ * @brief Tasks formatting at the same time do not share buffers
+ */
+static void * Formatter(void *param){
+	char buf[FORMAT_FLOAT_SIZE], expected[64];
+	uint32_t seed = (uintptr_t)param;
+	bool *ok = calloc(1, sizeof(bool));
+	*ok = true;
+	for(int i=0; i<RANDOM_VALUES / 4; i++){
+		uint32_t val = rand_r(&seed);
+		uint8_t n = FormatUint(buf, val);
+		snprintf(expected, sizeof(expected), "%u", val);
+		Same(ok, "FormatUint (thread)", buf, n, expected);
+		n = FormatFixed(buf, val, 3);
+		snprintf(expected, sizeof(expected), "%u.%03u", val / 1000, val % 1000);
+		Same(ok, "FormatFixed (thread)", buf, n, expected);
+	}
+	return ok;
+}
+
+static void TestThreads(void){
+	pthread_t threads[4];
+	for(uintptr_t t=0; t<4; t++){
+		pthread_create(&threads[t], NULL, Formatter, (void *)(t + 10));
+	}
+	for(int t=0; t<4; t++){
+		bool *ok;
+		pthread_join(threads[t], (void **)&ok);
+		CHECK(*ok);
+		free(ok);
+	}
+}
+
+/**
+ * @brief UartItoa() as it was: division loop into a static buffer
+ */
+static uint8_t * LegacyItoa(uint32_t val, uint8_t base){
+	static uint8_t buf[32] = {0};
+	uint32_t i = 30;
+	if(val == 0){
+		return (uint8_t *)"0";
+	}
+	for(; val && i ; --i, val /= base){
+		buf[i] = "0123456789abcdef"[val % base];
+	}
+	return &buf[i+1];
+}
+
+static void Benchmark(void){
+	char buf[FORMAT_INT_SIZE];
+	volatile uint32_t sink = 0;
+	unsigned int seed = 5;
+	for(int i=0; i<BLOCK_LEN; i++){
+		block[i] = rand_r(&seed) % 4096;
+	}
+
+	/* one number */
+	uint64_t t0 = HostTimeNs();
+	for(int r=0; r<BENCH_RUNS; r++){
+		for(int i=0; i<BLOCK_LEN; i++){
+			sink += LegacyItoa(block[i] * 1000u + r, 10)[0];
+		}
+	}
+	uint64_t t1 = HostTimeNs();
+	for(int r=0; r<BENCH_RUNS; r++){
+		for(int i=0; i<BLOCK_LEN; i++){
+			sink += FormatUint(buf, block[i] * 1000u + r);
+		}
+	}
+	uint64_t t2 = HostTimeNs();
+	for(int r=0; r<BENCH_RUNS; r++){
+		for(int i=0; i<BLOCK_LEN; i++){
+			sink += snprintf(buf, sizeof(buf), "%u", block[i] * 1000u + r);
+		}
+	}
+	uint64_t t3 = HostTimeNs();
+	printf("ns per 7 digit number: division loop %.1f, FormatUint %.1f, snprintf %.1f\n",
+		(double)(t1 - t0) / BENCH_RUNS / BLOCK_LEN, (double)(t2 - t1) / BENCH_RUNS / BLOCK_LEN,
+		(double)(t3 - t2) / BENCH_RUNS / BLOCK_LEN);
+
+	/* a block of ADC samples as CSV lines: same bytes on the UART */
+	uint32_t lenght;
+	HostUartTxClear(UART_NUM_0);
+	t0 = HostTimeNs();
+	for(int r=0; r<BENCH_RUNS; r++){
+		HostUartTxClear(UART_NUM_0);
+		for(int i=0; i<BLOCK_LEN; i++){
+			UartSendString(UART_PC, (char *)LegacyItoa(block[i], 10));
+			UartSendString(UART_PC, (i % 2) ? "\n" : ",");
+		}
+	}
+	t1 = HostTimeNs();
+	const uint8_t *tx = HostUartTx(UART_NUM_0, &lenght);
+	memcpy(ref, tx, lenght);
+	ref[lenght] = '\0';
+	for(int r=0; r<BENCH_RUNS; r++){
+		HostUartTxClear(UART_NUM_0);
+		uint32_t n = FormatCsvUint16(csv, block, BLOCK_LEN, 2);
+		UartSendBuffer(UART_PC, csv, n);
+	}
+	t2 = HostTimeNs();
+	tx = HostUartTx(UART_NUM_0, &lenght);
+	CHECK(lenght == strlen(ref));
+	CHECK(memcmp(tx, ref, lenght) == 0);
+	printf("ns per sample sent as CSV: UartItoa + UartSendString %.1f, FormatCsvUint16 + UartSendBuffer %.1f\n",
+		(double)(t1 - t0) / BENCH_RUNS / BLOCK_LEN, (double)(t2 - t1) / BENCH_RUNS / BLOCK_LEN);
+}
+
+int main(void){
+	TestIntegers();
+	TestBases();
+	TestFixed();
+	TestFloat();
+	TestCsv();
+	TestThreads();
+	Benchmark();
+	return TEST_RESULT();
+}
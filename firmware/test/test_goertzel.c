@@ -0,0 +1,191 @@
+/**
+ * @file test_goertzel.c
+ * @brief Goertzel bank and sliding DFT against FFTMagnitude() bins, DC and Nyquist scaling,
+ * and cost per sample
+ */
+#include <math.h>
+#include <stdlib.h>
+#include "host_test.h"
+#include "fft.h"
+#include "goertzel.h"
+#include "esp_dsp.h"
+
+#define N			256
+#define FS			1000.0f
+#define BENCH_RUNS	2000
+
+static float signal[2 * N];
+static float windowed[N];
+static float wind[N];
+static float fft[N / 2];
+static float freq[N / 2];
+static float delay[N];
+
+/**
+ * @brief Two tones, one between bins, offset and some noise
+ */
+static void Signal(void){
+	srand(1);
+	for(int i=0; i<2 * N; i++){
+		signal[i] = 0.4f + sinf(2 * M_PI * 50 * i / FS) + 0.3f * cosf(2 * M_PI * 213.7f * i / FS)
+			+ 0.05f * ((float)rand() / RAND_MAX - 0.5f);
+	}
+}
+
+/**
+ * @brief FFTMagnitude() bin over Goertzel amplitude of the windowed block
+ */
+static float Scale(uint16_t bin){
+	return (bin == 0) ? 2 : 4;
+}
+
+/**
+ * @brief Same Hann windowed block as FFTMagnitude(): its bins are Scale() times the Goertzel
+ * amplitudes (FFTMagnitude() undoes the window gain; the float Goertzel recursion loses
+ * some precision at DC)
+ */
+static void TestAgainstFFT(void){
+	goertzel_t bank;
+	float freqs[GOERTZEL_MAX_BINS];
+	float mag[GOERTZEL_MAX_BINS];
+	float f[GOERTZEL_MAX_BINS];
+	static const uint16_t bins[GOERTZEL_MAX_BINS] = {0, 1, 13, 50, 54, 55, 56, 127};
+	dsps_wind_hann_f32(wind, N);
+	for(int i=0; i<N; i++){
+		windowed[i] = signal[i] * wind[i];
+	}
+	FFTMagnitude(signal, fft, N);
+	FFTFrequency(FS, N, freq);
+	for(int i=0; i<GOERTZEL_MAX_BINS; i++){
+		// a little off the bin: rounded to the nearest one
+		freqs[i] = freq[bins[i]] + ((i % 2) ? 0.3f : -0.3f) * FS / N;
+	}
+	freqs[0] = freq[0];
+	CHECK(GoertzelInit(&bank, FS, N, freqs, GOERTZEL_MAX_BINS));
+	GoertzelFrequency(&bank, FS, f);
+	for(int i=0; i<GOERTZEL_MAX_BINS; i++){
+		CHECK(bank.bin[i] == bins[i]);
+		CHECK(f[i] == freq[bins[i]]);
+	}
+	int blocks = 0;
+	for(int i=0; i<N; i++){
+		blocks += GoertzelUpdate(&bank, windowed[i]);
+	}
+	CHECK(blocks == 1);
+	GoertzelMagnitude(&bank, mag);
+	for(int i=0; i<GOERTZEL_MAX_BINS; i++){
+		CHECK_NEAR(Scale(bins[i]) * mag[i], fft[bins[i]], 5e-3f * fft[bins[i]] + 1e-5f);
+	}
+
+	// next block starts from a clean state
+	for(int i=0; i<N; i++){
+		windowed[i] = signal[N + i] * wind[i];
+		GoertzelUpdate(&bank, windowed[i]);
+	}
+	FFTMagnitude(&signal[N], fft, N);
+	GoertzelMagnitude(&bank, mag);
+	for(int i=0; i<GOERTZEL_MAX_BINS; i++){
+		CHECK_NEAR(Scale(bins[i]) * mag[i], fft[bins[i]], 5e-3f * fft[bins[i]] + 1e-5f);
+	}
+}
+
+/**
+ * @brief Amplitude of a constant, a tone and a full scale Nyquist signal
+ */
+static void TestAmplitude(void){
+	goertzel_t bank;
+	sdft_t sdft;
+	float freqs[3] = {0, 125, FS / 2};
+	float mag[3], slide[3];
+	CHECK(GoertzelInit(&bank, FS, N, freqs, 3));
+	CHECK(SlidingDFTInit(&sdft, FS, N, freqs, 3, delay));
+	CHECK(bank.bin[2] == N / 2);
+	for(int i=0; i<N; i++){
+		float x = 0.7f + 1.5f * cosf(2 * M_PI * 125 * i / FS) + 0.5f * ((i % 2) ? -1 : 1);
+		GoertzelUpdate(&bank, x);
+		SlidingDFTUpdate(&sdft, x);
+	}
+	GoertzelMagnitude(&bank, mag);
+	SlidingDFTMagnitude(&sdft, slide);
+	CHECK_NEAR(mag[0], 0.7f, 1e-3f);
+	CHECK_NEAR(mag[1], 1.5f, 1e-4f);
+	CHECK_NEAR(mag[2], 0.5f, 1e-4f);
+	// damped recursion: within SDFT_DAMPING ^ N
+	for(int i=0; i<3; i++){
+		CHECK_NEAR(slide[i], mag[i], 0.005f * mag[i]);
+	}
+}
+
+/**
+ * @brief Sliding DFT: after every sample, the magnitudes of the last N samples
+ */
+static void TestSliding(void){
+	sdft_t sdft;
+	goertzel_t bank;
+	float freqs[4] = {50, 100, 211, 400};
+	float mag[4], ref[4];
+	CHECK(SlidingDFTInit(&sdft, FS, N, freqs, 4, delay));
+	float worst = 0;
+	for(int i=0; i<2 * N; i++){
+		SlidingDFTUpdate(&sdft, signal[i]);
+		if((i >= N - 1) && (i % 17 == 0)){
+			CHECK(GoertzelInit(&bank, FS, N, freqs, 4));
+			for(int j=i - N + 1; j<=i; j++){
+				GoertzelUpdate(&bank, signal[j]);
+			}
+			GoertzelMagnitude(&bank, ref);
+			SlidingDFTMagnitude(&sdft, mag);
+			for(int k=0; k<4; k++){
+				worst = fmaxf(worst, fabsf(mag[k] - ref[k]));
+			}
+		}
+	}
+	printf("sliding DFT: worst error against the block %.5f\n", worst);
+	CHECK(worst < 0.01f);
+
+	// invalid parameters
+	CHECK(!SlidingDFTInit(&sdft, FS, N, freqs, 0, delay));
+	CHECK(!SlidingDFTInit(&sdft, FS, N, freqs, GOERTZEL_MAX_BINS + 1, delay));
+	CHECK(!SlidingDFTInit(&sdft, FS, N, freqs, 4, NULL));
+	CHECK(!GoertzelInit(&bank, FS, 0, freqs, 4));
+}
+
+static void Benchmark(void){
+	goertzel_t bank;
+	sdft_t sdft;
+	float freqs[3] = {50, 100, 150};
+	volatile float sink = 0;
+	GoertzelInit(&bank, FS, N, freqs, 3);
+	SlidingDFTInit(&sdft, FS, N, freqs, 3, delay);
+	uint64_t t0 = HostTimeNs();
+	for(int r=0; r<BENCH_RUNS; r++){
+		FFTMagnitude(signal, fft, N);
+		sink += fft[5];
+	}
+	uint64_t t1 = HostTimeNs();
+	for(int r=0; r<BENCH_RUNS; r++){
+		for(int i=0; i<N; i++){
+			GoertzelUpdate(&bank, signal[i]);
+		}
+	}
+	uint64_t t2 = HostTimeNs();
+	for(int r=0; r<BENCH_RUNS; r++){
+		for(int i=0; i<N; i++){
+			SlidingDFTUpdate(&sdft, signal[i]);
+		}
+	}
+	uint64_t t3 = HostTimeNs();
+	printf("N = %d, 3 bins, ns per block: FFTMagnitude %llu, Goertzel %llu, sliding DFT %llu\n", N,
+		(unsigned long long)((t1 - t0) / BENCH_RUNS), (unsigned long long)((t2 - t1) / BENCH_RUNS),
+		(unsigned long long)((t3 - t2) / BENCH_RUNS));
+}
+
+int main(void){
+	CHECK(FFTInit());
+	Signal();
+	TestAgainstFFT();
+	TestAmplitude();
+	TestSliding();
+	Benchmark();
+	return TEST_RESULT();
+}
@@ -0,0 +1,270 @@
+/**
+ * @file test_hc_sr04.c
+ * @brief HC-SR04 continuous ranging: a simulated sensor answers every trigger with an echo
+ * pulse, its edges interrupt the driver at exact virtual times
+ */
+#include <stdlib.h>
+#include "host_test.h"
+#include "host_periph.h"
+#include "esp_timer.h"
+#include "delay_mcu.h"
+#include "hc_sr04.h"
+
+#define CYCLES			1000
+#define ECHO_LAG_US		450		/* trigger end to echo start */
+#define SENSOR_MAX_US	38000	/* echo of the sensor without object */
+#define STUCK_US		65000	/* echo longer than the ranging period */
+#define TICK_US			1000
+
+/* Simulated sensor and pins */
+static gpio_t echo_pin, trigger_pin;
+static bool trigger_level = false;
+static int64_t trigger_on = 0;
+static int64_t trigger_width = 0;					/* last trigger pulse */
+static int64_t echo_rise = 0, echo_fall = 0;		/* current or last echo pulse */
+static void (*echo_isr)(void *) = NULL;
+static void *echo_args = NULL;
+static bool in_isr = false;
+static uint32_t reads = 0;
+static bool deinit = false;
+
+/* Echo of each trigger (0: no echo) and pulse width measured by the driver */
+static uint32_t widths[CYCLES + 8];
+static uint32_t expected[CYCLES + 8];
+static int64_t triggers[CYCLES + 8];
+static uint32_t n_triggers = 0;
+
+typedef struct {
+	uint32_t echo_us;
+	uint16_t cm;
+	uint16_t inch;
+} result_t;
+
+static result_t results[CYCLES + 8];
+static uint32_t n_results = 0;
+
+static int64_t Now(void){
+	return esp_timer_get_time();
+}
+
+static void AdvanceTo(int64_t t){
+	if(t > Now()){
+		HostTimeAdvanceUs(t - Now());
+	}
+}
+
+void DelayUs(uint16_t usec){
+	/* busy wait, not in the interruptions */
+	CHECK(!in_isr);
+	HostTimeAdvanceUs(usec);
+}
+
+void GPIOInit(gpio_t pin, io_t io){
+	if(io == GPIO_INPUT){
+		echo_pin = pin;
+	}else{
+		trigger_pin = pin;
+	}
+	deinit = false;
+}
+
+bool GPIORead(gpio_t pin){
+	int64_t now = Now();
+	reads++;
+	/* polling the pin takes time */
+	if(!in_isr){
+		HostTimeAdvanceUs(1);
+	}
+	return (pin == echo_pin) && (now >= echo_rise) && (now < echo_fall);
+}
+
+void GPIOOn(gpio_t pin){
+	CHECK(pin == trigger_pin);
+	trigger_level = true;
+	trigger_on = Now();
+}
+
+/**
+ * @brief End of the trigger pulse: the sensor answers unless it is still sending an echo (or
+ * the pulse is too short)
+ */
+void GPIOOff(gpio_t pin){
+	CHECK(pin == trigger_pin && trigger_level);
+	trigger_width = Now() - trigger_on;
+	trigger_level = false;
+	if(trigger_width < 10){
+		return;			/* too short, ignored by the sensor */
+	}
+	uint32_t c = n_triggers++;
+	triggers[c] = trigger_on;
+	if(Now() < echo_fall){
+		widths[c] = 0;
+		expected[c] = 0;
+		return;
+	}
+	if(widths[c] > 0){
+		echo_rise = Now() + ECHO_LAG_US;
+		echo_fall = echo_rise + widths[c];
+	}
+}
+
+void GPIOActivIntAnyEdge(gpio_t pin, void *ptr_int_func, void *args){
+	CHECK(pin == echo_pin);
+	echo_isr = ptr_int_func;
+	echo_args = args;
+}
+
+void GPIODeactivInt(gpio_t pin){
+	CHECK(pin == echo_pin);
+	echo_isr = NULL;
+}
+
+void GPIODeinit(void){
+	deinit = true;
+}
+
+static void Measured(void *param){
+	(*(uint32_t *)param)++;
+	if(n_results < CYCLES + 8){
+		results[n_results].echo_us = HcSr04ReadEchoUs();
+		results[n_results].cm = HcSr04ReadDistanceInCentimeters();
+		results[n_results].inch = HcSr04ReadDistanceInInches();
+		n_results++;
+	}
+}
+
+/**
+ * @brief Run the simulation: echo edges at their exact times, soft timer ticks every TICK_US
+ */
+static void Run(gptimer_handle_t hw, uint32_t ticks){
+	int64_t next_tick = (Now() / TICK_US + 1) * TICK_US;
+	int64_t last_edge = Now();
+	while(ticks--){
+		/* edges in the same us as the tick go first */
+		int64_t edges[2] = {echo_rise, echo_fall};
+		for(int e=0; e<2; e++){
+			if((edges[e] > last_edge) && (edges[e] <= next_tick)){
+				last_edge = edges[e];
+				AdvanceTo(edges[e]);
+				if(echo_isr != NULL){
+					in_isr = true;
+					echo_isr(echo_args);
+					in_isr = false;
+				}
+			}
+		}
+		AdvanceTo(next_tick);
+		in_isr = true;
+		HostGptimerAlarm(hw);
+		in_isr = false;
+		next_tick += TICK_US;
+	}
+}
+
+static void TestBlocking(void){
+	/* polling, as before */
+	widths[0] = 5900;
+	n_triggers = 0;
+	reads = 0;
+	uint32_t echo = HcSr04ReadEchoUs();
+	CHECK(abs((int)echo - 5900) <= 1);
+	CHECK(trigger_width >= 10);
+	printf("blocking: %u pin reads for a 100 cm echo\n", reads);
+	widths[1] = 0;
+	CHECK(HcSr04ReadEchoUs() == 0);
+	AdvanceTo(echo_fall + 1000);
+	widths[2] = SENSOR_MAX_US;
+	CHECK(HcSr04ReadDistanceInCentimeters() == 300);
+	AdvanceTo(echo_fall + 1000);
+	widths[3] = 1180;
+	CHECK(HcSr04ReadDistanceInCentimeters() == 20);
+	widths[4] = 3000;
+	CHECK(HcSr04ReadDistanceInInches() == 20);
+	AdvanceTo(echo_fall + 1000);
+}
+
+static void TestRanging(void){
+	uint32_t callbacks = 0;
+	unsigned int seed = 1;
+	/* mostly objects in range, and every way a measurement can end without one */
+	for(int c=0; c<CYCLES + 8; c++){
+		int r = rand_r(&seed) % 100;
+		if(r < 5){
+			widths[c] = 0;
+		}else if(r < 10){
+			widths[c] = SENSOR_MAX_US;
+		}else if(r < 12){
+			widths[c] = STUCK_US;
+		}else{
+			widths[c] = 116 + rand_r(&seed) % (HC_SR04_MAX_ECHO_US - 116 + 1);
+		}
+		expected[c] = (widths[c] == STUCK_US) ? HC_SR04_MAX_ECHO_US + 1 : widths[c];
+	}
+	n_triggers = 0;
+	n_results = 0;
+	reads = 0;
+	/* the period is limited to the minimum of the sensor */
+	CHECK(HcSr04StartRanging(10, Measured, &callbacks));
+	CHECK(echo_isr != NULL);
+	gptimer_handle_t hw = HostGptimer(0);
+	CHECK(hw != NULL);
+	Run(hw, CYCLES * HC_SR04_MIN_PERIOD_MS);
+	CHECK(n_triggers == CYCLES);
+	bool ok = true;
+	for(uint32_t c=1; c<n_triggers; c++){
+		ok &= (triggers[c] - triggers[c-1] == HC_SR04_MIN_PERIOD_MS * 1000);
+	}
+	CHECK(ok);
+	/* the pulse is ended by the next tick */
+	CHECK(trigger_width == TICK_US);
+	/* the last trigger has not been closed yet, unless its echo already ended */
+	CHECK(n_results >= CYCLES - 1);
+	CHECK(callbacks == n_results);
+	for(uint32_t c=0; c<n_results; c++){
+		uint32_t cm = (expected[c] > HC_SR04_MAX_ECHO_US) ? 300 : expected[c] / 59;
+		uint32_t inch = (expected[c] > HC_SR04_MAX_ECHO_US) ? 118 : expected[c] / 150;
+		if(ok && ((results[c].echo_us != expected[c]) || (results[c].cm != cm) || (results[c].inch != inch))){
+			fprintf(stderr, "cycle %u: echo %u us (%u cm), expected %u us (%u cm)\n", c,
+				results[c].echo_us, results[c].cm, expected[c], cm);
+			ok = false;
+		}
+	}
+	CHECK(ok);
+	/* the pin is only read in the two edge interruptions */
+	printf("ranging: %.2f pin reads per measurement\n", (double)reads / n_results);
+	CHECK(reads <= 2 * n_triggers);
+
+	/* restart with a longer period, then stop: no more triggers */
+	CHECK(HcSr04StartRanging(100, NULL, NULL));
+	AdvanceTo(echo_fall);
+	uint32_t first = n_triggers;
+	Run(hw, 250);
+	CHECK(n_triggers == first + 3);
+	CHECK(triggers[first + 2] - triggers[first + 1] == 100000);
+	HcSr04StopRanging();
+	CHECK(echo_isr == NULL);
+	Run(hw, 500);
+	CHECK(n_triggers == first + 3);
+	/* stopped during a trigger pulse: the pin goes low */
+	CHECK(HcSr04StartRanging(100, NULL, NULL));
+	Run(hw, 1);
+	CHECK(trigger_level);
+	HcSr04StopRanging();
+	CHECK(!trigger_level && trigger_width == 0);
+	Run(hw, 500);
+	CHECK(n_triggers == first + 3);
+	/* read functions block again */
+	widths[n_triggers] = 2950;
+	AdvanceTo(echo_fall + 1000);
+	CHECK(HcSr04ReadDistanceInCentimeters() == 50);
+}
+
+int main(void){
+	CHECK(HcSr04Init(GPIO_3, GPIO_2));
+	CHECK(echo_pin == GPIO_3 && trigger_pin == GPIO_2);
+	TestBlocking();
+	TestRanging();
+	CHECK(HcSr04Deinit());
+	CHECK(deinit);
+	return TEST_RESULT();
+}
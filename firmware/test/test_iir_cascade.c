@@ -0,0 +1,108 @@
+/**
+ * @file test_iir_cascade.c
+ * @brief Single pass cascade (IIRProcess/IIRProcessSeries/BandPassFilter) against one
+ * dsps_biquad_f32 pass per section, and time per sample for each order
+ */
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "host_test.h"
+#include "iir_filter.h"
+#include "esp_dsp.h"
+
+#define SAMPLE_FREC	1000.0f
+#define SIGNAL_LEN	1024
+#define BENCH_RUNS	2000
+#define TOL			1e-4f
+
+static float input[SIGNAL_LEN];
+static float ref[SIGNAL_LEN];
+static float out[SIGNAL_LEN];
+static float delay[IIR_MAX_SECTIONS][2];
+
+/**
+ * @brief Per section path: the whole array is walked once for each section
+ */
+static void PerSection(const iir_filter_t *filter, const float *in, float *y, int len){
+	dsps_biquad_f32(in, y, len, (float *)filter->sos[0].coeffs, delay[0]);
+	for(uint8_t k=1; k<filter->n_sos; k++){
+		dsps_biquad_f32(y, y, len, (float *)filter->sos[k].coeffs, delay[k]);
+	}
+}
+
+static float MaxError(const float *a, const float *b, int len, float *peak){
+	float err = 0;
+	*peak = 0;
+	for(int i=0; i<len; i++){
+		err = fmaxf(err, fabsf(a[i] - b[i]));
+		*peak = fmaxf(*peak, fabsf(b[i]));
+	}
+	return err;
+}
+
+int main(void){
+	float peak;
+	srand(1);
+	for(int i=0; i<SIGNAL_LEN; i++){
+		input[i] = sinf(2 * M_PI * 5 * i / SAMPLE_FREC) + 0.5f * sinf(2 * M_PI * 180 * i / SAMPLE_FREC)
+			+ 0.2f * ((float)rand() / RAND_MAX - 0.5f);
+	}
+
+	printf("order  per section (ns/sample)  cascade (ns/sample)  speedup\n");
+	for(uint8_t order=2; order<=IIR_MAX_ORDER; order+=2){
+		iir_design_t design = {.type = IIR_HI_PASS, .sample_frec = SAMPLE_FREC, .cut_frec = 20, .order = order};
+		iir_filter_t filter;
+		CHECK(IIRCreate(&filter, &design, NULL));
+		memset(delay, 0, sizeof(delay));
+		PerSection(&filter, input, ref, SIGNAL_LEN);
+		IIRProcess(&filter, input, out, SIGNAL_LEN);
+		float err = MaxError(out, ref, SIGNAL_LEN, &peak);
+		if(err > TOL * peak){
+			fprintf(stderr, "order %d: max error %g (peak %g)\n", order, err, peak);
+		}
+		CHECK(err <= TOL * peak);
+		/* in place, as LowPassFilter() is usually called */
+		IIRReset(&filter);
+		memcpy(out, input, sizeof(out));
+		IIRProcess(&filter, out, out, SIGNAL_LEN);
+		CHECK(MaxError(out, ref, SIGNAL_LEN, &peak) <= TOL * peak);
+
+		uint64_t t0 = HostTimeNs();
+		for(int r=0; r<BENCH_RUNS; r++){
+			PerSection(&filter, input, ref, SIGNAL_LEN);
+		}
+		uint64_t t1 = HostTimeNs();
+		for(int r=0; r<BENCH_RUNS; r++){
+			IIRProcess(&filter, input, out, SIGNAL_LEN);
+		}
+		uint64_t t2 = HostTimeNs();
+		double ns_ref = (double)(t1 - t0) / BENCH_RUNS / SIGNAL_LEN;
+		double ns_cas = (double)(t2 - t1) / BENCH_RUNS / SIGNAL_LEN;
+		printf("%5d  %24.2f  %19.2f  %6.2fx\n", order, ns_ref, ns_cas, ns_ref / ns_cas);
+		IIRDelete(&filter);
+	}
+
+	/* BandPassFilter(): hi pass and low pass in the same pass */
+	for(filter_order_t order=ORDER_2; order<=ORDER_8; order+=2){
+		iir_design_t hp = {.type = IIR_HI_PASS, .sample_frec = SAMPLE_FREC, .cut_frec = 20, .order = order};
+		iir_design_t lp = {.type = IIR_LOW_PASS, .sample_frec = SAMPLE_FREC, .cut_frec = 50, .order = order};
+		iir_filter_t f_hp, f_lp;
+		CHECK(IIRCreate(&f_hp, &hp, NULL));
+		CHECK(IIRCreate(&f_lp, &lp, NULL));
+		memset(delay, 0, sizeof(delay));
+		PerSection(&f_hp, input, ref, SIGNAL_LEN);
+		memset(delay, 0, sizeof(delay));
+		PerSection(&f_lp, ref, ref, SIGNAL_LEN);
+
+		IIRProcessSeries(&f_hp, &f_lp, input, out, SIGNAL_LEN);
+		CHECK(MaxError(out, ref, SIGNAL_LEN, &peak) <= TOL * peak);
+
+		HiPassInit(SAMPLE_FREC, 20, order);
+		LowPassInit(SAMPLE_FREC, 50, order);
+		BandPassFilter(input, out, SIGNAL_LEN);
+		CHECK(MaxError(out, ref, SIGNAL_LEN, &peak) <= TOL * peak);
+		IIRDelete(&f_hp);
+		IIRDelete(&f_lp);
+	}
+	return TEST_RESULT();
+}
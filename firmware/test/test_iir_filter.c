@@ -0,0 +1,240 @@
+/**
+ * @file test_iir_filter.c
+ * @brief Handle based IIR API: same output as the original LowPassFilter()/HiPassFilter(),
+ * independent instances, pool allocation and limits
+ */
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "host_test.h"
+#include "iir_filter.h"
+#include "esp_dsp.h"
+
+#define SAMPLE_FREC	1000.0f
+#define SIGNAL_LEN	2048
+#define BLOCK_LEN	100		/* not a divisor of SIGNAL_LEN: last block is shorter */
+#define TOL			1e-4f
+
+static float input[SIGNAL_LEN];
+static float ref[SIGNAL_LEN];
+static float out[SIGNAL_LEN];
+
+/**
+ * @brief Original implementation: global coefficients and one dsps_biquad_f32 call per section
+ */
+typedef struct {
+	float coeffs[IIR_MAX_SECTIONS][5];
+	float delay[IIR_MAX_SECTIONS][2];
+	uint8_t n;
+} legacy_t;
+
+static void LegacyInit(legacy_t *f, bool low_pass, float cut_frec, uint8_t order){
+	/* Q of each section as in the original tables (1 / 1.414, 1 / 0.765, ...) */
+	static const float inv_q[4][4] = {
+		{1.414f},
+		{0.765f, 1.848f},
+		{0.518f, 1.414f, 1.932f},
+		{0.390f, 1.111f, 1.663f, 1.962f},
+	};
+	memset(f, 0, sizeof(legacy_t));
+	f->n = order / 2;
+	for(uint8_t k=0; k<f->n; k++){
+		if(low_pass){
+			dsps_biquad_gen_lpf_f32(f->coeffs[k], cut_frec / SAMPLE_FREC, 1 / inv_q[f->n - 1][k]);
+		}else{
+			dsps_biquad_gen_hpf_f32(f->coeffs[k], cut_frec / SAMPLE_FREC, 1 / inv_q[f->n - 1][k]);
+		}
+	}
+}
+
+static void LegacyFilter(legacy_t *f, const float *in, float *y, int len){
+	dsps_biquad_f32(in, y, len, f->coeffs[0], f->delay[0]);
+	for(uint8_t k=1; k<f->n; k++){
+		dsps_biquad_f32(y, y, len, f->coeffs[k], f->delay[k]);
+	}
+}
+
+static float MaxError(const float *a, const float *b, int len, float *peak){
+	float err = 0;
+	*peak = 0;
+	for(int i=0; i<len; i++){
+		err = fmaxf(err, fabsf(a[i] - b[i]));
+		*peak = fmaxf(*peak, fabsf(b[i]));
+	}
+	return err;
+}
+
+static void CheckLegacy(bool low_pass, filter_order_t order, float cut_frec){
+	legacy_t legacy;
+	float peak;
+	LegacyInit(&legacy, low_pass, cut_frec, order);
+	if(low_pass){
+		LowPassInit(SAMPLE_FREC, cut_frec, order);
+	}else{
+		HiPassInit(SAMPLE_FREC, cut_frec, order);
+	}
+	/* same blocks on both sides: the state must be kept between calls */
+	for(int i=0; i<SIGNAL_LEN; i+=BLOCK_LEN){
+		int n = (SIGNAL_LEN - i < BLOCK_LEN) ? SIGNAL_LEN - i : BLOCK_LEN;
+		LegacyFilter(&legacy, &input[i], &ref[i], n);
+		if(low_pass){
+			LowPassFilter(&input[i], &out[i], n);
+		}else{
+			HiPassFilter(&input[i], &out[i], n);
+		}
+	}
+	/* Q values of the original tables are rounded to 3 decimals */
+	float err = MaxError(out, ref, SIGNAL_LEN, &peak);
+	if(err > 2e-3f * peak){
+		fprintf(stderr, "%s order %d: max error %g (peak %g)\n", low_pass ? "LP" : "HP", order, err, peak);
+	}
+	CHECK(err <= 2e-3f * peak);
+}
+
+/**
+ * @brief Two tasks filtering different signals with their own filters at the same time
+ */
+typedef struct {
+	iir_filter_t *filter;
+	const float *in;
+	float *out;
+} job_t;
+
+static void *FilterJob(void *param){
+	job_t *job = param;
+	for(int i=0; i<SIGNAL_LEN; i+=BLOCK_LEN){
+		int n = (SIGNAL_LEN - i < BLOCK_LEN) ? SIGNAL_LEN - i : BLOCK_LEN;
+		IIRProcess(job->filter, &job->in[i], &job->out[i], n);
+	}
+	return NULL;
+}
+
+int main(void){
+	srand(1);
+	for(int i=0; i<SIGNAL_LEN; i++){
+		input[i] = sinf(2 * M_PI * 5 * i / SAMPLE_FREC) + 0.5f * sinf(2 * M_PI * 180 * i / SAMPLE_FREC)
+			+ 0.2f * ((float)rand() / RAND_MAX - 0.5f);
+	}
+
+	/* LowPassFilter()/HiPassFilter() against the original per section path */
+	for(filter_order_t order=ORDER_2; order<=ORDER_8; order+=2){
+		CheckLegacy(true, order, 50);
+		CheckLegacy(false, order, 20);
+	}
+
+	/* IIRProcess() and IIRStep() against per section dsps_biquad_f32 with the same coefficients */
+	for(uint8_t order=2; order<=IIR_MAX_ORDER; order+=2){
+		iir_design_t design = {.type = IIR_LOW_PASS, .sample_frec = SAMPLE_FREC, .cut_frec = 80, .order = order};
+		iir_filter_t filter;
+		legacy_t legacy;
+		float peak;
+		CHECK(IIRCreate(&filter, &design, NULL));
+		CHECK(filter.n_sos == order / 2);
+		memset(&legacy, 0, sizeof(legacy));
+		legacy.n = filter.n_sos;
+		for(uint8_t k=0; k<legacy.n; k++){
+			memcpy(legacy.coeffs[k], filter.sos[k].coeffs, sizeof(legacy.coeffs[k]));
+		}
+		LegacyFilter(&legacy, input, ref, SIGNAL_LEN);
+		IIRProcess(&filter, input, out, SIGNAL_LEN);
+		CHECK(MaxError(out, ref, SIGNAL_LEN, &peak) <= TOL * peak);
+		IIRReset(&filter);
+		for(int i=0; i<SIGNAL_LEN; i++){
+			out[i] = IIRStep(&filter, input[i]);
+		}
+		CHECK(MaxError(out, ref, SIGNAL_LEN, &peak) <= TOL * peak);
+		IIRDelete(&filter);
+	}
+
+	/* Other designs: one section generated by the matching dsps_biquad_gen_* function */
+	{
+		iir_design_t design = {.type = IIR_NOTCH, .sample_frec = SAMPLE_FREC, .cut_frec = 180, .q = 2, .gain = -30};
+		iir_sos_t storage[1];
+		iir_filter_t filter;
+		float coeffs[5];
+		CHECK(IIRSections(&design) == 1);
+		CHECK(IIRCreate(&filter, &design, storage));
+		CHECK(filter.sos == storage);
+		dsps_biquad_gen_notch_f32(coeffs, 180 / SAMPLE_FREC, -30, 2);
+		for(int k=0; k<5; k++){
+			CHECK_NEAR(filter.sos[0].coeffs[k], coeffs[k], 1e-6);
+		}
+		IIRDelete(&filter);
+	}
+
+	/* Independent instances: interleaving two filters does not change their outputs */
+	{
+		iir_design_t lp = {.type = IIR_LOW_PASS, .sample_frec = SAMPLE_FREC, .cut_frec = 50, .order = 6};
+		iir_design_t hp = {.type = IIR_HI_PASS, .sample_frec = SAMPLE_FREC, .cut_frec = 20, .order = 4};
+		static float ref_hp[SIGNAL_LEN], out_hp[SIGNAL_LEN];
+		iir_filter_t f_lp, f_hp;
+		float peak;
+		CHECK(IIRCreate(&f_lp, &lp, NULL));
+		CHECK(IIRCreate(&f_hp, &hp, NULL));
+		IIRProcess(&f_lp, input, ref, SIGNAL_LEN);
+		IIRProcess(&f_hp, input, ref_hp, SIGNAL_LEN);
+		IIRReset(&f_lp);
+		IIRReset(&f_hp);
+		for(int i=0; i<SIGNAL_LEN; i+=BLOCK_LEN){
+			int n = (SIGNAL_LEN - i < BLOCK_LEN) ? SIGNAL_LEN - i : BLOCK_LEN;
+			IIRProcess(&f_lp, &input[i], &out[i], n);
+			IIRProcess(&f_hp, &input[i], &out_hp[i], n);
+		}
+		CHECK(MaxError(out, ref, SIGNAL_LEN, &peak) == 0);
+		CHECK(MaxError(out_hp, ref_hp, SIGNAL_LEN, &peak) == 0);
+
+		/* and running them from two threads at the same time */
+		IIRReset(&f_lp);
+		IIRReset(&f_hp);
+		job_t jobs[2] = {{&f_lp, input, out}, {&f_hp, input, out_hp}};
+		pthread_t threads[2];
+		for(int t=0; t<2; t++){
+			pthread_create(&threads[t], NULL, FilterJob, &jobs[t]);
+		}
+		for(int t=0; t<2; t++){
+			pthread_join(threads[t], NULL);
+		}
+		CHECK(MaxError(out, ref, SIGNAL_LEN, &peak) == 0);
+		CHECK(MaxError(out_hp, ref_hp, SIGNAL_LEN, &peak) == 0);
+		IIRDelete(&f_lp);
+		IIRDelete(&f_hp);
+	}
+
+	/* Pool: IIR_POOL_SECTIONS sections, released by IIRDelete() */
+	{
+		iir_design_t design = {.type = IIR_LOW_PASS, .sample_frec = SAMPLE_FREC, .cut_frec = 50, .order = IIR_MAX_ORDER};
+		iir_filter_t filters[IIR_POOL_SECTIONS / IIR_MAX_SECTIONS + 1];
+		int created = 0;
+		for(int i=0; i<IIR_POOL_SECTIONS / IIR_MAX_SECTIONS; i++){
+			created += IIRCreate(&filters[i], &design, NULL);
+		}
+		CHECK(created == IIR_POOL_SECTIONS / IIR_MAX_SECTIONS);
+		CHECK(!IIRCreate(&filters[created], &design, NULL));
+		CHECK(filters[created].sos == NULL);
+		IIRDelete(&filters[1]);
+		CHECK(IIRCreate(&filters[created], &design, NULL));
+		IIRDelete(&filters[created]);
+		for(int i=0; i<created; i++){
+			IIRDelete(&filters[i]);
+		}
+	}
+
+	/* Limits: orders and sections that do not fit the single pass kernel are rejected */
+	{
+		iir_design_t design = {.type = IIR_HI_PASS, .sample_frec = SAMPLE_FREC, .cut_frec = 50, .order = IIR_MAX_ORDER + 2};
+		static const float coeffs[IIR_MAX_SECTIONS + 1][5];
+		iir_sos_t storage[IIR_MAX_SECTIONS + 1];
+		iir_filter_t filter;
+		CHECK(IIRSections(&design) == 0);
+		CHECK(!IIRCreate(&filter, &design, storage));
+		design.order = 3;
+		CHECK(!IIRCreate(&filter, &design, storage));
+		CHECK(!IIRCreateFromSOS(&filter, coeffs, IIR_MAX_SECTIONS + 1, storage));
+		CHECK(filter.n_sos == 0);
+		CHECK(!IIRCreateFromSOS(&filter, coeffs, 0, storage));
+		CHECK(IIRCreateFromSOS(&filter, coeffs, IIR_MAX_SECTIONS, storage));
+		CHECK(filter.n_sos == IIR_MAX_SECTIONS);
+	}
+	return TEST_RESULT();
+}
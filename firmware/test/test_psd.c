@@ -0,0 +1,187 @@
+/**
+ * @file test_psd.c
+ * @brief Welch PSD: peak and power of a known sinusoid, white noise level, averaging
+ * methods and segmentation of incremental blocks
+ */
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "host_test.h"
+#include "psd.h"
+
+#define N			256
+#define FS			1000.0f
+#define LEN			(16 * N)
+
+static float signal[LEN];
+static float psd_out[N / 2];
+static float psd_ref[N / 2];
+static float psd_db[N / 2];
+
+/**
+ * @brief Gaussian noise (Box-Muller)
+ */
+static float Noise(unsigned int *seed){
+	float u1 = ((float)rand_r(seed) + 1) / ((float)RAND_MAX + 2);
+	float u2 = (float)rand_r(seed) / RAND_MAX;
+	return sqrtf(-2 * logf(u1)) * cosf(2 * M_PI * u2);
+}
+
+static psd_config_t Config(uint16_t overlap, fft_window_t window, psd_average_t average, float alpha){
+	psd_config_t config = {
+		.sample_freq = FS,
+		.segment_lenght = N,
+		.overlap = overlap,
+		.window = window,
+		.average = average,
+		.alpha = alpha,
+	};
+	return config;
+}
+
+/**
+ * @brief Sinusoid of amplitude A plus offset: the peak is at its bin, and the PSD integrates
+ * to its power A^2 / 2 around the peak and to the offset^2 around DC
+ */
+static void TestSinusoid(void){
+	psd_t psd;
+	const float a = 1.5f, offset = 0.5f, f0 = 125.0f;
+	for(int i=0; i<LEN; i++){
+		signal[i] = offset + a * sinf(2 * M_PI * f0 * i / FS);
+	}
+	psd_config_t config = Config(N / 2, FFT_WINDOW_HANN, PSD_AVERAGE_LINEAR, 0);
+	CHECK(PSDInit(&psd, &config));
+	CHECK(PSDGet(&psd, psd_out, PSD_SCALE_LINEAR) == 0);
+	CHECK(PSDPush(&psd, signal, LEN) == 2 * LEN / N - 1);
+	CHECK(PSDGet(&psd, psd_out, PSD_SCALE_LINEAR) == 2 * LEN / N - 1);
+	float df = FS / N;
+	uint16_t k0 = f0 / df;
+	uint16_t peak = 4;
+	for(uint16_t k=4; k<N / 2; k++){
+		if(psd_out[k] > psd_out[peak]){
+			peak = k;
+		}
+	}
+	CHECK(peak == k0);
+	// Hann window: the power is spread over the peak bin and its neighbours
+	float tone = 0, dc = 0, rest = 0;
+	for(uint16_t k=0; k<N / 2; k++){
+		if((k >= k0 - 2) && (k <= k0 + 2)){
+			tone += psd_out[k] * df;
+		}else if(k <= 2){
+			dc += psd_out[k] * df;
+		}else{
+			rest += psd_out[k] * df;
+		}
+	}
+	CHECK_NEAR(tone, a * a / 2, 0.01f * a * a / 2);
+	CHECK_NEAR(dc, offset * offset, 0.03f * offset * offset);
+	CHECK(rest < 1e-6f);
+	// dB scale
+	CHECK(PSDGet(&psd, psd_db, PSD_SCALE_DB) == 2 * LEN / N - 1);
+	for(uint16_t k=0; k<N / 2; k++){
+		CHECK_NEAR(psd_db[k], 10 * log10f(psd_out[k] + 1e-20f), 1e-3f);
+	}
+	PSDDeinit(&psd);
+}
+
+/**
+ * @brief White noise of variance s^2: flat one-sided PSD of s^2 / (fs / 2), whatever the window
+ */
+static void TestNoise(fft_window_t window){
+	psd_t psd;
+	unsigned int seed = 7;
+	const float s = 0.2f;
+	psd_config_t config = Config(N / 2, window, PSD_AVERAGE_LINEAR, 0);
+	CHECK(PSDInit(&psd, &config));
+	uint32_t segments = 0;
+	for(int b=0; b<20; b++){
+		for(int i=0; i<LEN; i++){
+			signal[i] = s * Noise(&seed);
+		}
+		segments += PSDPush(&psd, signal, LEN);
+	}
+	CHECK(PSDGet(&psd, psd_out, PSD_SCALE_LINEAR) == segments);
+	double mean = 0;
+	for(uint16_t k=1; k<N / 2; k++){
+		mean += psd_out[k];
+	}
+	mean /= N / 2 - 1;
+	float level = s * s / (FS / 2);
+	printf("window %d: noise level %.4g (expected %.4g), %u segments\n", window, mean, level, segments);
+	CHECK_NEAR(mean, level, 0.03f * level);
+	PSDDeinit(&psd);
+}
+
+/**
+ * @brief Blocks of any size give the same segments as a single push; exponential average
+ * with alpha = 1 keeps the last segment only
+ */
+static void TestBlocks(void){
+	psd_t whole, blocks, last, single;
+	unsigned int seed = 3;
+	for(int i=0; i<LEN; i++){
+		signal[i] = sinf(2 * M_PI * 40 * i / FS) + 0.1f * Noise(&seed);
+	}
+	psd_config_t config = Config(3 * N / 4, FFT_WINDOW_BLACKMAN, PSD_AVERAGE_LINEAR, 0);
+	CHECK(PSDInit(&whole, &config));
+	CHECK(PSDInit(&blocks, &config));
+	uint16_t segments = PSDPush(&whole, signal, LEN);
+	CHECK(segments == (LEN - N) / (N / 4) + 1);
+	uint16_t pushed = 0, from_blocks = 0;
+	while(pushed < LEN){
+		uint16_t n = 1 + rand_r(&seed) % 100;
+		if(n > LEN - pushed){
+			n = LEN - pushed;
+		}
+		from_blocks += PSDPush(&blocks, &signal[pushed], n);
+		pushed += n;
+	}
+	CHECK(from_blocks == segments);
+	PSDGet(&whole, psd_ref, PSD_SCALE_LINEAR);
+	PSDGet(&blocks, psd_out, PSD_SCALE_LINEAR);
+	CHECK(memcmp(psd_ref, psd_out, sizeof(psd_out)) == 0);
+
+	config = Config(3 * N / 4, FFT_WINDOW_BLACKMAN, PSD_AVERAGE_EXPONENTIAL, 1);
+	CHECK(PSDInit(&last, &config));
+	PSDPush(&last, signal, LEN);
+	PSDGet(&last, psd_out, PSD_SCALE_LINEAR);
+	// same as a single segment with the last N samples
+	config = Config(3 * N / 4, FFT_WINDOW_BLACKMAN, PSD_AVERAGE_LINEAR, 0);
+	CHECK(PSDInit(&single, &config));
+	CHECK(PSDPush(&single, &signal[LEN - N], N) == 1);
+	PSDGet(&single, psd_ref, PSD_SCALE_LINEAR);
+	float err = 0, peak = 0;
+	for(uint16_t k=0; k<N / 2; k++){
+		err = fmaxf(err, fabsf(psd_ref[k] - psd_out[k]));
+		peak = fmaxf(peak, psd_ref[k]);
+	}
+	CHECK(err <= 1e-5f * peak);
+
+	// reset discards the average, not the samples: one more hop completes a segment
+	PSDReset(&whole);
+	CHECK(PSDGet(&whole, psd_ref, PSD_SCALE_LINEAR) == 0);
+	CHECK(PSDPush(&whole, signal, N / 4 - 1) == 0);
+	CHECK(PSDPush(&whole, signal, 1) == 1);
+	CHECK(PSDGet(&whole, psd_ref, PSD_SCALE_LINEAR) == 1);
+
+	// invalid parameters
+	psd_t bad;
+	config = Config(N, FFT_WINDOW_HANN, PSD_AVERAGE_LINEAR, 0);
+	CHECK(!PSDInit(&bad, &config));
+	config = Config(0, FFT_WINDOW_HANN, PSD_AVERAGE_EXPONENTIAL, 0);
+	CHECK(!PSDInit(&bad, &config));
+	PSDDeinit(&whole);
+	PSDDeinit(&blocks);
+	PSDDeinit(&last);
+	PSDDeinit(&single);
+}
+
+int main(void){
+	CHECK(FFTInit());
+	TestSinusoid();
+	TestNoise(FFT_WINDOW_HANN);
+	TestNoise(FFT_WINDOW_BLACKMAN_HARRIS);
+	TestBlocks();
+	return TEST_RESULT();
+}
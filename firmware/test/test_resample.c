@@ -0,0 +1,205 @@
+/**
+ * @file test_resample.c
+ * @brief Decimators and rational resampler: streaming in blocks gives the same output as
+ * a single call, frequency response, and time per output sample
+ */
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "host_test.h"
+#include "resample.h"
+
+#define SIGNAL_LEN	4096
+#define BENCH_RUNS	200
+
+static float input[SIGNAL_LEN];
+static float ref[SIGNAL_LEN * RESAMPLE_MAX_FACTOR];
+static float out[SIGNAL_LEN * RESAMPLE_MAX_FACTOR];
+static int16_t input_q15[SIGNAL_LEN];
+static int16_t ref_q15[SIGNAL_LEN];
+static int16_t out_q15[SIGNAL_LEN];
+
+/* Irregular block sizes, some shorter than the decimation factor */
+static const uint16_t blocks[] = {1, 7, 2, 100, 3, 256, 13, 64};
+#define N_BLOCKS	(sizeof(blocks) / sizeof(blocks[0]))
+
+static void Tone(float *x, int len, float f, float amplitude){
+	for(int i=0; i<len; i++){
+		x[i] = amplitude * sinf(2 * M_PI * f * i);
+	}
+}
+
+/**
+ * @brief Amplitude of a tone after the filter transient (from the RMS of the second half)
+ */
+static float Amplitude(const float *y, int len){
+	float sum = 0;
+	for(int i=len / 2; i<len; i++){
+		sum += y[i] * y[i];
+	}
+	return sqrtf(2 * sum / (len - len / 2));
+}
+
+static uint16_t DecimateInBlocks(decimator_t *dec, const float *x, float *y, int len){
+	uint16_t n = 0;
+	for(int i=0, b=0; i<len; b++){
+		uint16_t block = blocks[b % N_BLOCKS];
+		if(block > len - i){
+			block = len - i;
+		}
+		n += DecimatorProcess(dec, &x[i], &y[n], block);
+		i += block;
+	}
+	return n;
+}
+
+static void TestDecimator(uint8_t factor){
+	decimator_t dec;
+	uint16_t n_ref, n_out;
+	CHECK(DecimatorInit(&dec, factor, 16 * factor, FFT_WINDOW_BLACKMAN));
+
+	/* pass band tone keeps its amplitude, tone above the new Nyquist is removed */
+	Tone(input, SIGNAL_LEN, 0.1f / factor, 1);
+	n_ref = DecimatorProcess(&dec, input, ref, SIGNAL_LEN);
+	CHECK(n_ref == SIGNAL_LEN / factor);
+	CHECK_NEAR(Amplitude(ref, n_ref), 1, 0.01);
+	DecimatorReset(&dec);
+	Tone(input, SIGNAL_LEN, 0.8f / factor, 1);
+	n_ref = DecimatorProcess(&dec, input, ref, SIGNAL_LEN);
+	CHECK(Amplitude(ref, n_ref) < 0.01f);
+
+	/* same output in blocks */
+	Tone(input, SIGNAL_LEN, 0.3f / factor, 1);
+	DecimatorReset(&dec);
+	n_ref = DecimatorProcess(&dec, input, ref, SIGNAL_LEN);
+	DecimatorReset(&dec);
+	n_out = DecimateInBlocks(&dec, input, out, SIGNAL_LEN);
+	CHECK(n_out == n_ref);
+	CHECK(memcmp(out, ref, n_ref * sizeof(float)) == 0);
+	DecimatorDeinit(&dec);
+}
+
+static void TestDecimatorQ15(uint8_t factor){
+	decimator_t dec;
+	decimator_q15_t dec_q15;
+	uint16_t n_ref, n_out;
+	CHECK(DecimatorInit(&dec, factor, 16 * factor, FFT_WINDOW_BLACKMAN));
+	CHECK(DecimatorInitQ15(&dec_q15, factor, 16 * factor, FFT_WINDOW_BLACKMAN));
+	srand(factor);
+	for(int i=0; i<SIGNAL_LEN; i++){
+		input[i] = 0.5f * sinf(2 * M_PI * 0.2f / factor * i) + 0.2f * ((float)rand() / RAND_MAX - 0.5f);
+		input_q15[i] = roundf(input[i] * 32767);
+	}
+	/* same response as the float decimator, within the coefficient quantization */
+	n_ref = DecimatorProcess(&dec, input, ref, SIGNAL_LEN);
+	n_out = DecimatorProcessQ15(&dec_q15, input_q15, ref_q15, SIGNAL_LEN);
+	CHECK(n_out == n_ref);
+	float err = 0;
+	for(int i=0; i<n_ref; i++){
+		err = fmaxf(err, fabsf(ref_q15[i] / 32767.0f - ref[i]));
+	}
+	if(err > 2e-3f){
+		fprintf(stderr, "Q15 factor %d: max error %g\n", factor, err);
+	}
+	CHECK(err <= 2e-3f);
+
+	/* same output in blocks */
+	DecimatorResetQ15(&dec_q15);
+	n_out = 0;
+	for(int i=0, b=0; i<SIGNAL_LEN; b++){
+		uint16_t block = blocks[b % N_BLOCKS];
+		if(block > SIGNAL_LEN - i){
+			block = SIGNAL_LEN - i;
+		}
+		n_out += DecimatorProcessQ15(&dec_q15, &input_q15[i], &out_q15[n_out], block);
+		i += block;
+	}
+	CHECK(n_out == n_ref);
+	CHECK(memcmp(out_q15, ref_q15, n_ref * sizeof(int16_t)) == 0);
+	DecimatorDeinit(&dec);
+	DecimatorDeinitQ15(&dec_q15);
+}
+
+static void TestResampler(uint8_t up, uint8_t down){
+	resampler_t rs;
+	const uint16_t taps = 24;
+	uint16_t n_ref, n_out;
+	CHECK(ResamplerInit(&rs, up, down, taps, FFT_WINDOW_BLACKMAN));
+	float f = 0.05f;
+	Tone(input, SIGNAL_LEN, f, 1);
+	n_ref = ResamplerProcess(&rs, input, ref, SIGNAL_LEN);
+	CHECK(abs(n_ref - SIGNAL_LEN * rs.up / rs.down) <= 1);
+
+	/* output is the same tone sampled at up / down times the rate, delayed by half the prototype filter */
+	float delay = (rs.up * taps - 1) / 2.0f;
+	float err = 0;
+	for(int n=n_ref / 2; n<n_ref; n++){
+		float t = (n * rs.down - delay) / rs.up;
+		err = fmaxf(err, fabsf(ref[n] - sinf(2 * M_PI * f * t)));
+	}
+	if(err > 0.01f){
+		fprintf(stderr, "resampler %d/%d: max error %g\n", up, down, err);
+	}
+	CHECK(err <= 0.01f);
+
+	/* same output in blocks */
+	ResamplerReset(&rs);
+	n_out = 0;
+	for(int i=0, b=0; i<SIGNAL_LEN; b++){
+		uint16_t block = blocks[b % N_BLOCKS];
+		if(block > SIGNAL_LEN - i){
+			block = SIGNAL_LEN - i;
+		}
+		n_out += ResamplerProcess(&rs, &input[i], &out[n_out], block);
+		i += block;
+	}
+	CHECK(n_out == n_ref);
+	CHECK(memcmp(out, ref, n_ref * sizeof(float)) == 0);
+	ResamplerDeinit(&rs);
+}
+
+int main(void){
+	for(uint8_t factor=2; factor<=8; factor*=2){
+		TestDecimator(factor);
+		TestDecimatorQ15(factor);
+	}
+	TestResampler(3, 2);
+	TestResampler(2, 3);
+	TestResampler(4, 6);
+	TestResampler(5, 1);
+
+	/* invalid parameters */
+	decimator_t dec;
+	resampler_t rs;
+	CHECK(!DecimatorInit(&dec, 1, 32, FFT_WINDOW_HANN));
+	CHECK(!DecimatorInit(&dec, RESAMPLE_MAX_FACTOR + 1, 32, FFT_WINDOW_HANN));
+	CHECK(!ResamplerInit(&rs, 0, 2, 32, FFT_WINDOW_HANN));
+	CHECK(!ResamplerInit(&rs, 3, 2, 1, FFT_WINDOW_HANN));
+
+	/* benchmark: time per output sample */
+	decimator_q15_t dec_q15;
+	uint16_t n = 0;
+	CHECK(DecimatorInit(&dec, 4, 64, FFT_WINDOW_BLACKMAN));
+	CHECK(DecimatorInitQ15(&dec_q15, 4, 64, FFT_WINDOW_BLACKMAN));
+	CHECK(ResamplerInit(&rs, 3, 2, 32, FFT_WINDOW_BLACKMAN));
+	uint64_t t0 = HostTimeNs();
+	for(int r=0; r<BENCH_RUNS; r++){
+		n = DecimatorProcess(&dec, input, out, SIGNAL_LEN);
+	}
+	uint64_t t1 = HostTimeNs();
+	printf("Decimator (M = 4, 64 taps): %.1f ns per output sample\n", (double)(t1 - t0) / BENCH_RUNS / n);
+	for(int r=0; r<BENCH_RUNS; r++){
+		n = DecimatorProcessQ15(&dec_q15, input_q15, out_q15, SIGNAL_LEN);
+	}
+	uint64_t t2 = HostTimeNs();
+	printf("Decimator Q15 (M = 4, 64 taps): %.1f ns per output sample\n", (double)(t2 - t1) / BENCH_RUNS / n);
+	for(int r=0; r<BENCH_RUNS; r++){
+		n = ResamplerProcess(&rs, input, out, SIGNAL_LEN);
+	}
+	uint64_t t3 = HostTimeNs();
+	printf("Resampler (L/M = 3/2, 32 taps per phase): %.1f ns per output sample\n", (double)(t3 - t2) / BENCH_RUNS / n);
+	DecimatorDeinit(&dec);
+	DecimatorDeinitQ15(&dec_q15);
+	ResamplerDeinit(&rs);
+	return TEST_RESULT();
+}
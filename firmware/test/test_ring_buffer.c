@@ -0,0 +1,158 @@
+/**
+ * @file test_ring_buffer.c
+ * @brief Ring buffer: wrap around, in place access, and a producer thread (ISR side) against
+ * a consumer task woken on watermark
+ */
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include "host_test.h"
+#include "ring_buffer_mcu.h"
+
+#define STRESS_ELEMENTS	2000000
+#define STRESS_LENGHT	1024
+#define WATERMARK		64
+#define MAX_BLOCK		37
+
+/**
+ * @brief Element with a size that is not a power of two
+ */
+typedef struct {
+	uint32_t seq;
+	uint32_t check;
+	uint16_t tag;
+} sample_t;
+
+static ring_buffer_t rb;
+static sample_t storage[STRESS_LENGHT];
+
+static void * Producer(void *param){
+	sample_t block[MAX_BLOCK];
+	uint32_t seq = 0;
+	unsigned int seed = 1;
+	while(seq < STRESS_ELEMENTS){
+		uint32_t n = 1 + rand_r(&seed) % MAX_BLOCK;
+		if(n > STRESS_ELEMENTS - seq){
+			n = STRESS_ELEMENTS - seq;
+		}
+		for(uint32_t i=0; i<n; i++){
+			block[i].seq = seq + i;
+			block[i].check = ~(seq + i);
+			block[i].tag = (seq + i) & 0xFFFF;
+		}
+		/* as an ISR would do it; the rest is retried so every element arrives */
+		uint32_t done = 0;
+		while(done < n){
+			BaseType_t woken = pdFALSE;
+			done += RingBufferWriteFromISR(&rb, &block[done], n - done, &woken);
+			if(done < n){
+				sched_yield();
+			}
+		}
+		seq += n;
+	}
+	return NULL;
+}
+
+static void * LateWriter(void *param){
+	uint32_t data[8] = {0};
+	vTaskDelay(pdMS_TO_TICKS(20));
+	RingBufferWriteFromISR(param, data, 8, NULL);
+	return NULL;
+}
+
+static void TestBasics(void){
+	ring_buffer_t r;
+	uint16_t buffer[8], data[16], out[16];
+	const void *peek;
+	void *reserve;
+	CHECK(!RingBufferInit(&r, buffer, 6, sizeof(uint16_t)));
+	CHECK(RingBufferInit(&r, buffer, 8, sizeof(uint16_t)));
+	for(int i=0; i<16; i++){
+		data[i] = 100 + i;
+	}
+	/* wrap around: the second write and read are split in two chunks */
+	CHECK(RingBufferWrite(&r, data, 5) == 5);
+	CHECK(RingBufferRead(&r, out, 5) == 5);
+	CHECK(RingBufferWrite(&r, data, 6) == 6);
+	CHECK(RingBufferAvailable(&r) == 6);
+	CHECK(RingBufferFree(&r) == 2);
+	CHECK(RingBufferRead(&r, out, 16) == 6);
+	CHECK(memcmp(out, data, 6 * sizeof(uint16_t)) == 0);
+	/* full: the rest is dropped and counted */
+	CHECK(RingBufferWrite(&r, data, 10) == 8);
+	CHECK(RingBufferOverflows(&r) == 2);
+	CHECK(RingBufferRead(&r, out, 3) == 3);
+	CHECK(out[2] == 102);
+	/* in place access, contiguous up to the end of the storage */
+	uint32_t n = RingBufferPeek(&r, &peek);
+	CHECK(n == 8 - ((11 + 3) & 7));
+	CHECK(((const uint16_t *)peek)[0] == 103);
+	RingBufferConsume(&r, n);
+	/* 3 stored from position 0, free space contiguous from 3 to the end */
+	n = RingBufferReserve(&r, &reserve);
+	CHECK(n == 5);
+	((uint16_t *)reserve)[0] = 7;
+	RingBufferCommit(&r, 1);
+	CHECK(RingBufferRead(&r, out, 16) == 4);
+	CHECK(out[0] == 105 && out[2] == 107 && out[3] == 7);
+}
+
+static void TestStress(void){
+	CHECK(RingBufferInit(&rb, storage, STRESS_LENGHT, sizeof(sample_t)));
+	RingBufferSetConsumer(&rb, xTaskGetCurrentTaskHandle(), WATERMARK);
+	pthread_t producer;
+	sample_t block[256];
+	uint32_t expected = 0, wakeups = 0;
+	bool ok = true;
+	uint64_t t0 = HostTimeNs();
+	pthread_create(&producer, NULL, Producer, NULL);
+	while(expected < STRESS_ELEMENTS){
+		uint32_t n = RingBufferWait(&rb, block, 256, pdMS_TO_TICKS(10));
+		wakeups++;
+		for(uint32_t i=0; i<n; i++){
+			ok &= (block[i].seq == expected) && (block[i].check == ~expected) && (block[i].tag == (expected & 0xFFFF));
+			expected++;
+		}
+	}
+	uint64_t t1 = HostTimeNs();
+	pthread_join(producer, NULL);
+	CHECK(ok);
+	CHECK(expected == STRESS_ELEMENTS);
+	CHECK(RingBufferAvailable(&rb) == 0);
+	/* overflows are the elements the producer had to retry */
+	printf("%d elements of %d bytes: %.1f ns per element, %u consumer wake ups, %u retried\n", STRESS_ELEMENTS,
+		(int)sizeof(sample_t), (double)(t1 - t0) / STRESS_ELEMENTS, wakeups, RingBufferOverflows(&rb));
+}
+
+static void TestStaleNotification(void){
+	ring_buffer_t r;
+	uint32_t buffer[16], data[8] = {0}, out[16];
+	CHECK(RingBufferInit(&r, buffer, 16, sizeof(uint32_t)));
+	RingBufferSetConsumer(&r, xTaskGetCurrentTaskHandle(), 8);
+	/* notification left pending: the data was read without waiting */
+	ulTaskNotifyTake(pdTRUE, 0);
+	RingBufferWriteFromISR(&r, data, 8, NULL);
+	CHECK(RingBufferRead(&r, out, 16) == 8);
+	/* the wait is not cut short by the old notification */
+	TickType_t start = xTaskGetTickCount();
+	CHECK(RingBufferWait(&r, out, 16, pdMS_TO_TICKS(50)) == 0);
+	CHECK(xTaskGetTickCount() - start >= pdMS_TO_TICKS(45));
+	/* and still returns as soon as the watermark is reached */
+	RingBufferWriteFromISR(&r, data, 8, NULL);
+	CHECK(RingBufferRead(&r, out, 16) == 8);
+	pthread_t writer;
+	pthread_create(&writer, NULL, LateWriter, &r);
+	start = xTaskGetTickCount();
+	CHECK(RingBufferWait(&r, out, 16, pdMS_TO_TICKS(1000)) == 8);
+	CHECK(xTaskGetTickCount() - start < pdMS_TO_TICKS(500));
+	pthread_join(writer, NULL);
+}
+
+int main(void){
+	TestBasics();
+	TestStaleNotification();
+	TestStress();
+	return TEST_RESULT();
+}
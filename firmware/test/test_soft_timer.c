@@ -0,0 +1,353 @@
+/**
+ * @file test_soft_timer.c
+ * @brief Software timers on a simulated gptimer: expirations against a reference model
+ * (order, no drift, wheel turns), callbacks that start and cancel timers, and the task mode
+ */
+#include <stdatomic.h>
+#include <stdlib.h>
+#include "host_test.h"
+#include "host_periph.h"
+#include "soft_timer_mcu.h"
+
+#define SIM_TIMERS		300
+#define SIM_TICKS		20000
+#define LOG_MAX			(64 * 1024)
+#define TASK_TIMERS		40
+
+/**
+ * @brief Expiration recorded by the callbacks
+ */
+typedef struct {
+	uint32_t tick;
+	uint16_t id;
+} event_t;
+
+static event_t events[LOG_MAX];
+static uint32_t n_events = 0;
+static gptimer_handle_t hw;
+
+static bool Record(void *param){
+	if(n_events < LOG_MAX){
+		events[n_events].tick = SoftTimerTicks();
+		events[n_events].id = (uintptr_t)param;
+		n_events++;
+	}
+	return false;
+}
+
+/**
+ * @brief Tick of the k-th expiration of a timer in the log (0 if there is none)
+ */
+static uint32_t FiredAt(uint16_t id, uint32_t k){
+	for(uint32_t e=0; e<n_events; e++){
+		if((events[e].id == id) && (k-- == 0)){
+			return events[e].tick;
+		}
+	}
+	return 0;
+}
+
+/**
+ * @brief Advance n ticks, returns the yield flag of the last one
+ */
+static bool Tick(uint32_t n){
+	bool yield = false;
+	while(n--){
+		yield = HostGptimerAlarm(hw);
+	}
+	return yield;
+}
+
+static void TestInit(void){
+	SoftTimerInit(0);
+	hw = HostGptimer(0);
+	CHECK(hw != NULL && hw->running);
+	CHECK(hw->config.resolution_hz == 1000000);
+	CHECK(hw->alarm.alarm_count == SOFT_TIMER_TICK_US);
+	CHECK(hw->alarm.flags.auto_reload_on_alarm);
+	/* only one hardware timer */
+	SoftTimerInit(500);
+	CHECK(HostGptimer(1) == NULL);
+	CHECK(hw->alarm.alarm_count == SOFT_TIMER_TICK_US);
+}
+
+static void TestRounding(void){
+	soft_timer_t t[4];
+	uint32_t now = SoftTimerTicks();
+	n_events = 0;
+	/* rounded up to ticks, at least one tick */
+	SoftTimerSetup(&t[0], Record, (void *)0, SOFT_TIMER_ISR);
+	SoftTimerSetup(&t[1], Record, (void *)1, SOFT_TIMER_ISR);
+	SoftTimerSetup(&t[2], Record, (void *)2, SOFT_TIMER_ISR);
+	SoftTimerSetup(&t[3], Record, (void *)3, SOFT_TIMER_ISR);
+	SoftTimerStart(&t[0], 0, 0);
+	SoftTimerStart(&t[1], 1, 0);
+	SoftTimerStart(&t[2], 2500, 0);
+	SoftTimerStart(&t[3], 1000, 1500);
+	CHECK(SoftTimerActive(&t[0]));
+	Tick(7);
+	CHECK(n_events == 7);
+	CHECK(FiredAt(0, 0) == now + 1 && FiredAt(1, 0) == now + 1);
+	CHECK(FiredAt(2, 0) == now + 3);
+	CHECK(FiredAt(3, 0) == now + 1 && FiredAt(3, 1) == now + 3 && FiredAt(3, 2) == now + 5 && FiredAt(3, 3) == now + 7);
+	CHECK(!SoftTimerActive(&t[0]) && !SoftTimerActive(&t[2]));
+	CHECK(SoftTimerActive(&t[3]));
+	SoftTimerCancel(&t[3]);
+	CHECK(!SoftTimerActive(&t[3]));
+	SoftTimerCancel(&t[3]);
+}
+
+/**
+ * @brief Random starts, restarts and cancels of hundreds of timers: every expiration
+ * happens in the tick of the model, periodic ones at start + delay + k * period
+ */
+static void TestSimulation(void){
+	static soft_timer_t timers[SIM_TIMERS];
+	static struct {
+		uint32_t next;
+		uint32_t period;
+		bool active;
+	} model[SIM_TIMERS];
+	static uint16_t expected[SIM_TIMERS];
+	unsigned int seed = 1;
+	uint32_t fired = 0, max_per_tick = 0;
+	bool ok = true;
+	for(int i=0; i<SIM_TIMERS; i++){
+		SoftTimerSetup(&timers[i], Record, (void *)(uintptr_t)i, SOFT_TIMER_ISR);
+		model[i].active = false;
+	}
+	for(uint32_t k=0; k<SIM_TICKS && ok; k++){
+		/* a few operations between ticks; delays up to several turns of the wheel */
+		int ops = rand_r(&seed) % 4;
+		for(int o=0; o<ops; o++){
+			int i = rand_r(&seed) % SIM_TIMERS;
+			if(rand_r(&seed) % 4 == 0){
+				SoftTimerCancel(&timers[i]);
+				model[i].active = false;
+			}else{
+				uint32_t delay = 1 + rand_r(&seed) % (4 * SOFT_TIMER_WHEEL_SIZE);
+				uint32_t period = (rand_r(&seed) % 2) ? 1 + rand_r(&seed) % (3 * SOFT_TIMER_WHEEL_SIZE) : 0;
+				if(rand_r(&seed) % 8 == 0){
+					period = SOFT_TIMER_WHEEL_SIZE;		/* same slot every turn */
+				}
+				SoftTimerStart(&timers[i], delay * SOFT_TIMER_TICK_US, period * SOFT_TIMER_TICK_US);
+				model[i].next = SoftTimerTicks() + delay;
+				model[i].period = period;
+				model[i].active = true;
+			}
+		}
+		n_events = 0;
+		Tick(1);
+		uint32_t now = SoftTimerTicks();
+		/* the model: ids expiring now, in id order */
+		uint16_t n_expected = 0;
+		for(int i=0; i<SIM_TIMERS; i++){
+			if(model[i].active && (model[i].next == now)){
+				expected[n_expected++] = i;
+				if(model[i].period){
+					model[i].next += model[i].period;
+				}else{
+					model[i].active = false;
+				}
+			}
+		}
+		/* each timer once, in this tick */
+		uint8_t seen[SIM_TIMERS] = {0};
+		for(uint32_t e=0; e<n_events; e++){
+			ok &= (events[e].tick == now) && (seen[events[e].id]++ == 0);
+		}
+		ok &= (n_events == n_expected);
+		for(uint16_t e=0; e<n_expected; e++){
+			ok &= (seen[expected[e]] == 1);
+		}
+		for(int i=0; i<SIM_TIMERS; i++){
+			ok &= (SoftTimerActive(&timers[i]) == model[i].active);
+		}
+		if(!ok){
+			fprintf(stderr, "tick %u: %u expirations, %u expected\n", now, n_events, n_expected);
+		}
+		fired += n_events;
+		if(n_events > max_per_tick){
+			max_per_tick = n_events;
+		}
+	}
+	CHECK(ok);
+	printf("%d timers, %d ticks: %u expirations (up to %u in a tick)\n", SIM_TIMERS, SIM_TICKS, fired, max_per_tick);
+	for(int i=0; i<SIM_TIMERS; i++){
+		SoftTimerCancel(&timers[i]);
+	}
+}
+
+/**
+ * @brief Periodic timer over many turns of the wheel: expirations stay on start + k * period
+ */
+static void TestDrift(void){
+	soft_timer_t t;
+	n_events = 0;
+	SoftTimerSetup(&t, Record, (void *)7, SOFT_TIMER_ISR);
+	uint32_t start = SoftTimerTicks();
+	SoftTimerStart(&t, 3000, 3000);
+	Tick(3 * 1000 + 2);
+	CHECK(n_events == 1000);
+	bool ok = true;
+	for(uint32_t k=0; k<n_events; k++){
+		ok &= (events[k].tick == start + 3 * (k + 1));
+	}
+	CHECK(ok);
+	/* restarting a running timer replaces its schedule */
+	n_events = 0;
+	start = SoftTimerTicks();
+	SoftTimerStart(&t, 10000, 0);
+	Tick(9);
+	CHECK(n_events == 0);
+	Tick(5);
+	CHECK(n_events == 1 && events[0].tick == start + 10);
+	CHECK(!SoftTimerActive(&t));
+}
+
+/* Callbacks that start and cancel timers */
+static soft_timer_t ta, tb, tc, td;
+
+static bool CancelOthers(void *param){
+	Record(param);
+	SoftTimerCancel(&tb);
+	SoftTimerCancel(&td);
+	SoftTimerCancel(&ta);
+	/* into the slot being visited, one turn later */
+	SoftTimerStart(&tc, SOFT_TIMER_WHEEL_SIZE * SOFT_TIMER_TICK_US, 0);
+	return false;
+}
+
+static bool Yield(void *param){
+	Record(param);
+	return true;
+}
+
+static bool Rearm(void *param){
+	Record(param);
+	if(n_events < 5){
+		SoftTimerStart(&ta, n_events * SOFT_TIMER_TICK_US, 0);
+	}
+	return false;
+}
+
+static void TestCallbacks(void){
+	uint32_t now = SoftTimerTicks();
+	n_events = 0;
+	/* a (periodic) cancels itself, b in the same tick and d one turn later; b still runs */
+	SoftTimerSetup(&ta, CancelOthers, (void *)1, SOFT_TIMER_ISR);
+	SoftTimerSetup(&tb, Record, (void *)2, SOFT_TIMER_ISR);
+	SoftTimerSetup(&tc, Record, (void *)3, SOFT_TIMER_ISR);
+	SoftTimerSetup(&td, Record, (void *)4, SOFT_TIMER_ISR);
+	SoftTimerStart(&tb, 10000, 0);
+	SoftTimerStart(&ta, 10000, 1000);
+	SoftTimerStart(&td, (10 + SOFT_TIMER_WHEEL_SIZE) * SOFT_TIMER_TICK_US, 0);
+	Tick(10);
+	CHECK(n_events == 2);
+	CHECK(FiredAt(1, 0) == now + 10 && FiredAt(2, 0) == now + 10);
+	CHECK(!SoftTimerActive(&ta) && !SoftTimerActive(&tb) && !SoftTimerActive(&td));
+	CHECK(SoftTimerActive(&tc));
+	Tick(2 * SOFT_TIMER_WHEEL_SIZE);
+	CHECK(n_events == 3);
+	CHECK(FiredAt(3, 0) == now + 10 + SOFT_TIMER_WHEEL_SIZE);
+
+	/* one-shot timer restarted from its callback */
+	n_events = 0;
+	now = SoftTimerTicks();
+	SoftTimerSetup(&ta, Rearm, (void *)5, SOFT_TIMER_ISR);
+	SoftTimerStart(&ta, 1000, 0);
+	Tick(20);
+	CHECK(n_events == 5);
+	CHECK(events[1].tick == now + 2 && events[2].tick == now + 4 && events[4].tick == now + 11);
+
+	/* the ISR yields if any callback of the tick woke up a task */
+	SoftTimerSetup(&ta, Yield, (void *)6, SOFT_TIMER_ISR);
+	SoftTimerSetup(&tb, Record, (void *)7, SOFT_TIMER_ISR);
+	SoftTimerStart(&ta, 2000, 0);
+	SoftTimerStart(&tb, 1000, 1000);
+	CHECK(!Tick(1));
+	CHECK(Tick(1));
+	CHECK(!Tick(1));
+	SoftTimerCancel(&tb);
+}
+
+/* Task mode */
+static TaskHandle_t main_task;
+static TaskHandle_t callback_task = NULL;
+static atomic_int task_calls = 0;
+
+static bool Blocker(void *param){
+	callback_task = xTaskGetCurrentTaskHandle();
+	xTaskNotifyGive(main_task);
+	ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+	return false;
+}
+
+static bool Counter(void *param){
+	atomic_fetch_add(&task_calls, 1);
+	xTaskNotifyGive(main_task);
+	return false;
+}
+
+static void TestTask(void){
+	static soft_timer_t timers[TASK_TIMERS];
+	soft_timer_t blocker;
+	main_task = xTaskGetCurrentTaskHandle();
+	ulTaskNotifyTake(pdTRUE, 0);
+
+	/* the callback runs in the task, and the ISR asks for a yield */
+	SoftTimerSetup(&timers[0], Counter, NULL, SOFT_TIMER_TASK);
+	SoftTimerStart(&timers[0], 1000, 0);
+	CHECK(Tick(1));
+	CHECK(ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000)) == 1);
+	CHECK(atomic_load(&task_calls) == 1);
+
+	/* task busy: the queue holds SOFT_TIMER_QUEUE_SIZE callbacks, the rest are lost */
+	SoftTimerSetup(&blocker, Blocker, NULL, SOFT_TIMER_TASK);
+	SoftTimerStart(&blocker, 1000, 0);
+	for(int i=0; i<TASK_TIMERS; i++){
+		SoftTimerSetup(&timers[i], Counter, NULL, SOFT_TIMER_TASK);
+		SoftTimerStart(&timers[i], 2000, 0);
+	}
+	Tick(1);
+	CHECK(ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000)) == 1);
+	CHECK(callback_task != NULL && callback_task != main_task);
+	Tick(1);
+	CHECK(SoftTimerLostCallbacks() == TASK_TIMERS - SOFT_TIMER_QUEUE_SIZE);
+	atomic_store(&task_calls, 0);
+	xTaskNotifyGive(callback_task);
+	for(int k=0; k<SOFT_TIMER_QUEUE_SIZE && ulTaskNotifyTake(pdFALSE, pdMS_TO_TICKS(1000)); k++);
+	CHECK(atomic_load(&task_calls) == SOFT_TIMER_QUEUE_SIZE);
+}
+
+static void Benchmark(void){
+	static soft_timer_t timers[SIM_TIMERS];
+	for(int i=0; i<SIM_TIMERS; i++){
+		SoftTimerSetup(&timers[i], Record, (void *)(uintptr_t)i, SOFT_TIMER_ISR);
+		SoftTimerStart(&timers[i], 1000 * (1 + i), 1000 * (1 + i % 50));
+	}
+	uint64_t t0 = HostTimeNs();
+	for(int k=0; k<SIM_TICKS; k++){
+		n_events = 0;
+		Tick(1);
+	}
+	uint64_t t1 = HostTimeNs();
+	for(int i=0; i<SIM_TIMERS; i++){
+		SoftTimerStart(&timers[i], 1000, 0);
+		SoftTimerCancel(&timers[i]);
+	}
+	uint64_t t2 = HostTimeNs();
+	printf("%d periodic timers: %.1f ns per tick, %.1f ns per start + cancel\n", SIM_TIMERS,
+		(double)(t1 - t0) / SIM_TICKS, (double)(t2 - t1) / SIM_TIMERS);
+}
+
+int main(void){
+	TestInit();
+	TestRounding();
+	TestSimulation();
+	TestDrift();
+	TestCallbacks();
+	TestTask();
+	Benchmark();
+	return TEST_RESULT();
+}
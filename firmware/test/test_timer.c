@@ -0,0 +1,195 @@
+/**
+ * @file test_timer.c
+ * @brief Timer callbacks: context switch requests of TimerNotifyFromISR(), alarm and wake up
+ * statistics (TIMER_INSTRUMENTATION), and periodic activities with absolute deadlines
+ */
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+#include "host_test.h"
+#include "host_periph.h"
+#include "esp_timer.h"
+#include "timer_mcu.h"
+
+#define PERIOD_US	1000
+
+static TaskHandle_t main_task;
+static TaskHandle_t waiting_task = NULL;
+static gptimer_handle_t hw;
+
+/* What the callback of TIMER_A does */
+typedef enum {
+	CALLBACK_LEGACY,			/* vTaskNotifyGiveFromISR() without yield flag */
+	CALLBACK_NOTIFY,			/* TimerNotifyFromISR() of the main task (not waiting) */
+	CALLBACK_NOTIFY_WAITING,	/* TimerNotifyFromISR() of a waiting task, then of the main task */
+} callback_t;
+
+static callback_t mode;
+static BaseType_t notify_woken;
+
+void DelayUs(uint16_t usec){
+	HostTimeAdvanceUs(usec);
+}
+
+static void FuncTimerA(void *param){
+	(void)param;
+	switch(mode){
+		case CALLBACK_LEGACY:
+			vTaskNotifyGiveFromISR(main_task, NULL);
+		break;
+		case CALLBACK_NOTIFY:
+			notify_woken = TimerNotifyFromISR(TIMER_A, main_task);
+		break;
+		case CALLBACK_NOTIFY_WAITING:
+			notify_woken = TimerNotifyFromISR(TIMER_A, waiting_task);
+			TimerNotifyFromISR(TIMER_A, main_task);
+		break;
+	}
+}
+
+static void WaitingTask(void *param){
+	(void)param;
+	waiting_task = xTaskGetCurrentTaskHandle();
+	xTaskNotifyGive(main_task);
+	ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+	xTaskNotifyGive(main_task);
+}
+
+/**
+ * @brief The timer interrupt yields only when a notified task asked for it
+ */
+static void TestYield(void){
+	timer_config_t timer = {
+		.timer = TIMER_A,
+		.period = PERIOD_US,
+		.func_p = FuncTimerA,
+		.param_p = NULL,
+	};
+	main_task = xTaskGetCurrentTaskHandle();
+	TimerInit(&timer);
+	TimerStart(TIMER_A);
+	hw = HostGptimer(0);
+	CHECK(hw != NULL);
+
+	/* callbacks that do not report keep yielding, as before */
+	mode = CALLBACK_LEGACY;
+	CHECK(HostGptimerAlarm(hw));
+	CHECK(ulTaskNotifyTake(pdTRUE, 0) == 1);
+
+	/* the notified task is not waiting: no context switch */
+	mode = CALLBACK_NOTIFY;
+	notify_woken = pdTRUE;
+	CHECK(!HostGptimerAlarm(hw));
+	CHECK(notify_woken == pdFALSE);
+	CHECK(ulTaskNotifyTake(pdTRUE, 0) == 1);
+
+	/* any notified task that asks for it makes the interrupt yield */
+	xTaskCreate(WaitingTask, "waiting", 2048, NULL, 5, NULL);
+	CHECK(ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000)) == 1);
+	struct timespec blocked = {.tv_nsec = 20000000};
+	nanosleep(&blocked, NULL);
+	mode = CALLBACK_NOTIFY_WAITING;
+	CHECK(HostGptimerAlarm(hw));
+	CHECK(notify_woken == pdTRUE);
+	CHECK(ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000)) >= 1);
+
+	/* the request is not kept for the next alarm */
+	mode = CALLBACK_NOTIFY;
+	CHECK(!HostGptimerAlarm(hw));
+	ulTaskNotifyTake(pdTRUE, 0);
+}
+
+/**
+ * @brief Alarms, wake up latencies and overruns of TIMER_A
+ */
+static void TestStats(void){
+	timer_stats_t stats;
+	TimerResetStats(TIMER_A);
+	mode = CALLBACK_NOTIFY;
+	for(int i=0; i<10; i++){
+		HostGptimerAlarm(hw);
+		HostTimeAdvanceUs(37);
+		TimerTaskWoken(TIMER_A);
+		HostTimeAdvanceUs(PERIOD_US - 37);
+	}
+	/* two alarms before the task wakes up */
+	HostGptimerAlarm(hw);
+	HostTimeAdvanceUs(PERIOD_US);
+	HostGptimerAlarm(hw);
+	TimerTaskWoken(TIMER_A);
+	TimerGetStats(TIMER_A, &stats);
+	CHECK(stats.alarms == 12);
+	CHECK(stats.wakes == 11);
+	CHECK(stats.overruns == 1);
+	CHECK(stats.period_min == PERIOD_US && stats.period_max == PERIOD_US);
+	CHECK(stats.wake_latency_min == 0 && stats.wake_latency_max == 37);
+	/* 37 us in [32, 64) */
+	CHECK(stats.wake_histogram[6] == 10 && stats.wake_histogram[0] == 1);
+	ulTaskNotifyTake(pdTRUE, 0);
+}
+
+/**
+ * @brief Deadlines of a periodic activity stay at epoch + phase + k * period whatever the
+ * execution time, and each overrun policy advances them as documented
+ */
+static void TestPeriodic(void){
+	timer_periodic_t periodic;
+	unsigned int seed = 1;
+	const uint32_t period = 1500, phase = 300;
+	int64_t epoch = TimerEpoch();
+	CHECK(epoch > 0 && TimerEpoch() == epoch);
+	TimerPeriodicInit(&periodic, period, phase, TIMER_OVERRUN_SKIP);
+	CHECK((periodic.next - epoch - phase) % period == 0 && periodic.next > esp_timer_get_time());
+	bool aligned = true;
+	for(int i=0; i<1000; i++){
+		aligned &= (TimerPeriodicWait(&periodic) == 0);
+		aligned &= ((esp_timer_get_time() - epoch - phase) % period == 0);
+		/* work shorter than the period */
+		HostTimeAdvanceUs(rand_r(&seed) % period);
+	}
+	CHECK(aligned);
+	CHECK(periodic.overruns == 0);
+
+	/* skip: the late activation runs now, the missed one is dropped and the phase is kept */
+	int64_t deadline = periodic.next;
+	HostTimeAdvanceUs(deadline + period + 400 - esp_timer_get_time());
+	CHECK(TimerPeriodicWait(&periodic) == 1);
+	CHECK(esp_timer_get_time() == deadline + period + 400);
+	CHECK(TimerPeriodicWait(&periodic) == 0);
+	CHECK(esp_timer_get_time() == deadline + 2 * period);
+	CHECK(periodic.overruns == 1);
+
+	/* catch up: the missed activation runs late too, without waiting */
+	periodic.policy = TIMER_OVERRUN_CATCH_UP;
+	deadline = periodic.next;
+	HostTimeAdvanceUs(deadline + period + 400 - esp_timer_get_time());
+	CHECK(TimerPeriodicWait(&periodic) == 1);
+	CHECK(TimerPeriodicWait(&periodic) == 0);
+	CHECK(esp_timer_get_time() == deadline + period + 400);
+	CHECK(TimerPeriodicWait(&periodic) == 0);
+	CHECK(esp_timer_get_time() == deadline + 2 * period);
+	CHECK(periodic.overruns == 2);
+
+	/* report: the schedule restarts one period after the late call */
+	periodic.policy = TIMER_OVERRUN_REPORT;
+	HostTimeAdvanceUs(periodic.next + period + 400 - esp_timer_get_time());
+	int64_t late = esp_timer_get_time();
+	CHECK(TimerPeriodicWait(&periodic) == 1);
+	CHECK(TimerPeriodicWait(&periodic) == 0);
+	CHECK(esp_timer_get_time() == late + period);
+	CHECK(periodic.overruns == 3);
+
+	/* long periods: RTOS ticks, then waits of at most 16 bits */
+	TimerPeriodicInit(&periodic, 200000, 0, TIMER_OVERRUN_SKIP);
+	CHECK(TimerPeriodicWait(&periodic) == 0);
+	CHECK((esp_timer_get_time() - epoch) % 200000 == 0);
+}
+
+int main(void){
+	/* the epoch is set on first use, and 0 means not set yet */
+	HostTimeAdvanceUs(1000);
+	TestYield();
+	TestStats();
+	TestPeriodic();
+	return TEST_RESULT();
+}
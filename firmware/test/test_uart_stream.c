@@ -0,0 +1,258 @@
+/**
+ * @file test_uart_stream.c
+ * @brief Binary stream: frames sent to a simulated UART are decoded back (resynchronization,
+ * sequence and CRC checks) and compared with the samples of each format
+ */
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "host_test.h"
+#include "host_periph.h"
+#include "uart_mcu.h"
+
+#define SIGNAL_LEN	1300
+#define MAX_FRAMES	400
+#define BENCH_RUNS	2000
+
+/**
+ * @brief Frame decoded from the UART bytes
+ */
+typedef struct {
+	uint8_t sequence;
+	uint8_t format;
+	uint16_t n;
+	uint16_t samples[UART_STREAM_MAX_SAMPLES];
+} frame_t;
+
+static frame_t frames[MAX_FRAMES];
+static uint16_t signal[SIGNAL_LEN];
+static uint16_t decoded[SIGNAL_LEN];
+static uint8_t bytes[HOST_UART_TX_MAX];
+static uint8_t frame[UART_STREAM_MAX_FRAME];
+
+/**
+ * @brief Bitwise CRC16-CCITT, independent of the table used by the driver
+ */
+static uint16_t Crc16(const uint8_t *data, uint32_t lenght){
+	uint16_t crc = 0xFFFF;
+	for(uint32_t i=0; i<lenght; i++){
+		crc ^= data[i] << 8;
+		for(int b=0; b<8; b++){
+			crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+		}
+	}
+	return crc;
+}
+
+static bool DecodePayload(uint8_t format, uint16_t n, const uint8_t *p, uint16_t lenght, uint16_t *samples){
+	const uint8_t *end = p + lenght;
+	int32_t prev = 0;
+	switch(format){
+		case UART_STREAM_RAW16:
+			if(lenght != 2 * n){
+				return false;
+			}
+			for(int i=0; i<n; i++){
+				samples[i] = p[2*i] | (p[2*i+1] << 8);
+			}
+			return true;
+		case UART_STREAM_PACKED12:
+			if(lenght != 3 * (n / 2) + 2 * (n % 2)){
+				return false;
+			}
+			for(int i=0; i+1<n; i+=2, p+=3){
+				samples[i] = p[0] | ((p[1] & 0x0F) << 8);
+				samples[i+1] = (p[1] >> 4) | (p[2] << 4);
+			}
+			if(n % 2){
+				samples[n-1] = p[0] | ((p[1] & 0x0F) << 8);
+			}
+			return true;
+		case UART_STREAM_DELTA:
+			for(int i=0; i<n; i++){
+				uint32_t value = 0;
+				int shift = 0;
+				do{
+					if(p == end){
+						return false;
+					}
+					value |= (uint32_t)(*p & 0x7F) << shift;
+					shift += 7;
+				}while(*p++ & 0x80);
+				prev += (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+				samples[i] = prev;
+			}
+			return p == end;
+	}
+	return false;
+}
+
+/**
+ * @brief Decode every valid frame: the receiver searches the sync bytes and skips one byte
+ * whenever the header or the CRC are wrong
+ *
+ * @return int Number of frames decoded
+ */
+static int Decode(const uint8_t *data, uint32_t lenght, uint32_t *rejected){
+	int n_frames = 0;
+	uint32_t i = 0;
+	*rejected = 0;
+	while((i + UART_STREAM_HEADER + 2 <= lenght) && (n_frames < MAX_FRAMES)){
+		if((data[i] != UART_STREAM_SYNC_0) || (data[i+1] != UART_STREAM_SYNC_1)){
+			i++;
+			continue;
+		}
+		uint16_t n = data[i+4] | (data[i+5] << 8);
+		uint16_t payload = data[i+6] | (data[i+7] << 8);
+		uint32_t size = UART_STREAM_HEADER + payload + 2;
+		if((n == 0) || (n > UART_STREAM_MAX_SAMPLES) || (size > UART_STREAM_MAX_FRAME) || (i + size > lenght)){
+			i++;
+			continue;
+		}
+		uint16_t crc = data[i+size-2] | (data[i+size-1] << 8);
+		frame_t *f = &frames[n_frames];
+		if((crc != Crc16(&data[i+2], size - 4)) ||
+			!DecodePayload(data[i+3], n, &data[i+UART_STREAM_HEADER], payload, f->samples)){
+			(*rejected)++;
+			i++;
+			continue;
+		}
+		f->sequence = data[i+2];
+		f->format = data[i+3];
+		f->n = n;
+		n_frames++;
+		i += size;
+	}
+	return n_frames;
+}
+
+/**
+ * @brief Concatenate the samples of the decoded frames, checking format and consecutive sequence numbers
+ */
+static uint32_t Join(int n_frames, uint8_t format, uint8_t first_sequence){
+	uint32_t n = 0;
+	for(int f=0; f<n_frames; f++){
+		CHECK(frames[f].format == format);
+		CHECK(frames[f].sequence == (uint8_t)(first_sequence + f));
+		memcpy(&decoded[n], frames[f].samples, frames[f].n * sizeof(uint16_t));
+		n += frames[f].n;
+	}
+	return n;
+}
+
+/**
+ * @brief Slow signal with a few full scale jumps
+ */
+static void Signal(uint16_t full_scale){
+	for(int i=0; i<SIGNAL_LEN; i++){
+		signal[i] = full_scale / 2 + (full_scale / 3) * sinf(2 * M_PI * i / 250.0f);
+	}
+	signal[0] = full_scale;
+	signal[100] = 0;
+	signal[101] = full_scale;
+	signal[SIGNAL_LEN - 1] = 0;
+}
+
+static void TestLoopback(uart_stream_format_t format, uint16_t full_scale){
+	uart_stream_t stream;
+	uint32_t lenght, rejected;
+	static const uint8_t garbage[] = {0x00, UART_STREAM_SYNC_0, 0x13, UART_STREAM_SYNC_0, UART_STREAM_SYNC_1, 0xFF, 0xFF};
+	Signal(full_scale);
+	UartStreamInit(&stream, UART_CONNECTOR, format);
+	HostUartTxClear(UART_NUM_1);
+
+	/* the receiver starts in the middle of something else; samples are split in frames of 512 */
+	uart_write_bytes(UART_NUM_1, garbage, sizeof(garbage));
+	UartStreamSend(&stream, signal, SIGNAL_LEN);
+	const uint8_t *tx = HostUartTx(UART_NUM_1, &lenght);
+	int n_frames = Decode(tx, lenght, &rejected);
+	CHECK(n_frames == 3);
+	CHECK(frames[0].n == UART_STREAM_MAX_SAMPLES && frames[2].n == SIGNAL_LEN - 2 * UART_STREAM_MAX_SAMPLES);
+	CHECK(Join(n_frames, format, 0) == SIGNAL_LEN);
+	CHECK(memcmp(decoded, signal, sizeof(signal)) == 0);
+	CHECK(stream.sequence == 3);
+	printf("format %d: %.2f bytes per sample\n", format, (double)(lenght - sizeof(garbage)) / SIGNAL_LEN);
+
+	/* a corrupted frame is rejected and the next one is found again */
+	memcpy(bytes, tx, lenght);
+	bytes[sizeof(garbage) + UART_STREAM_HEADER + 20] ^= 0x04;
+	n_frames = Decode(bytes, lenght, &rejected);
+	CHECK(n_frames == 2);
+	CHECK(rejected == 1);
+	CHECK(frames[0].sequence == 1 && frames[1].sequence == 2);
+
+	/* short frames, odd number of samples */
+	HostUartTxClear(UART_NUM_1);
+	for(uint16_t n=1; n<=5; n++){
+		UartStreamSend(&stream, &signal[98], n);
+	}
+	tx = HostUartTx(UART_NUM_1, &lenght);
+	n_frames = Decode(tx, lenght, &rejected);
+	CHECK(n_frames == 5);
+	for(int f=0; f<n_frames; f++){
+		CHECK(frames[f].sequence == 3 + f);
+		CHECK(frames[f].n == f + 1);
+		CHECK(memcmp(frames[f].samples, &signal[98], frames[f].n * sizeof(uint16_t)) == 0);
+	}
+}
+
+static void TestSequence(void){
+	uart_stream_t stream;
+	uint32_t lenght, rejected;
+	UartStreamInit(&stream, UART_PC, UART_STREAM_DELTA);
+	HostUartTxClear(UART_NUM_0);
+	/* the sequence number wraps after 256 frames */
+	for(int f=0; f<300; f++){
+		uint16_t sample = f;
+		UartStreamSend(&stream, &sample, 1);
+	}
+	const uint8_t *tx = HostUartTx(UART_NUM_0, &lenght);
+	int n_frames = Decode(tx, lenght, &rejected);
+	CHECK(n_frames == 300);
+	CHECK(rejected == 0);
+	CHECK(frames[255].sequence == 255 && frames[256].sequence == 0 && frames[299].sequence == 43);
+	CHECK(frames[299].samples[0] == 299);
+
+	/* invalid lenghts are not encoded and do not use a sequence number */
+	uint8_t sequence = stream.sequence;
+	CHECK(UartStreamEncode(&stream, signal, 0, frame) == 0);
+	CHECK(UartStreamEncode(&stream, signal, UART_STREAM_MAX_SAMPLES + 1, frame) == 0);
+	CHECK(stream.sequence == sequence);
+	HostUartTxClear(UART_NUM_0);
+	UartStreamSend(&stream, signal, 0);
+	HostUartTx(UART_NUM_0, &lenght);
+	CHECK(lenght == 0);
+
+	/* worst case: full scale jumps in every sample fit in UART_STREAM_MAX_FRAME */
+	for(int i=0; i<UART_STREAM_MAX_SAMPLES; i++){
+		signal[i] = (i % 2) ? 0xFFFF : 0;
+	}
+	uint16_t size = UartStreamEncode(&stream, signal, UART_STREAM_MAX_SAMPLES, frame);
+	CHECK(size > 0 && size <= UART_STREAM_MAX_FRAME);
+	CHECK(Decode(frame, size, &rejected) == 1);
+	CHECK(memcmp(frames[0].samples, signal, UART_STREAM_MAX_SAMPLES * sizeof(uint16_t)) == 0);
+}
+
+static void Benchmark(void){
+	uart_stream_t stream;
+	Signal(4095);
+	for(uart_stream_format_t format=UART_STREAM_RAW16; format<=UART_STREAM_DELTA; format++){
+		UartStreamInit(&stream, UART_PC, format);
+		uint64_t t0 = HostTimeNs();
+		for(int r=0; r<BENCH_RUNS; r++){
+			UartStreamEncode(&stream, signal, UART_STREAM_MAX_SAMPLES, frame);
+		}
+		uint64_t t1 = HostTimeNs();
+		printf("format %d: %.2f ns per sample encoded\n", format, (double)(t1 - t0) / BENCH_RUNS / UART_STREAM_MAX_SAMPLES);
+	}
+}
+
+int main(void){
+	TestLoopback(UART_STREAM_RAW16, 0xFFFF);
+	TestLoopback(UART_STREAM_PACKED12, 4095);
+	TestLoopback(UART_STREAM_DELTA, 4095);
+	TestLoopback(UART_STREAM_DELTA, 0xFFFF);
+	TestSequence();
+	Benchmark();
+	return TEST_RESULT();
+}
@@ -0,0 +1,149 @@
+#!/usr/bin/env python3
+"""Decoder for the binary sample stream sent by UartStreamSend() (uart_mcu).
+
+Frame layout (multi-byte fields are little endian):
+
+    | 0xA5 0x5A | sequence | format | samples (2) | payload lenght (2) | payload | CRC16 (2) |
+
+CRC16 is CCITT (polynomial 0x1021, initial value 0xFFFF) computed from the
+sequence byte to the end of the payload.
+
+Usage:
+    uart_stream.py /dev/ttyUSB0 -b 921600 --plot     live plot (needs pyserial and matplotlib)
+    uart_stream.py capture.bin --csv samples.csv     decode a raw capture
+"""
+
+import argparse
+import struct
+import sys
+
+SYNC = b"\xA5\x5A"
+HEADER = 8
+MAX_SAMPLES = 512
+RAW16, PACKED12, DELTA = 0, 1, 2
+
+
+def crc16(data, crc=0xFFFF):
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+            crc &= 0xFFFF
+    return crc
+
+
+def decode_payload(fmt, n, payload):
+    if fmt == RAW16:
+        return list(struct.unpack("<%dH" % n, payload[:2 * n]))
+    if fmt == PACKED12:
+        samples = []
+        for i in range(0, len(payload) - 2, 3):
+            b0, b1, b2 = payload[i:i + 3]
+            samples += [b0 | (b1 & 0x0F) << 8, b1 >> 4 | b2 << 4]
+        if n % 2:
+            samples.append(payload[-2] | (payload[-1] & 0x0F) << 8)
+        return samples[:n]
+    if fmt == DELTA:
+        samples, prev, value, shift = [], 0, 0, 0
+        for byte in payload:
+            value |= (byte & 0x7F) << shift
+            shift += 7
+            if not byte & 0x80:
+                prev += (value >> 1) ^ -(value & 1)
+                samples.append(prev)
+                value, shift = 0, 0
+        return samples
+    raise ValueError("unknown format %d" % fmt)
+
+
+class Decoder:
+    """Incremental frame decoder: feed() bytes, get lists of samples back."""
+
+    def __init__(self):
+        self.buffer = bytearray()
+        self.sequence = None
+        self.frames = 0
+        self.crc_errors = 0
+        self.lost_frames = 0
+
+    def feed(self, data):
+        self.buffer += data
+        blocks = []
+        while True:
+            start = self.buffer.find(SYNC)
+            if start < 0:
+                del self.buffer[:-1]
+                return blocks
+            del self.buffer[:start]
+            if len(self.buffer) < HEADER:
+                return blocks
+            seq, fmt, n, lenght = struct.unpack_from("<BBHH", self.buffer, 2)
+            if n > MAX_SAMPLES or lenght > 3 * MAX_SAMPLES:
+                del self.buffer[:2]
+                continue
+            size = HEADER + lenght + 2
+            if len(self.buffer) < size:
+                return blocks
+            (crc,) = struct.unpack_from("<H", self.buffer, HEADER + lenght)
+            if crc != crc16(self.buffer[2:HEADER + lenght]):
+                # false sync or corrupted frame: resynchronize after this sync
+                self.crc_errors += 1
+                del self.buffer[:2]
+                continue
+            if self.sequence is not None:
+                self.lost_frames += (seq - self.sequence - 1) & 0xFF
+            self.sequence = seq
+            self.frames += 1
+            blocks.append(decode_payload(fmt, n, bytes(self.buffer[HEADER:HEADER + lenght])))
+            del self.buffer[:size]
+
+
+def open_source(name, baud):
+    if not (name.startswith("/dev/") or name.upper().startswith("COM")):
+        return open(name, "rb", buffering=0)
+    try:
+        import serial
+    except ImportError:
+        sys.exit("pyserial is required to read from a serial port")
+    return serial.Serial(name, baud, timeout=0.1)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("source", help="serial port or raw capture file")
+    parser.add_argument("-b", "--baud", type=int, default=115200)
+    parser.add_argument("--csv", help="write decoded samples to this file")
+    parser.add_argument("--plot", action="store_true", help="live plot of the last --window samples")
+    parser.add_argument("--window", type=int, default=2000)
+    args = parser.parse_args()
+
+    source = open_source(args.source, args.baud)
+    decoder = Decoder()
+    csv = open(args.csv, "w") if args.csv else None
+    history = []
+    if args.plot:
+        import matplotlib.pyplot as plt
+        plt.ion()
+        line, = plt.plot([], [])
+    try:
+        while True:
+            data = source.read(4096)
+            if not data and not hasattr(source, "in_waiting"):
+                break
+            for block in decoder.feed(data):
+                if csv:
+                    csv.writelines("%d\n" % s for s in block)
+                history = (history + block)[-args.window:]
+            if args.plot and history:
+                line.set_data(range(len(history)), history)
+                plt.gca().relim()
+                plt.gca().autoscale_view()
+                plt.pause(0.001)
+    except KeyboardInterrupt:
+        pass
+    print("frames: %d  lost: %d  crc errors: %d" % (decoder.frames, decoder.lost_frames, decoder.crc_errors),
+          file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()